@@ -75,6 +75,9 @@ module biriscv_csr
     ,output [ 31:0]  mmu_satp_o
 );
 
+// Keep hierarchy visible to the C++ testbench
+/*verilator public_module*/
+
 
 
 //-----------------------------------------------------------------
@@ -560,6 +560,27 @@ begin
 `endif
 end
 
+`ifdef HAS_SIM_CTRL
+//-----------------------------------------------------------------
+// SIM_CTRL phase marker: pulse + id for the testbench timeline
+//-----------------------------------------------------------------
+reg        sim_mark_q;
+reg [23:0] sim_mark_id_q;
+
+always @ (posedge clk_i or posedge rst_i)
+if (rst_i)
+begin
+    sim_mark_q    <= 1'b0;
+    sim_mark_id_q <= 24'b0;
+end
+else
+begin
+    sim_mark_q    <= (csr_waddr_i == `CSR_DSCRATCH || csr_waddr_i == `CSR_SIM_CTRL) && ~(|exception_i) &&
+                     ((csr_wdata_i & 32'hFF000000) == `CSR_SIM_CTRL_MARK);
+    sim_mark_id_q <= csr_wdata_i[23:0];
+end
+`endif
+
 //-----------------------------------------------------------------
 // CSR branch
 //-----------------------------------------------------------------
@@ -622,6 +643,64 @@ begin
     get_mcycle = csr_mcycle_q;
 end
 endfunction
+function [31:0] get_mtimecmp; /*verilator public*/
+begin
+    get_mtimecmp = csr_mtimecmp_q;
+end
+endfunction
+function [0:0] get_mtime_ie; /*verilator public*/
+begin
+    get_mtime_ie = csr_mtime_ie_q;
+end
+endfunction
+//-------------------------------------------------------------
+// get_csr: CSR read (debug / simulation API)
+//-------------------------------------------------------------
+function [31:0] get_csr; /*verilator public*/
+    input [11:0] addr;
+begin
+    case (addr)
+    `CSR_MSCRATCH: get_csr = csr_mscratch_q & `CSR_MSCRATCH_MASK;
+    `CSR_MEPC:     get_csr = csr_mepc_q & `CSR_MEPC_MASK;
+    `CSR_MTVEC:    get_csr = csr_mtvec_q & `CSR_MTVEC_MASK;
+    `CSR_MCAUSE:   get_csr = csr_mcause_q & `CSR_MCAUSE_MASK;
+    `CSR_MTVAL:    get_csr = csr_mtval_q & `CSR_MTVAL_MASK;
+    `CSR_MSTATUS:  get_csr = csr_sr_q & `CSR_MSTATUS_MASK;
+    `CSR_MIP:      get_csr = csr_mip_q & `CSR_MIP_MASK;
+    `CSR_MIE:      get_csr = csr_mie_q & `CSR_MIE_MASK;
+    `CSR_MCYCLE,
+    `CSR_MTIME:    get_csr = csr_mcycle_q;
+    `CSR_MTIMEH:   get_csr = csr_mcycle_h_q;
+    `CSR_MHARTID:  get_csr = cpu_id_i;
+    `CSR_MISA:     get_csr = misa_i;
+    `CSR_MTIMECMP: get_csr = csr_mtimecmp_q;
+    `CSR_SEPC:     get_csr = csr_sepc_q & `CSR_SEPC_MASK;
+    `CSR_STVEC:    get_csr = csr_stvec_q & `CSR_STVEC_MASK;
+    `CSR_SCAUSE:   get_csr = csr_scause_q & `CSR_SCAUSE_MASK;
+    `CSR_STVAL:    get_csr = csr_stval_q & `CSR_STVAL_MASK;
+    `CSR_SATP:     get_csr = csr_satp_q & `CSR_SATP_MASK;
+    `CSR_SSCRATCH: get_csr = csr_sscratch_q & `CSR_SSCRATCH_MASK;
+    default:       get_csr = 32'b0;
+    endcase
+end
+endfunction
+//-------------------------------------------------------------
+// get_sim_marker: {valid, id} of a SIM_CTRL marker written last cycle
+//-------------------------------------------------------------
+function [24:0] get_sim_marker; /*verilator public*/
+begin
+    get_sim_marker = {sim_mark_q, sim_mark_id_q};
+end
+endfunction
+//-------------------------------------------------------------
+// skip_mcycle: Advance cycle counter (testbench idle skipping)
+//-------------------------------------------------------------
+function skip_mcycle; /*verilator public*/
+    input [31:0] cycles;
+begin
+    {csr_mcycle_h_q, csr_mcycle_q} = {csr_mcycle_h_q, csr_mcycle_q} + {32'b0, cycles};
+end
+endfunction
 `endif
 
 endmodule
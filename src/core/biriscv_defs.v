@@ -311,6 +311,7 @@
 `define CSR_SIM_CTRL_MASK  32'hFFFFFFFF
     `define CSR_SIM_CTRL_EXIT (0 << 24)
     `define CSR_SIM_CTRL_PUTC (1 << 24)
+    `define CSR_SIM_CTRL_MARK (2 << 24)
 
 //--------------------------------------------------------------------
 // CSR Registers
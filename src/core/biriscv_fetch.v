@@ -304,6 +304,20 @@ assign fetch_fault_page_o  = skid_valid_q ? skid_buffer_q[99] : icache_page_faul
 assign pc_f_o              = icache_pc_w;
 assign pc_accept_o         = ~stall_w;
 
-
+`ifdef verilator
+//-------------------------------------------------------------
+// Pipeline view: instruction cache request (64-bit fetch packet)
+//-------------------------------------------------------------
+function [0:0] pipeview_fetch_valid; /*verilator public*/
+begin
+    pipeview_fetch_valid = icache_rd_o && icache_accept_i;
+end
+endfunction
+function [31:0] pipeview_fetch_pc; /*verilator public*/
+begin
+    pipeview_fetch_pc = icache_pc_o;
+end
+endfunction
+`endif
 
 endmodule
@@ -183,7 +183,15 @@ module biriscv_issue
 
 `include "biriscv_defs.v"
 
+`ifdef verilator
+// Testbench can force single issue (debugger: one retire per cycle)
+reg debug_single_issue_q;
+initial debug_single_issue_q = 1'b0;
+
+wire enable_dual_issue_w = SUPPORT_DUAL_ISSUE && !debug_single_issue_q;
+`else
 wire enable_dual_issue_w = SUPPORT_DUAL_ISSUE;
+`endif
 wire enable_muldiv_w     = SUPPORT_MULDIV;
 wire enable_mul_bypass_w = SUPPORT_MUL_BYPASS;
 
@@ -770,6 +778,26 @@ u_regfile
     .rb1_value_o(issue_b_rb_value_w)    
 );
 
+`ifdef verilator
+// Register file shadow for get_register: same writes as u_regfile
+// (slot 1 is younger), readable whichever register file variant is
+// used (SUPPORT_REGFILE_XILINX keeps registers in LUT RAMs)
+reg [31:0] debug_reg_q [31:0];
+integer    debug_reg_i;
+
+always @ (posedge clk_i or posedge rst_i)
+if (rst_i)
+begin
+    for (debug_reg_i=0;debug_reg_i<32;debug_reg_i=debug_reg_i+1)
+        debug_reg_q[debug_reg_i] <= 32'b0;
+end
+else
+begin
+    debug_reg_q[pipe0_rd_wb_w] <= pipe0_result_wb_w;
+    debug_reg_q[pipe1_rd_wb_w] <= pipe1_result_wb_w;
+end
+`endif
+
 //-------------------------------------------------------------
 // Issue Slot 0
 //------------------------------------------------------------- 
@@ -1059,6 +1087,149 @@ begin
     complete_exception = pipe0_exception_wb_w | pipe1_exception_wb_w;
 end
 endfunction
+function set_single_issue; /*verilator public*/
+    input [0:0] enable;
+begin
+    debug_single_issue_q = enable;
+end
+endfunction
+function [31:0] get_register; /*verilator public*/
+    input [4:0] r;
+begin
+    get_register = (r == 5'd0) ? 32'b0 : debug_reg_q[r];
+end
+endfunction
+
+//-------------------------------------------------------------
+// Pipeline view: decode output slots, issue per pipe, stage state
+//-------------------------------------------------------------
+function [0:0] pipeview_decode_valid; /*verilator public*/
+    input [0:0] slot;
+begin
+    pipeview_decode_valid = slot ? fetch1_valid_i : fetch0_valid_i;
+end
+endfunction
+function [31:0] pipeview_decode_pc; /*verilator public*/
+    input [0:0] slot;
+begin
+    pipeview_decode_pc = slot ? fetch1_pc_i : fetch0_pc_i;
+end
+endfunction
+function [31:0] pipeview_decode_opcode; /*verilator public*/
+    input [0:0] slot;
+begin
+    pipeview_decode_opcode = slot ? fetch1_instr_i : fetch0_instr_i;
+end
+endfunction
+function [0:0] pipeview_issue_valid; /*verilator public*/
+    input [0:0] pipe;
+begin
+    if (pipe)
+        pipeview_issue_valid = opcode_b_issue_r & opcode_b_accept_r;
+    else
+        pipeview_issue_valid = opcode_a_issue_r & opcode_a_accept_r;
+end
+endfunction
+function [31:0] pipeview_issue_pc; /*verilator public*/
+    input [0:0] pipe;
+begin
+    pipeview_issue_pc = pipe ? opcode_b_pc_r : opcode_a_pc_r;
+end
+endfunction
+function [0:0] pipeview_stall; /*verilator public*/
+begin
+    pipeview_stall = stall_w;
+end
+endfunction
+function [0:0] pipeview_stage_valid; /*verilator public*/
+    input [0:0] pipe;
+    input [1:0] stage;
+begin
+    if (pipe)
+        pipeview_stage_valid = u_pipe1_ctrl.stage_valid(stage);
+    else
+        pipeview_stage_valid = u_pipe0_ctrl.stage_valid(stage);
+end
+endfunction
+function [31:0] pipeview_stage_pc; /*verilator public*/
+    input [0:0] pipe;
+    input [1:0] stage;
+begin
+    if (pipe)
+        pipeview_stage_pc = u_pipe1_ctrl.stage_pc(stage);
+    else
+        pipeview_stage_pc = u_pipe0_ctrl.stage_pc(stage);
+end
+endfunction
+
+//-------------------------------------------------------------
+// Timeline events (testbench counters), this cycle:
+//  [0] A issued        [1] B issued       [2] mispredict redirect
+//  [3] LSU stall       [4] div/csr wait   [5] operand stall
+//-------------------------------------------------------------
+function [5:0] perf_events; /*verilator public*/
+begin
+    perf_events = {stall_w,
+                   div_pending_q | csr_pending_q,
+                   lsu_stall_i,
+                   mispredicted_r,
+                   opcode_b_issue_r & opcode_b_accept_r,
+                   opcode_a_issue_r & opcode_a_accept_r};
+end
+endfunction
+
+//-------------------------------------------------------------
+// Dual issue pairing: why slot B did not issue alongside slot A
+// (only meaningful when single_issue_w)
+//  0 = paired / no issue   1 = dual issue disabled
+//  2 = fetch alignment     3 = fetch single word
+//  4 = branch in A         5 = div / csr in A
+//  6 = B needs pipe 0      7 = LSU conflict
+//  8 = MUL conflict        9 = other combination
+// 10 = RAW on A           11 = in-flight result (load / mul)
+//-------------------------------------------------------------
+function [3:0] pairing_reason; /*verilator public*/
+begin
+    if (!single_issue_w)
+        pairing_reason = 4'd0;
+    else if (!enable_dual_issue_w)
+        pairing_reason = 4'd1;
+    else if (slot1_valid_r)
+        pairing_reason = 4'd2;
+    else if (!opcode_b_valid_r)
+        pairing_reason = 4'd3;
+    else if (issue_a_branch_w)
+        pairing_reason = 4'd4;
+    else if (issue_a_div_w || issue_a_csr_w)
+        pairing_reason = 4'd5;
+    else if (!pipe1_ok_w)
+        pairing_reason = 4'd6;
+    else if (issue_a_lsu_w && issue_b_lsu_w)
+        pairing_reason = 4'd7;
+    else if (issue_a_mul_w && issue_b_mul_w)
+        pairing_reason = 4'd8;
+    else if (!dual_issue_ok_w)
+        pairing_reason = 4'd9;
+    else if (issue_a_sb_alloc_w && (|issue_a_rd_idx_w) &&
+             (issue_a_rd_idx_w == issue_b_ra_idx_w ||
+              issue_a_rd_idx_w == issue_b_rb_idx_w ||
+              issue_a_rd_idx_w == issue_b_rd_idx_w))
+        pairing_reason = 4'd10;
+    else
+        pairing_reason = 4'd11;
+end
+endfunction
+function [31:0] pairing_opcode; /*verilator public*/
+    input [0:0] slot;
+begin
+    pairing_opcode = slot ? opcode_b_r : opcode_a_r;
+end
+endfunction
+function [31:0] pairing_pc; /*verilator public*/
+begin
+    pairing_pc = opcode_a_pc_r;
+end
+endfunction
 `endif
 
 
@@ -456,6 +456,30 @@ u_trace_wb
     ,.pc_i(pc_wb_o)
     ,.opcode_i(opcode_wb_o)
 );
+
+//-------------------------------------------------------------
+// Stage occupancy (pipeline view: 0 = E1, 1 = E2, 2 = WB)
+//-------------------------------------------------------------
+function [0:0] stage_valid;
+    input [1:0] stage;
+begin
+    case (stage)
+    2'd0:    stage_valid = valid_e1_q;
+    2'd1:    stage_valid = valid_e2_q;
+    default: stage_valid = valid_wb_q;
+    endcase
+end
+endfunction
+function [31:0] stage_pc;
+    input [1:0] stage;
+begin
+    case (stage)
+    2'd0:    stage_pc = pc_e1_q;
+    2'd1:    stage_pc = pc_e2_q;
+    default: stage_pc = pc_wb_q;
+    endcase
+end
+endfunction
 `endif
 
 endmodule
\ No newline at end of file
@@ -33,8 +33,11 @@ module biriscv_trace_sim
 
 //-----------------------------------------------------------------
 // get_regname_str: Convert register number to string
+// BIRISCV_FAST_SIM: debug strings removed from the model, the
+// testbench disassembles on demand instead (tb_top/tb_disasm.h)
 //-----------------------------------------------------------------
 `ifdef verilator
+`ifndef BIRISCV_FAST_SIM
 function [79:0] get_regname_str;
     input  [4:0] regnum;
 begin
@@ -256,5 +259,6 @@ begin
     end
 end
 `endif
+`endif
 
 endmodule
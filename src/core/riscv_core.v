@@ -85,6 +85,9 @@ module riscv_core
     ,output [ 31:0]  mem_i_pc_o
 );
 
+// Keep hierarchy visible to the C++ testbench
+/*verilator public_module*/
+
 wire           mmu_lsu_writeback_w;
 wire  [  4:0]  csr_opcode_rd_idx_w;
 wire  [  4:0]  mul_opcode_rd_idx_w;
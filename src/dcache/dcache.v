@@ -82,6 +82,9 @@ module dcache
     ,output          axi_rready_o
 );
 
+// Keep hierarchy visible to the C++ testbench
+/*verilator public_module*/
+
 wire           mem_uncached_invalidate_w;
 wire           pmem_cache_accept_w;
 wire           mem_uncached_accept_w;
@@ -55,6 +55,9 @@ module dcache_core
     ,output [ 31:0]  outport_write_data_o
 );
 
+// Keep hierarchy visible to the C++ testbench
+/*verilator public_module*/
+
 
 
 //-----------------------------------------------------------------
@@ -76,6 +76,9 @@ module icache
     ,output          axi_rready_o
 );
 
+// Keep hierarchy visible to the C++ testbench
+/*verilator public_module*/
+
 
 
 //-----------------------------------------------------------------
@@ -44,6 +44,9 @@
 #define _CSRR_DPC()         ({ int result; __asm volatile("csrr %0, dpc" : "=r"(result)); result; })
 #define _CSRW_DPC(v)        __asm volatile("csrw dpc, %0" : : "r"(v))
 
+// Simulation phase marker (HAS_SIM_CTRL: SIM_CTRL/dscratch, type 2)
+#define _SIM_MARKER(id)     __asm volatile("csrw dscratch, %0" : : "r"((2 << 24) | ((id) & 0xFFFFFF)))
+
 static inline int  CSRR_MEPC(void)        { return _CSRR_MEPC(); }
 static inline void CSRW_MEPC(int v)       { _CSRW_MEPC(v); }
 static inline int  CSRR_MCAUSE(void)      { return _CSRR_MCAUSE(); }
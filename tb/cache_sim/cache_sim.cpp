@@ -0,0 +1,462 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <string>
+#include <vector>
+
+#include "tb_axi4_trace.h"
+
+//-----------------------------------------------------------------
+// Defines
+//-----------------------------------------------------------------
+#define BUS_BYTES           4           // AXI data width (bytes)
+#define DEFAULT_LATENCY     8           // Cycles to first beat
+#define CACHE_ADDR_MIN      0x80000000  // riscv_top MEM_CACHE_ADDR_MIN
+#define CACHE_ADDR_MAX      0x8fffffff  // riscv_top MEM_CACHE_ADDR_MAX
+
+// RTL geometry (icache.v / dcache_core.v)
+#define RTL_SIZE            (16 * 1024)
+#define RTL_WAYS            2
+#define RTL_LINE            32
+
+//-----------------------------------------------------------------
+// Replacement policies
+//-----------------------------------------------------------------
+enum eRepl
+{
+    REPL_RR,        // Round-robin victim, one counter per cache (as the RTL)
+    REPL_LRU,
+    REPL_FIFO,
+    REPL_RANDOM
+};
+
+static const char *repl_names[] = { "rr", "lru", "fifo", "random" };
+
+//-----------------------------------------------------------------
+// cache_model: Set associative cache (tags only)
+//-----------------------------------------------------------------
+class cache_model
+{
+public:
+    cache_model(bool icache, uint32_t size, uint32_t ways, uint32_t line, eRepl repl, bool write_back)
+    {
+        m_icache     = icache;
+        m_size       = size;
+        m_ways       = ways;
+        m_line       = line;
+        m_repl       = repl;
+        m_write_back = write_back;
+        m_sets       = size / (ways * line);
+        m_line_shift = 0;
+        while ((1u << m_line_shift) < line)
+            m_line_shift++;
+
+        m_tag.resize(m_sets * ways, 0);
+        m_valid.resize(m_sets * ways, false);
+        m_dirty.resize(m_sets * ways, false);
+        m_stamp.resize(m_sets * ways, 0);
+        m_rr         = 0;
+        m_time       = 0;
+        m_rand       = 0x12345678;
+
+        accesses     = 0;
+        writes       = 0;
+        misses       = 0;
+        write_misses = 0;
+        writebacks   = 0;
+        write_thru   = 0;
+    }
+
+    //-----------------------------------------------------------------
+    // access: Look up a (word sized) access
+    //-----------------------------------------------------------------
+    void access(uint32_t addr, bool write)
+    {
+        uint32_t line = addr >> m_line_shift;
+        uint32_t set  = line % m_sets;
+        uint32_t base = set * m_ways;
+
+        accesses++;
+        m_time++;
+        if (write)
+            writes++;
+
+        // Write-through caches post every store to memory
+        if (write && !m_write_back)
+            write_thru++;
+
+        for (uint32_t w=0;w<m_ways;w++)
+            if (m_valid[base + w] && m_tag[base + w] == line)
+            {
+                if (m_repl == REPL_LRU)
+                    m_stamp[base + w] = m_time;
+                if (write && m_write_back)
+                    m_dirty[base + w] = true;
+                return;
+            }
+
+        misses++;
+        if (write)
+            write_misses++;
+
+        // No write allocate (write-through)
+        if (write && !m_write_back)
+            return;
+
+        uint32_t victim = select_victim(set);
+        if (m_valid[base + victim] && m_dirty[base + victim])
+            writebacks++;
+
+        m_tag[base + victim]   = line;
+        m_valid[base + victim] = true;
+        m_dirty[base + victim] = write && m_write_back;
+        m_stamp[base + victim] = m_time;
+    }
+
+    //-----------------------------------------------------------------
+    // stall_cycles: Estimated blocking cycles for the miss traffic;
+    //   refill  = latency + line beats
+    //   evict   = line beats
+    //   wr-thru = latency
+    //-----------------------------------------------------------------
+    uint64_t stall_cycles(uint32_t latency)
+    {
+        uint64_t beats = m_line / BUS_BYTES;
+        uint64_t fills = misses - (m_write_back ? 0 : write_misses);
+
+        return fills * (latency + beats) + writebacks * beats + write_thru * latency;
+    }
+
+    std::string name(void)
+    {
+        char str[64];
+        sprintf(str, "%c %4uK %2u-way %3uB %-6s %s", m_icache ? 'I' : 'D', m_size / 1024, m_ways, m_line,
+                repl_names[m_repl], m_icache ? "  " : (m_write_back ? "wb" : "wt"));
+        return str;
+    }
+
+    bool is_rtl(void)
+    {
+        return m_size == RTL_SIZE && m_ways == RTL_WAYS && m_line == RTL_LINE && m_repl == REPL_RR && m_write_back;
+    }
+
+    bool     m_icache;
+    uint32_t m_size;
+    uint32_t m_ways;
+    uint32_t m_line;
+    eRepl    m_repl;
+    bool     m_write_back;
+
+    uint64_t accesses;
+    uint64_t writes;
+    uint64_t misses;
+    uint64_t write_misses;
+    uint64_t writebacks;
+    uint64_t write_thru;
+
+protected:
+    uint32_t select_victim(uint32_t set)
+    {
+        uint32_t base = set * m_ways;
+
+        // Free way first
+        for (uint32_t w=0;w<m_ways;w++)
+            if (!m_valid[base + w])
+                return w;
+
+        switch (m_repl)
+        {
+            case REPL_LRU:
+            case REPL_FIFO:
+            {
+                uint32_t victim = 0;
+                for (uint32_t w=1;w<m_ways;w++)
+                    if (m_stamp[base + w] < m_stamp[base + victim])
+                        victim = w;
+                return victim;
+            }
+            case REPL_RANDOM:
+                m_rand ^= m_rand << 13;
+                m_rand ^= m_rand >> 17;
+                m_rand ^= m_rand << 5;
+                return m_rand % m_ways;
+            case REPL_RR:
+            default:
+                return m_rr++ % m_ways;
+        }
+    }
+
+    uint32_t              m_sets;
+    uint32_t              m_line_shift;
+    std::vector<uint32_t> m_tag;
+    std::vector<bool>     m_valid;
+    std::vector<bool>     m_dirty;
+    std::vector<uint64_t> m_stamp;
+    uint32_t              m_rr;
+    uint64_t              m_time;
+    uint32_t              m_rand;
+};
+
+//-----------------------------------------------------------------
+// parse_size: Size with optional K/M suffix
+//-----------------------------------------------------------------
+static uint32_t parse_size(const char *str)
+{
+    char *end = NULL;
+    uint32_t size = (uint32_t)strtoul(str, &end, 0);
+
+    if (*end == 'k' || *end == 'K')
+        size <<= 10;
+    else if (*end == 'm' || *end == 'M')
+        size <<= 20;
+
+    return size;
+}
+//-----------------------------------------------------------------
+// parse_config: SIDE:SIZE:WAYS:LINE[:REPL[:wb|wt]]
+//-----------------------------------------------------------------
+static cache_model *parse_config(const char *spec)
+{
+    std::vector<std::string> f;
+    std::string s(spec);
+    size_t pos;
+    while ((pos = s.find(':')) != std::string::npos)
+    {
+        f.push_back(s.substr(0, pos));
+        s = s.substr(pos + 1);
+    }
+    f.push_back(s);
+
+    if (f.size() < 4 || (f[0] != "i" && f[0] != "d"))
+        return NULL;
+
+    uint32_t size  = parse_size(f[1].c_str());
+    uint32_t ways  = (uint32_t)strtoul(f[2].c_str(), NULL, 0);
+    uint32_t line  = parse_size(f[3].c_str());
+    eRepl    repl  = REPL_RR;
+    bool     wb    = true;
+
+    if (f.size() > 4)
+    {
+        int i;
+        for (i=0;i<4;i++)
+            if (f[4] == repl_names[i])
+                break;
+        if (i == 4)
+            return NULL;
+        repl = (eRepl)i;
+    }
+
+    if (f.size() > 5)
+    {
+        if (f[5] == "wt")
+            wb = false;
+        else if (f[5] != "wb")
+            return NULL;
+    }
+
+    // Power of two line, whole number of sets
+    if (!ways || line < BUS_BYTES || (line & (line - 1)) || (size % (ways * line)) || size < ways * line)
+        return NULL;
+
+    return new cache_model(f[0] == "i", size, ways, line, repl, wb);
+}
+//-----------------------------------------------------------------
+// add_sweep: Default design space
+//-----------------------------------------------------------------
+static void add_sweep(std::vector<cache_model*> &caches)
+{
+    static const eRepl repl[] = { REPL_RR, REPL_LRU };
+
+    for (int side=0;side<2;side++)
+        for (uint32_t size=4*1024;size<=64*1024;size*=2)
+            for (uint32_t ways=1;ways<=8;ways*=2)
+                for (uint32_t line=16;line<=64;line*=2)
+                    for (int r=0;r<2;r++)
+                    {
+                        if (ways == 1 && r > 0)
+                            continue;
+
+                        caches.push_back(new cache_model(side == 0, size, ways, line, repl[r], true));
+
+                        if (side == 1 && repl[r] == REPL_LRU)
+                            caches.push_back(new cache_model(false, size, ways, line, repl[r], false));
+                    }
+}
+
+//-----------------------------------------------------------------
+// Command line options
+//-----------------------------------------------------------------
+#define GETOPTS_ARGS "c:l:u:o:h"
+
+static struct option long_options[] =
+{
+    {"config",   required_argument, 0, 'c'},
+    {"latency",  required_argument, 0, 'l'},
+    {"cached",   required_argument, 0, 'u'},
+    {"csv",      required_argument, 0, 'o'},
+    {"help",     no_argument,       0, 'h'},
+    {0, 0, 0, 0}
+};
+
+static void help_options(void)
+{
+    fprintf (stderr,"Usage: cache_sim [options] trace [trace ...]\n");
+    fprintf (stderr,"  Trace from test.x --access-trace (ifetch -> I-cache, lsu -> D-cache)\n");
+    fprintf (stderr,"  --config  | -c SPEC      i|d:SIZE:WAYS:LINE[:rr|lru|fifo|random[:wb|wt]], may be repeated\n");
+    fprintf (stderr,"                           (default: sweep 4K-64K, 1-8 ways, 16-64B lines)\n");
+    fprintf (stderr,"  --latency | -l NUM       Memory latency to first beat (default %d)\n", DEFAULT_LATENCY);
+    fprintf (stderr,"  --cached  | -u MIN:MAX   Cacheable data range (default 0x%08x:0x%08x)\n", CACHE_ADDR_MIN, CACHE_ADDR_MAX);
+    fprintf (stderr,"  --csv     | -o FILE      Write results as CSV\n");
+    exit(-1);
+}
+
+//-----------------------------------------------------------------
+// main
+//-----------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+    std::vector<cache_model*> caches;
+    uint32_t     latency   = DEFAULT_LATENCY;
+    uint32_t     cache_min = CACHE_ADDR_MIN;
+    uint32_t     cache_max = CACHE_ADDR_MAX;
+    const char * csv       = NULL;
+    int          help      = 0;
+    int c;
+
+    int option_index = 0;
+    while ((c = getopt_long (argc, argv, GETOPTS_ARGS, long_options, &option_index)) != -1)
+    {
+        switch(c)
+        {
+            case 'c':
+            {
+                cache_model *cache = parse_config(optarg);
+                if (!cache)
+                {
+                    fprintf (stderr,"Error: Bad cache config '%s'\n", optarg);
+                    help = 1;
+                }
+                else
+                    caches.push_back(cache);
+                break;
+            }
+            case 'l':
+                latency = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'u':
+            {
+                char *end = NULL;
+                cache_min = (uint32_t)strtoul(optarg, &end, 0);
+                cache_max = (*end == ':') ? (uint32_t)strtoul(end + 1, NULL, 0) : 0xFFFFFFFF;
+                break;
+            }
+            case 'o':
+                csv = optarg;
+                break;
+            case '?':
+            default:
+                help = 1;
+                break;
+        }
+    }
+
+    if (help || optind >= argc)
+        help_options();
+
+    if (caches.empty())
+        add_sweep(caches);
+
+    std::vector<cache_model*> icaches;
+    std::vector<cache_model*> dcaches;
+    for (size_t i=0;i<caches.size();i++)
+        (caches[i]->m_icache ? icaches : dcaches).push_back(caches[i]);
+
+    uint64_t instructions = 0;
+    uint64_t uncached     = 0;
+    uint64_t records      = 0;
+
+    // Single pass: every access is applied to every configuration
+    for (int t=optind;t<argc;t++)
+    {
+        tb_axi4_trace_reader trace;
+        if (!trace.open(argv[t]))
+            return -1;
+
+        int port_i = -1;
+        int port_d = -1;
+        for (int p=0;p<trace.get_num_ports();p++)
+            if (trace.get_port_name(p) == "ifetch")
+                port_i = p;
+            else if (trace.get_port_name(p) == "lsu")
+                port_d = p;
+
+        if (port_i < 0 && port_d < 0)
+        {
+            fprintf(stderr, "ERROR: %s has no ifetch / lsu stream (AXI traces are post-cache, use --access-trace)\n", argv[t]);
+            return -1;
+        }
+
+        tb_axi4_trace_rec rec;
+        while (trace.next(rec))
+        {
+            records++;
+
+            if (rec.port == port_i)
+            {
+                instructions++;
+                for (size_t i=0;i<icaches.size();i++)
+                    icaches[i]->access(rec.addr, false);
+            }
+            else if (rec.port == port_d)
+            {
+                if (rec.addr < cache_min || rec.addr > cache_max)
+                {
+                    uncached++;
+                    continue;
+                }
+
+                for (size_t i=0;i<dcaches.size();i++)
+                    dcaches[i]->access(rec.addr, rec.is_write());
+            }
+        }
+    }
+
+    printf("%lu records, %lu instructions, %lu uncached data accesses, latency %u\n",
+           (unsigned long)records, (unsigned long)instructions, (unsigned long)uncached, latency);
+    printf("  %-28s %12s %10s %7s %10s %12s %7s\n", "Config", "Accesses", "Misses", "Miss%", "Writeback", "Stall cyc", "CPI+");
+
+    FILE *f = csv ? fopen(csv, "w") : NULL;
+    if (csv && !f)
+        fprintf(stderr, "ERROR: Cannot create %s\n", csv);
+    if (f)
+        fprintf(f, "side,size,ways,line,repl,write,accesses,misses,writebacks,write_through,stall_cycles,cpi_adder\n");
+
+    for (size_t i=0;i<caches.size();i++)
+    {
+        cache_model *cm = caches[i];
+        uint64_t stall = cm->stall_cycles(latency);
+        double   cpi   = instructions ? (double)stall / instructions : 0.0;
+
+        printf("%c %-28s %12lu %10lu %6.2f%% %10lu %12lu %7.3f\n", cm->is_rtl() ? '*' : ' ', cm->name().c_str(),
+               (unsigned long)cm->accesses, (unsigned long)cm->misses,
+               cm->accesses ? 100.0 * cm->misses / cm->accesses : 0.0,
+               (unsigned long)cm->writebacks, (unsigned long)stall, cpi);
+
+        if (f)
+            fprintf(f, "%c,%u,%u,%u,%s,%s,%lu,%lu,%lu,%lu,%lu,%.4f\n", cm->m_icache ? 'i' : 'd',
+                    cm->m_size, cm->m_ways, cm->m_line, repl_names[cm->m_repl], cm->m_write_back ? "wb" : "wt",
+                    (unsigned long)cm->accesses, (unsigned long)cm->misses, (unsigned long)cm->writebacks,
+                    (unsigned long)cm->write_thru, (unsigned long)stall, cpi);
+    }
+    printf("  (* = RTL geometry)\n");
+
+    if (f)
+        fclose(f);
+
+    for (size_t i=0;i<caches.size();i++)
+        delete caches[i];
+
+    return 0;
+}
@@ -0,0 +1,163 @@
+#ifndef PERF_BBV_H
+#define PERF_BBV_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <map>
+#include <string>
+
+//-----------------------------------------------------------------
+// perf_bbv: Basic block vectors per fixed instruction interval,
+// in the SimPoint .bb format ('T:id:count :id:count ...'), where
+// count is instructions retired in the block during the interval.
+// Also writes FILE.info (block id, start pc, symbol) and FILE.ipc
+// (model cycles / instructions per interval).
+//-----------------------------------------------------------------
+class perf_bbv
+{
+public:
+    perf_bbv(uint64_t interval)
+    {
+        m_interval    = interval;
+        m_bb          = NULL;
+        m_ipc         = NULL;
+        m_block_pc    = 0;
+        m_block_count = 0;
+        m_count       = 0;
+        m_intervals   = 0;
+        m_last_cycle  = 0;
+    }
+
+    bool open(const char *filename)
+    {
+        m_filename = filename;
+        m_bb  = fopen(filename, "w");
+        m_ipc = fopen((m_filename + ".ipc").c_str(), "w");
+        if (!m_bb || !m_ipc)
+        {
+            fprintf(stderr, "ERROR: Could not open %s\n", filename);
+            return false;
+        }
+        fprintf(m_ipc, "# interval cycles instructions\n");
+        return true;
+    }
+
+    //-------------------------------------------------------------
+    // set_symbols: Function start -> name (ELF), for FILE.info
+    //-------------------------------------------------------------
+    void set_symbols(const std::map<uint32_t, std::string> &symbols) { m_symbols = symbols; }
+
+    //-------------------------------------------------------------
+    // retire: Instruction at pc retired, 'end' if it ends a block
+    //-------------------------------------------------------------
+    void retire(uint32_t pc, bool end, uint64_t cycle)
+    {
+        if (!m_block_count)
+            m_block_pc = pc;
+        m_block_count++;
+
+        if (end)
+            block_end();
+
+        if (++m_count == m_interval)
+        {
+            block_end();
+            write_interval(cycle);
+        }
+    }
+
+    //-------------------------------------------------------------
+    // block_end: Close the current block (also on exceptions)
+    //-------------------------------------------------------------
+    void block_end(void)
+    {
+        if (!m_block_count)
+            return;
+
+        m_vector[block_id(m_block_pc)] += m_block_count;
+        m_block_count = 0;
+    }
+
+    //-------------------------------------------------------------
+    // close: Flush a partial last interval and write FILE.info
+    //-------------------------------------------------------------
+    void close(uint64_t cycle)
+    {
+        block_end();
+        if (m_count)
+            write_interval(cycle);
+
+        if (m_bb)   fclose(m_bb);
+        if (m_ipc)  fclose(m_ipc);
+        m_bb  = NULL;
+        m_ipc = NULL;
+
+        FILE *f = fopen((m_filename + ".info").c_str(), "w");
+        if (!f)
+            return;
+
+        fprintf(f, "# id pc symbol\n");
+        for (std::map<uint32_t, uint32_t>::iterator it = m_ids.begin(); it != m_ids.end(); ++it)
+            fprintf(f, "%u 0x%08x %s\n", it->second, it->first, symbol(it->first).c_str());
+        fclose(f);
+    }
+
+    uint64_t get_intervals(void) { return m_intervals; }
+
+protected:
+    uint32_t block_id(uint32_t pc)
+    {
+        std::map<uint32_t, uint32_t>::iterator it = m_ids.find(pc);
+        if (it != m_ids.end())
+            return it->second;
+
+        uint32_t id = (uint32_t)m_ids.size() + 1;
+        m_ids[pc] = id;
+        return id;
+    }
+
+    std::string symbol(uint32_t pc)
+    {
+        std::map<uint32_t, std::string>::iterator it = m_symbols.upper_bound(pc);
+        if (it == m_symbols.begin())
+            return "?";
+        --it;
+
+        char off[16];
+        snprintf(off, sizeof(off), "+0x%x", pc - it->first);
+        return it->second + off;
+    }
+
+    void write_interval(uint64_t cycle)
+    {
+        fprintf(m_bb, "T");
+        for (std::map<uint32_t, uint64_t>::iterator it = m_vector.begin(); it != m_vector.end(); ++it)
+            fprintf(m_bb, ":%u:%lu ", it->first, (unsigned long)it->second);
+        fprintf(m_bb, "\n");
+
+        fprintf(m_ipc, "%lu %lu %lu\n", (unsigned long)m_intervals,
+                (unsigned long)(cycle - m_last_cycle), (unsigned long)m_count);
+
+        m_vector.clear();
+        m_last_cycle = cycle;
+        m_count      = 0;
+        m_intervals++;
+    }
+
+    uint64_t                          m_interval;
+    std::string                       m_filename;
+    FILE *                            m_bb;
+    FILE *                            m_ipc;
+
+    std::map<uint32_t, std::string>   m_symbols;
+    std::map<uint32_t, uint32_t>      m_ids;
+    std::map<uint32_t, uint64_t>      m_vector;
+
+    uint32_t                          m_block_pc;
+    uint64_t                          m_block_count;
+    uint64_t                          m_count;
+    uint64_t                          m_intervals;
+    uint64_t                          m_last_cycle;
+};
+
+#endif
@@ -0,0 +1,147 @@
+#ifndef PERF_BPRED_H
+#define PERF_BPRED_H
+
+#include <stdint.h>
+#include <vector>
+
+//-----------------------------------------------------------------
+// perf_bpred: Model of biriscv_npc.v (BTB, BHT, RAS).
+// Trained by every resolved branch / jump (taken or not), as
+// the RTL does from exec E2. BTB allocation uses the same LFSR.
+//-----------------------------------------------------------------
+class perf_bpred
+{
+public:
+    perf_bpred(int btb_entries = 32, int bht_entries = 512, int ras_entries = 8, bool gshare = false, bool enable = true)
+    {
+        m_btb_entries = btb_entries;
+        m_bht_entries = bht_entries;
+        m_ras_entries = ras_entries;
+        m_gshare      = gshare;
+        m_enable      = enable;
+
+        m_btb.resize(btb_entries);
+        for (int i=0;i<btb_entries;i++)
+            m_btb[i].pc = 0;
+
+        m_bht.assign(bht_entries, 3);
+        m_ras.assign(ras_entries, 1);
+        m_ras_idx = 0;
+        m_history = 0;
+        m_lfsr    = 0x0001;
+    }
+
+    //-------------------------------------------------------------
+    // predict: Next PC predicted at fetch for the instruction at pc.
+    // 'shadow' = pc is the upper word of a packet whose lower word
+    // already hit in the BTB (the RTL only looks up one entry).
+    //-------------------------------------------------------------
+    uint32_t predict(uint32_t pc, bool shadow)
+    {
+        if (!m_enable || shadow)
+            return pc + 4;
+
+        int e = find(pc);
+        if (e < 0)
+            return pc + 4;
+
+        uint32_t ras_top = m_ras[m_ras_idx];
+        if (m_btb[e].is_ret && !(ras_top & 1))
+            return ras_top;
+
+        if (m_bht[bht_index(pc)] >= 2 || m_btb[e].is_jmp)
+            return m_btb[e].target;
+
+        return pc + 4;
+    }
+
+    bool btb_hit(uint32_t pc) { return m_enable && find(pc) >= 0; }
+
+    //-------------------------------------------------------------
+    // update: Resolved branch / jump
+    //-------------------------------------------------------------
+    void update(uint32_t pc, uint32_t target, bool taken, bool is_call, bool is_ret, bool is_jmp)
+    {
+        if (!m_enable)
+            return;
+
+        // BHT
+        uint8_t &sat = m_bht[bht_index(pc)];
+        if (taken && sat < 3)
+            sat++;
+        else if (!taken && sat > 0)
+            sat--;
+
+        m_history = ((m_history << 1) | (taken ? 1 : 0)) & (m_bht_entries - 1);
+
+        // RAS (single, non-speculative stack)
+        if (is_call)
+        {
+            m_ras_idx = (m_ras_idx + 1) % m_ras_entries;
+            m_ras[m_ras_idx] = pc + 4;
+        }
+        else if (is_ret)
+            m_ras_idx = (m_ras_idx + m_ras_entries - 1) % m_ras_entries;
+
+        // BTB
+        int e = find(pc);
+        if (e >= 0)
+        {
+            if (taken)
+                m_btb[e].target = target;
+        }
+        else
+        {
+            e = m_lfsr % m_btb_entries;
+            m_lfsr = (m_lfsr & 1) ? ((m_lfsr >> 1) ^ 0xB400) : (m_lfsr >> 1);
+
+            m_btb[e].pc     = pc;
+            m_btb[e].target = target;
+        }
+
+        m_btb[e].is_call = is_call;
+        m_btb[e].is_ret  = is_ret;
+        m_btb[e].is_jmp  = is_jmp;
+    }
+
+protected:
+    struct btb_entry
+    {
+        uint32_t pc;
+        uint32_t target;
+        bool     is_call;
+        bool     is_ret;
+        bool     is_jmp;
+    };
+
+    int find(uint32_t pc)
+    {
+        // Last match wins (as the RTL for loop)
+        int e = -1;
+        for (int i=0;i<m_btb_entries;i++)
+            if (m_btb[i].pc == pc)
+                e = i;
+        return e;
+    }
+
+    uint32_t bht_index(uint32_t pc)
+    {
+        uint32_t idx = (pc >> 2) & (m_bht_entries - 1);
+        return m_gshare ? (idx ^ m_history) : idx;
+    }
+
+    int                       m_btb_entries;
+    int                       m_bht_entries;
+    int                       m_ras_entries;
+    bool                      m_gshare;
+    bool                      m_enable;
+
+    std::vector <btb_entry>   m_btb;
+    std::vector <uint8_t>     m_bht;
+    std::vector <uint32_t>    m_ras;
+    int                       m_ras_idx;
+    uint32_t                  m_history;
+    uint16_t                  m_lfsr;
+};
+
+#endif
@@ -0,0 +1,94 @@
+#ifndef PERF_CACHE_H
+#define PERF_CACHE_H
+
+#include <stdint.h>
+#include <vector>
+
+//-----------------------------------------------------------------
+// perf_cache: Tag model of icache.v / dcache_core.v
+// (set associative, write-back allocate). As the RTL, the victim
+// way comes from one counter stepped on every refill.
+//-----------------------------------------------------------------
+class perf_cache
+{
+public:
+    perf_cache(uint32_t size = 16 * 1024, uint32_t ways = 2, uint32_t line = 32)
+    {
+        configure(size, ways, line);
+    }
+
+    void configure(uint32_t size, uint32_t ways, uint32_t line)
+    {
+        m_ways       = ways;
+        m_line       = line;
+        m_sets       = size / (ways * line);
+        m_line_shift = 0;
+        while ((1u << m_line_shift) < line)
+            m_line_shift++;
+
+        m_tag.assign(m_sets * ways, 0);
+        m_valid.assign(m_sets * ways, false);
+        m_dirty.assign(m_sets * ways, false);
+        m_replace = 0;
+
+        accesses   = 0;
+        misses     = 0;
+        writebacks = 0;
+    }
+
+    //-------------------------------------------------------------
+    // access: Returns false on a miss (line allocated), sets
+    // 'evict' if a dirty line had to be written back first
+    //-------------------------------------------------------------
+    bool access(uint32_t addr, bool write, bool &evict)
+    {
+        uint32_t line = addr >> m_line_shift;
+        uint32_t set  = line % m_sets;
+        uint32_t base = set * m_ways;
+
+        evict = false;
+        accesses++;
+
+        for (uint32_t w=0;w<m_ways;w++)
+            if (m_valid[base + w] && m_tag[base + w] == line)
+            {
+                if (write)
+                    m_dirty[base + w] = true;
+                return true;
+            }
+
+        misses++;
+
+        uint32_t victim = m_replace++ % m_ways;
+
+        if (m_valid[base + victim] && m_dirty[base + victim])
+        {
+            evict = true;
+            writebacks++;
+        }
+
+        m_tag[base + victim]   = line;
+        m_valid[base + victim] = true;
+        m_dirty[base + victim] = write;
+        return false;
+    }
+
+    uint32_t line_size(void)  { return m_line; }
+    uint32_t line_shift(void) { return m_line_shift; }
+
+    uint64_t accesses;
+    uint64_t misses;
+    uint64_t writebacks;
+
+protected:
+    uint32_t              m_ways;
+    uint32_t              m_line;
+    uint32_t              m_sets;
+    uint32_t              m_line_shift;
+    std::vector<uint32_t> m_tag;
+    std::vector<bool>     m_valid;
+    std::vector<bool>     m_dirty;
+    uint32_t              m_replace;
+};
+
+#endif
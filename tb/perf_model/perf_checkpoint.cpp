@@ -0,0 +1,208 @@
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "perf_checkpoint.h"
+
+//-----------------------------------------------------------------
+// Encodings
+//-----------------------------------------------------------------
+#define ENC_LUI(rd, imm20)      (((imm20) << 12) | ((rd) << 7) | 0x37)
+#define ENC_ADDI(rd, rs, imm12) ((((imm12) & 0xfff) << 20) | ((rs) << 15) | ((rd) << 7) | 0x13)
+#define ENC_CSRW(csr, rs)       (((csr) << 20) | ((rs) << 15) | (1 << 12) | 0x73)
+#define ENC_MRET                0x30200073
+
+static uint32_t enc_jal_x0(int32_t off)
+{
+    uint32_t imm = (uint32_t)off;
+    return ((imm & 0x100000) << 11) | ((imm & 0x7fe) << 20) | ((imm & 0x800) << 9) | (imm & 0xff000) | 0x6f;
+}
+
+// jal reach, zero bytes kept either side of an automatic stub
+#define JAL_RANGE               (1 << 20)
+#define STUB_GUARD              0x100
+
+// CSRs restored by the stub (biriscv_csr_regfile.v, machine mode)
+static const uint32_t restore_csrs[] = { 0x305, 0x340, 0x341, 0x342, 0x343, 0x304, 0x300 };
+
+//-----------------------------------------------------------------
+// li: lui + addi
+//-----------------------------------------------------------------
+void perf_checkpoint::li(std::vector<uint32_t> &code, int rd, uint32_t value)
+{
+    uint32_t hi = (value + 0x800) >> 12;
+    code.push_back(ENC_LUI(rd, hi & 0xfffff));
+    code.push_back(ENC_ADDI(rd, rd, value & 0xfff));
+}
+//-----------------------------------------------------------------
+// find_stub: Highest address in the largest zero run which fits
+// size bytes, preferring runs within jal range of pc (0 = none)
+//-----------------------------------------------------------------
+uint32_t perf_checkpoint::find_stub(uint32_t pc, uint32_t size)
+{
+    uint32_t best      = 0;
+    uint32_t best_run  = 0;
+    bool     best_near = false;
+
+    for (size_t r=0;r<m_mem->num_regions();r++)
+    {
+        const perf_mem::region &reg = m_mem->get_region(r);
+
+        uint32_t run = 0;
+        for (uint32_t a=0;a<=reg.size;a+=4)
+        {
+            if (a + 4 <= reg.size && !reg.data[a] && !reg.data[a+1] && !reg.data[a+2] && !reg.data[a+3])
+            {
+                run += 4;
+                continue;
+            }
+
+            if (run >= size + 2 * STUB_GUARD)
+            {
+                // Candidate start addresses in [reg.base + a - run, reg.base + a)
+                int64_t lo = (int64_t)reg.base + a - run + STUB_GUARD;
+                int64_t hi = (int64_t)reg.base + a - STUB_GUARD - size;
+
+                int64_t near_lo = (int64_t)pc - JAL_RANGE + size;
+                int64_t near_hi = (int64_t)pc + JAL_RANGE - size;
+                int64_t start   = (hi < near_hi) ? hi : near_hi;
+                bool    near    = start >= lo && start >= near_lo;
+                if (!near)
+                    start = hi;
+
+                if ((near && !best_near) || (near == best_near && run > best_run))
+                {
+                    best      = (uint32_t)start & ~3u;
+                    best_run  = run;
+                    best_near = near;
+                }
+            }
+            run = 0;
+        }
+    }
+
+    return best;
+}
+//-----------------------------------------------------------------
+// write_file
+//-----------------------------------------------------------------
+bool perf_checkpoint::write_file(const std::string &filename, const uint8_t *data, uint32_t size)
+{
+    FILE *f = fopen(filename.c_str(), "wb");
+    if (!f)
+    {
+        fprintf(stderr, "ERROR: Could not create %s\n", filename.c_str());
+        return false;
+    }
+    fwrite(data, 1, size, f);
+    fclose(f);
+    return true;
+}
+//-----------------------------------------------------------------
+// save
+//-----------------------------------------------------------------
+bool perf_checkpoint::save(const char *dir)
+{
+    char name[64];
+    std::string path = dir;
+    mkdir(dir, 0755);
+
+    m_args     = "";
+    m_via_mret = false;
+
+    // Memory: non-zero span of each region
+    for (size_t r=0;r<m_mem->num_regions();r++)
+    {
+        const perf_mem::region &reg = m_mem->get_region(r);
+
+        uint32_t first = 0;
+        uint32_t last  = reg.size;
+        while (first < reg.size && !reg.data[first])
+            first++;
+        while (last > first && !reg.data[last - 1])
+            last--;
+        if (first == last)
+            continue;
+
+        first &= ~3u;
+        last   = (last + 3) & ~3u;
+        if (last > reg.size)
+            last = reg.size;
+
+        if (m_stub_addr && m_stub_addr >= reg.base + first && m_stub_addr < reg.base + last)
+        {
+            fprintf(stderr, "ERROR: Stub address 0x%08x overlaps memory in use\n", m_stub_addr);
+            return false;
+        }
+
+        snprintf(name, sizeof(name), "/mem_%08x.bin", reg.base + first);
+        if (!write_file(path + name, &reg.data[first], last - first))
+            return false;
+        m_args += "-f " + path + name;
+
+        snprintf(name, sizeof(name), "@0x%08x ", reg.base + first);
+        m_args += name;
+    }
+
+    // Boot stub: CSRs via x1, then x1..x31, then jump
+    std::vector<uint32_t> code;
+    uint32_t pc      = m_core->get_pc();
+    uint32_t mstatus = m_core->get_csr(0x300);
+
+    for (size_t c=0;c<sizeof(restore_csrs)/sizeof(restore_csrs[0]);c++)
+    {
+        uint32_t csr   = restore_csrs[c];
+        uint32_t value = m_core->get_csr(csr);
+
+        // Keep interrupts masked until the jump
+        if (csr == 0x300)
+            value &= ~0x8u;
+
+        li(code, 1, value);
+        code.push_back(ENC_CSRW(csr, 1));
+    }
+
+    for (int r=1;r<32;r++)
+        li(code, r, m_core->get_reg(r));
+
+    // Room for the jump, or the mret sequence
+    uint32_t stub_addr = m_stub_addr;
+    if (!stub_addr)
+        stub_addr = find_stub(pc, 4 * (code.size() + 8));
+    if (!stub_addr)
+    {
+        fprintf(stderr, "ERROR: No free memory for the boot stub (use --stub-addr)\n");
+        return false;
+    }
+
+    int32_t off = (int32_t)(pc - (stub_addr + 4 * (uint32_t)code.size()));
+    if (off >= -JAL_RANGE && off < JAL_RANGE && !(mstatus & 0x8))
+        code.push_back(enc_jal_x0(off));
+    else
+    {
+        // Out of jal range / MIE set: mret to pc (mepc lost), inserted
+        // ahead of the register restore which needs all of x1..x31
+        std::vector<uint32_t> pre;
+        li(pre, 1, pc);
+        pre.push_back(ENC_CSRW(0x341, 1));
+        li(pre, 1, (mstatus & ~0x88u) | ((mstatus & 0x8) << 4) | 0x1800);
+        pre.push_back(ENC_CSRW(0x300, 1));
+        code.insert(code.end() - 31 * 2, pre.begin(), pre.end());
+        code.push_back(ENC_MRET);
+        m_via_mret = true;
+    }
+
+    if (!write_file(path + "/stub.bin", (const uint8_t *)&code[0], 4 * code.size()))
+        return false;
+
+    snprintf(name, sizeof(name), "@0x%08x -e 0x%08x", stub_addr, stub_addr);
+    m_args += "-f " + path + "/stub.bin" + name;
+
+    FILE *f = fopen((path + "/run.args").c_str(), "w");
+    if (f)
+    {
+        fprintf(f, "%s\n", m_args.c_str());
+        fclose(f);
+    }
+    return true;
+}
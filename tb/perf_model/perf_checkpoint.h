@@ -0,0 +1,53 @@
+#ifndef PERF_CHECKPOINT_H
+#define PERF_CHECKPOINT_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "perf_core.h"
+#include "perf_mem.h"
+
+//-----------------------------------------------------------------
+// perf_checkpoint: Architectural state of the functional model as
+// loadable images - one raw binary per memory region plus a boot
+// stub that restores CSRs and registers, then jumps to the pc.
+// The RTL starts from the stub (biriscv_run -f ... -e STUB).
+// Caches / predictor start cold and mcycle restarts from zero.
+// With stub_addr 0 the stub goes in the largest run of zero memory
+// within jal range of the pc (e.g. the gap between heap and stack),
+// so it can jump to the pc and leave mepc / mstatus intact.
+//-----------------------------------------------------------------
+class perf_checkpoint
+{
+public:
+    perf_checkpoint(perf_core *core, perf_mem *mem, uint32_t stub_addr)
+    {
+        m_core      = core;
+        m_mem       = mem;
+        m_stub_addr = stub_addr;
+        m_via_mret  = false;
+    }
+
+    // Write DIR/mem_ADDR.bin + DIR/stub.bin, DIR/run.args
+    bool save(const char *dir);
+
+    // Image arguments for biriscv_run / tb_top
+    std::string get_args(void) { return m_args; }
+
+    // Stub returned through mret (pc beyond jal range or MIE set)
+    bool        via_mret(void) { return m_via_mret; }
+
+protected:
+    void li(std::vector<uint32_t> &code, int rd, uint32_t value);
+    uint32_t find_stub(uint32_t pc, uint32_t size);
+    bool write_file(const std::string &filename, const uint8_t *data, uint32_t size);
+
+    perf_core * m_core;
+    perf_mem *  m_mem;
+    uint32_t    m_stub_addr;
+    std::string m_args;
+    bool        m_via_mret;
+};
+
+#endif
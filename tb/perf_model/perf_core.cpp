@@ -0,0 +1,621 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "perf_core.h"
+
+//-----------------------------------------------------------------
+// Opcodes
+//-----------------------------------------------------------------
+#define OP_LUI      0x37
+#define OP_AUIPC    0x17
+#define OP_JAL      0x6f
+#define OP_JALR     0x67
+#define OP_BRANCH   0x63
+#define OP_LOAD     0x03
+#define OP_STORE    0x23
+#define OP_IMM      0x13
+#define OP_REG      0x33
+#define OP_FENCE    0x0f
+#define OP_SYSTEM   0x73
+
+#define CAUSE_ILLEGAL       2
+#define CAUSE_BREAKPOINT    3
+#define CAUSE_MISALIGN_LD   4
+#define CAUSE_MISALIGN_ST   6
+#define CAUSE_ECALL_M       11
+
+//-----------------------------------------------------------------
+// Immediates
+//-----------------------------------------------------------------
+static inline uint32_t imm_i(uint32_t op) { return (uint32_t)((int32_t)op >> 20); }
+static inline uint32_t imm_s(uint32_t op) { return (uint32_t)((int32_t)(op & 0xfe000000) >> 20) | ((op >> 7) & 0x1f); }
+static inline uint32_t imm_b(uint32_t op)
+{
+    return (uint32_t)((int32_t)(op & 0x80000000) >> 19) | ((op & 0x80) << 4) | ((op >> 20) & 0x7e0) | ((op >> 7) & 0x1e);
+}
+static inline uint32_t imm_j(uint32_t op)
+{
+    return (uint32_t)((int32_t)(op & 0x80000000) >> 11) | (op & 0xff000) | ((op >> 9) & 0x800) | ((op >> 20) & 0x7fe);
+}
+
+//-----------------------------------------------------------------
+// Constructor
+//-----------------------------------------------------------------
+perf_core::perf_core(perf_mem *mem, const perf_config &cfg):
+    m_icache(cfg.icache_size, cfg.icache_ways, cfg.line_size),
+    m_dcache(cfg.dcache_size, cfg.dcache_ways, cfg.line_size),
+    m_bpred(cfg.btb_entries, cfg.bht_entries, cfg.ras_entries, cfg.gshare, cfg.bpred)
+{
+    m_mem = mem;
+    m_bbv = NULL;
+    m_cfg = cfg;
+    reset(PERF_MEM_BASE);
+}
+//-----------------------------------------------------------------
+// reset: Architectural and timing state (caches start cold)
+//-----------------------------------------------------------------
+void perf_core::reset(uint32_t pc)
+{
+    m_pc        = pc;
+    memset(m_x, 0, sizeof(m_x));
+    m_mstatus   = 0;
+    m_mtvec     = 0;
+    m_mepc      = 0;
+    m_mcause    = 0;
+    m_mtval     = 0;
+    m_mscratch  = 0;
+    m_mie       = 0;
+    m_exit      = false;
+    m_exit_code = 0;
+
+    m_cycle        = 0;
+    m_fetch_ready  = 0;
+    m_serial_until = 0;
+    m_stall_until  = 0;
+    m_lsu_cycle    = ~0ULL;
+    m_fetch_line   = ~0u;
+    m_slot_a       = false;
+    memset(&m_prev, 0, sizeof(m_prev));
+    memset(m_last_div, 0, sizeof(m_last_div));
+    for (int i=0;i<32;i++)
+        m_ready[i] = 0;
+
+    memset(&m_stats, 0, sizeof(m_stats));
+}
+//-----------------------------------------------------------------
+// run: Execute until SIM_CTRL exit or max_instr retired
+//-----------------------------------------------------------------
+bool perf_core::run(uint64_t max_instr)
+{
+    uint64_t end = m_stats.instret + max_instr;
+
+    while (!m_exit && (max_instr == 0 || m_stats.instret < end))
+    {
+        inst i;
+        if (execute(i))
+        {
+            timing(i);
+            if (m_bbv)
+                m_bbv->retire(i.pc, i.cls == CLASS_BRANCH || i.next_pc != i.pc + 4, m_cycle);
+        }
+        else
+        {
+            if (m_bbv)
+                m_bbv->block_end();
+
+            // Exception: flush and refetch from mtvec
+            m_fetch_ready = m_cycle + m_cfg.bp_penalty + (m_cfg.extra_decode ? 1 : 0);
+            m_fetch_line  = ~0u;
+            m_slot_a      = false;
+        }
+    }
+
+    return m_exit;
+}
+//-----------------------------------------------------------------
+// get_stats: Cycle count is the issue cycle of the last instruction
+// plus the drain through E1/E2/WB
+//-----------------------------------------------------------------
+perf_stats perf_core::get_stats(void)
+{
+    perf_stats s      = m_stats;
+    s.cycles          = m_stats.instret ? (m_cycle + 3) : 0;
+    s.icache_misses   = m_icache.misses;
+    s.dcache_accesses = m_dcache.accesses;
+    s.dcache_misses   = m_dcache.misses;
+    s.dcache_writebacks = m_dcache.writebacks;
+    return s;
+}
+//-----------------------------------------------------------------
+// trap: Machine mode exception entry
+//-----------------------------------------------------------------
+void perf_core::trap(uint32_t cause, uint32_t tval)
+{
+    m_mepc    = m_pc;
+    m_mcause  = cause;
+    m_mtval   = tval;
+    // MPIE <= MIE, MIE <= 0, MPP <= M
+    m_mstatus = (m_mstatus & ~0x1888) | ((m_mstatus & 0x8) << 4) | 0x1800;
+    m_pc      = m_mtvec;
+}
+//-----------------------------------------------------------------
+// csr_read / csr_write: Subset implemented by biriscv_csr_regfile.v
+//-----------------------------------------------------------------
+uint32_t perf_core::csr_read(uint32_t addr)
+{
+    switch (addr)
+    {
+    case 0x300: return m_mstatus;
+    case 0x301: return 0x40001100; // RV32IM
+    case 0x304: return m_mie;
+    case 0x305: return m_mtvec;
+    case 0x340: return m_mscratch;
+    case 0x341: return m_mepc;
+    case 0x342: return m_mcause & 0x8000000F;
+    case 0x343: return m_mtval;
+    case 0xc00:
+    case 0xc01:
+    case 0xb00: return (uint32_t)m_cycle;
+    case 0xc80:
+    case 0xc81:
+    case 0xb80: return (uint32_t)(m_cycle >> 32);
+    // Not in the RTL, but benchmarks (coremark) time themselves with them
+    case 0xc02:
+    case 0xb02: return (uint32_t)m_stats.instret;
+    case 0xc82:
+    case 0xb82: return (uint32_t)(m_stats.instret >> 32);
+    default:    return 0;
+    }
+}
+void perf_core::csr_write(uint32_t addr, uint32_t value)
+{
+    switch (addr)
+    {
+    case 0x300: m_mstatus  = value; break;
+    case 0x304: m_mie      = value; break;
+    case 0x305: m_mtvec    = value; break;
+    case 0x340: m_mscratch = value; break;
+    case 0x341: m_mepc     = value; break;
+    case 0x342: m_mcause   = value; break;
+    case 0x343: m_mtval    = value; break;
+    case PERF_CSR_SIM_CTRL:
+    case PERF_CSR_DSCRATCH:
+        if ((value >> 24) == 0)
+        {
+            m_exit      = true;
+            m_exit_code = (int)(value & 0xFF);
+        }
+        else if ((value >> 24) == 1)
+        {
+            putchar(value & 0xFF);
+            fflush(stdout);
+        }
+        break;
+    default:
+        break;
+    }
+}
+//-----------------------------------------------------------------
+// load / store
+//-----------------------------------------------------------------
+uint32_t perf_core::load(uint32_t addr, int bytes, bool sign)
+{
+    uint32_t v = 0;
+    for (int b=0;b<bytes;b++)
+        v |= (uint32_t)m_mem->read(addr + b) << (8 * b);
+
+    if (sign && bytes < 4 && (v & (1u << (8 * bytes - 1))))
+        v |= ~0u << (8 * bytes);
+    return v;
+}
+void perf_core::store(uint32_t addr, uint32_t data, int bytes)
+{
+    m_mem->write_bytes(addr, data, bytes);
+}
+//-----------------------------------------------------------------
+// execute: Functional step. Returns false if the instruction
+// trapped (no timing contribution beyond the redirect).
+//-----------------------------------------------------------------
+bool perf_core::execute(inst &i)
+{
+    uint32_t op  = m_mem->read32(m_pc);
+    uint32_t rd  = (op >> 7)  & 0x1f;
+    uint32_t rs1 = (op >> 15) & 0x1f;
+    uint32_t rs2 = (op >> 20) & 0x1f;
+    uint32_t f3  = (op >> 12) & 0x7;
+    uint32_t f7  = op >> 25;
+    uint32_t a   = m_x[rs1];
+    uint32_t b   = m_x[rs2];
+    uint32_t res = 0;
+
+    memset(&i, 0, sizeof(i));
+    i.pc       = m_pc;
+    i.opcode   = op;
+    i.next_pc  = m_pc + 4;
+    i.cls      = CLASS_ALU;
+    i.rd_valid = true;
+
+    switch (op & 0x7f)
+    {
+    case OP_LUI:
+        res = op & 0xfffff000;
+        break;
+    case OP_AUIPC:
+        res = m_pc + (op & 0xfffff000);
+        break;
+    case OP_JAL:
+        res       = m_pc + 4;
+        i.cls     = CLASS_BRANCH;
+        i.next_pc = m_pc + imm_j(op);
+        i.taken   = true;
+        i.is_call = (rd == 1);
+        i.is_jmp  = true;
+        break;
+    case OP_JALR:
+        res       = m_pc + 4;
+        i.cls     = CLASS_BRANCH;
+        i.next_pc = (a + imm_i(op)) & ~1u;
+        i.taken   = true;
+        i.is_ret  = (rs1 == 1) && (imm_i(op) == 0);
+        i.is_call = !i.is_ret && (rd == 1);
+        i.is_jmp  = !i.is_ret && !i.is_call;
+        break;
+    case OP_BRANCH:
+    {
+        bool t;
+        switch (f3)
+        {
+        case 0:  t = (a == b); break;
+        case 1:  t = (a != b); break;
+        case 4:  t = ((int32_t)a <  (int32_t)b); break;
+        case 5:  t = ((int32_t)a >= (int32_t)b); break;
+        case 6:  t = (a <  b); break;
+        case 7:  t = (a >= b); break;
+        default: trap(CAUSE_ILLEGAL, op); return false;
+        }
+        i.cls      = CLASS_BRANCH;
+        i.rd_valid = false;
+        i.taken    = t;
+        if (t)
+            i.next_pc = m_pc + imm_b(op);
+        break;
+    }
+    case OP_LOAD:
+    {
+        uint32_t addr = a + imm_i(op);
+        int bytes = 1 << (f3 & 3);
+        if (f3 == 3 || f3 > 5)
+        {
+            trap(CAUSE_ILLEGAL, op);
+            return false;
+        }
+        if (addr & (bytes - 1))
+        {
+            trap(CAUSE_MISALIGN_LD, addr);
+            return false;
+        }
+        res        = load(addr, bytes, !(f3 & 4));
+        i.cls      = CLASS_LOAD;
+        i.mem      = true;
+        i.mem_addr = addr;
+        break;
+    }
+    case OP_STORE:
+    {
+        uint32_t addr = a + imm_s(op);
+        int bytes = 1 << (f3 & 3);
+        if (f3 > 2)
+        {
+            trap(CAUSE_ILLEGAL, op);
+            return false;
+        }
+        if (addr & (bytes - 1))
+        {
+            trap(CAUSE_MISALIGN_ST, addr);
+            return false;
+        }
+        store(addr, b, bytes);
+        i.cls      = CLASS_STORE;
+        i.rd_valid = false;
+        i.mem      = true;
+        i.mem_addr = addr;
+        break;
+    }
+    case OP_IMM:
+    case OP_REG:
+    {
+        bool     reg = (op & 0x7f) == OP_REG;
+        uint32_t v   = reg ? b : imm_i(op);
+        uint32_t sh  = v & 0x1f;
+
+        if (reg && f7 == 0x01)
+        {
+            i.cls = (f3 < 4) ? CLASS_MUL : CLASS_DIV;
+            switch (f3)
+            {
+            case 0: res = a * b; break;
+            case 1: res = (uint32_t)(((int64_t)(int32_t)a * (int64_t)(int32_t)b) >> 32); break;
+            case 2: res = (uint32_t)(((int64_t)(int32_t)a * (uint64_t)b) >> 32); break;
+            case 3: res = (uint32_t)(((uint64_t)a * (uint64_t)b) >> 32); break;
+            case 4: res = (b == 0) ? ~0u : (a == 0x80000000 && b == ~0u) ? a : (uint32_t)((int32_t)a / (int32_t)b); break;
+            case 5: res = (b == 0) ? ~0u : a / b; break;
+            case 6: res = (b == 0) ? a : (a == 0x80000000 && b == ~0u) ? 0 : (uint32_t)((int32_t)a % (int32_t)b); break;
+            case 7: res = (b == 0) ? a : a % b; break;
+            }
+
+            if (i.cls == CLASS_DIV)
+            {
+                i.div_repeat  = (m_last_div[0] == f3 && m_last_div[1] == a && m_last_div[2] == b);
+                m_last_div[0] = f3;
+                m_last_div[1] = a;
+                m_last_div[2] = b;
+            }
+            break;
+        }
+
+        switch (f3)
+        {
+        case 0: res = (reg && (f7 & 0x20)) ? (a - v) : (a + v); break;
+        case 1: res = a << sh; break;
+        case 2: res = ((int32_t)a < (int32_t)v) ? 1 : 0; break;
+        case 3: res = (a < v) ? 1 : 0; break;
+        case 4: res = a ^ v; break;
+        case 5: res = (f7 & 0x20) ? (uint32_t)((int32_t)a >> sh) : (a >> sh); break;
+        case 6: res = a | v; break;
+        case 7: res = a & v; break;
+        }
+        break;
+    }
+    case OP_FENCE:
+        // fence / fence.i: serialising, no memory effect here
+        i.cls      = CLASS_CSR;
+        i.rd_valid = false;
+        break;
+    case OP_SYSTEM:
+    {
+        uint32_t csr = op >> 20;
+        i.cls = CLASS_CSR;
+
+        if (f3 == 0)
+        {
+            i.rd_valid = false;
+            if (op == 0x00000073)
+            {
+                trap(CAUSE_ECALL_M, 0);
+                return false;
+            }
+            else if (op == 0x00100073)
+            {
+                trap(CAUSE_BREAKPOINT, m_pc);
+                return false;
+            }
+            else if (op == 0x30200073)
+            {
+                // mret: MIE <= MPIE, MPIE <= 1
+                m_mstatus = (m_mstatus & ~0x88) | ((m_mstatus >> 4) & 0x8) | 0x80;
+                i.next_pc = m_mepc;
+                i.taken   = true;
+            }
+            // wfi / sfence.vma: no-op
+            break;
+        }
+
+        uint32_t src = (f3 & 4) ? rs1 : a;
+        uint32_t old = csr_read(csr);
+        res = old;
+
+        switch (f3 & 3)
+        {
+        case 1: csr_write(csr, src); break;
+        case 2: if (rs1) csr_write(csr, old | src);  break;
+        case 3: if (rs1) csr_write(csr, old & ~src); break;
+        default: trap(CAUSE_ILLEGAL, op); return false;
+        }
+        break;
+    }
+    default:
+        trap(CAUSE_ILLEGAL, op);
+        return false;
+    }
+
+    if (i.rd_valid && rd != 0)
+        m_x[rd] = res;
+
+    m_pc = i.next_pc;
+    m_stats.instret++;
+    return true;
+}
+//-----------------------------------------------------------------
+// mem_penalty: Extra cycles for an access (0 on a hit).
+// Refill = memory latency + one beat per word + fitted overhead,
+// plus the same again to write back a dirty victim first.
+//-----------------------------------------------------------------
+int perf_core::mem_penalty(perf_cache &cache, uint32_t addr, bool write)
+{
+    if (addr < m_cfg.cache_min || addr > m_cfg.cache_max)
+        return m_cfg.uncached + m_cfg.latency;
+
+    bool evict;
+    if (cache.access(addr, write, evict))
+        return 0;
+
+    int refill = m_cfg.latency + (int)(cache.line_size() / 4) + m_cfg.miss_overhead;
+    if (evict)
+        refill += m_cfg.latency + (int)(cache.line_size() / 4);
+    return refill;
+}
+//-----------------------------------------------------------------
+// can_pair: biriscv_issue.v dual_issue_ok_w for the previous
+// instruction (slot A) and this one (slot B)
+//-----------------------------------------------------------------
+bool perf_core::can_pair(const inst &b)
+{
+    const inst &a = m_prev;
+
+    if (!m_cfg.dual_issue || !m_slot_a)
+        return false;
+
+    // Same aligned fetch packet, A in the lower word
+    if ((a.pc & 7) != 0 || b.pc != a.pc + 4 || a.next_pc != b.pc)
+        return false;
+
+    bool a_ok = (a.cls == CLASS_ALU) || (a.cls == CLASS_LOAD) || (a.cls == CLASS_STORE) || (a.cls == CLASS_MUL);
+    if (!a_ok)
+        return false;
+
+    bool a_lsu = (a.cls == CLASS_LOAD) || (a.cls == CLASS_STORE);
+    switch (b.cls)
+    {
+    case CLASS_ALU:
+    case CLASS_BRANCH:
+        break;
+    case CLASS_LOAD:
+    case CLASS_STORE:
+        if (a_lsu)
+            return false;
+        break;
+    case CLASS_MUL:
+        if (a.cls == CLASS_MUL)
+            return false;
+        break;
+    default:
+        return false;
+    }
+
+    // Scoreboard: raw B fields against A's destination
+    uint32_t rd_a = (a.opcode >> 7) & 0x1f;
+    if (a.rd_valid && rd_a != 0)
+    {
+        if (rd_a == ((b.opcode >> 15) & 0x1f) ||
+            rd_a == ((b.opcode >> 20) & 0x1f) ||
+            rd_a == ((b.opcode >> 7)  & 0x1f))
+            return false;
+    }
+
+    return true;
+}
+//-----------------------------------------------------------------
+// timing: Assign an issue cycle to a retired instruction
+//-----------------------------------------------------------------
+void perf_core::timing(const inst &i)
+{
+    uint32_t ra = (i.opcode >> 15) & 0x1f;
+    uint32_t rb = (i.opcode >> 20) & 0x1f;
+    uint32_t rd = (i.opcode >> 7)  & 0x1f;
+
+    // Front end: icache lookup on entering a new line
+    uint32_t line = i.pc >> m_icache.line_shift();
+    if (line != m_fetch_line)
+    {
+        m_fetch_line = line;
+        int pen = mem_penalty(m_icache, i.pc, false);
+        if (pen)
+            m_fetch_ready = ((m_fetch_ready > m_cycle) ? m_fetch_ready : m_cycle) + pen;
+    }
+
+    // Operand readiness (scoreboard uses the raw fields)
+    uint64_t data = m_ready[ra];
+    if (m_ready[rb] > data) data = m_ready[rb];
+    if (m_ready[rd] > data) data = m_ready[rd];
+
+    uint64_t serial = m_serial_until;
+    uint64_t stall  = m_stall_until;
+
+    uint64_t t;
+    if (can_pair(i) && data <= m_cycle && serial <= m_cycle && stall <= m_cycle && m_fetch_ready <= m_cycle)
+    {
+        t = m_cycle;
+        m_slot_a = false;
+        m_stats.dual_issue++;
+    }
+    else
+    {
+        uint64_t base = m_cycle + 1;
+        t = base;
+
+        // Attribute the wait to the dominant cause
+        uint64_t *cnt = NULL;
+        if (m_fetch_ready > t) { t = m_fetch_ready; cnt = &m_stats.stall_frontend; }
+        if (data > t)          { t = data;          cnt = &m_stats.stall_data; }
+        if (serial > t)        { t = serial;        cnt = &m_stats.stall_serial; }
+        if (stall > t)         { t = stall;         cnt = &m_stats.stall_memory; }
+
+        // mul / div / csr cannot follow an LSU op in E1
+        if ((i.cls == CLASS_MUL || i.cls == CLASS_DIV || i.cls == CLASS_CSR) && t == m_lsu_cycle + 1)
+        {
+            t++;
+            cnt = &m_stats.stall_data;
+        }
+
+        if (cnt)
+            *cnt += t - base;
+
+        m_slot_a = true;
+    }
+
+    m_cycle = t;
+
+    // Result latency
+    uint64_t ready = t + 1;
+    switch (i.cls)
+    {
+    case CLASS_LOAD:
+    case CLASS_STORE:
+    {
+        m_lsu_cycle = t;
+        int pen = mem_penalty(m_dcache, i.mem_addr, i.cls == CLASS_STORE);
+        // Cycles are attributed by the instruction that waits on it
+        if (pen)
+            m_stall_until = t + 1 + pen;
+        ready = t + (m_cfg.load_bypass ? 2 : 3) + pen;
+        break;
+    }
+    case CLASS_MUL:
+        ready = t + (m_cfg.mul_bypass ? 2 : 3);
+        break;
+    case CLASS_DIV:
+        ready          = t + (i.div_repeat ? 2 : m_cfg.div_cycles);
+        m_serial_until = ready;
+        break;
+    case CLASS_CSR:
+        ready          = t + m_cfg.csr_cycles;
+        m_serial_until = ready;
+        break;
+    default:
+        break;
+    }
+
+    if (i.rd_valid && rd != 0)
+        m_ready[rd] = ready;
+
+    // Branch prediction / redirect
+    if (i.cls == CLASS_BRANCH)
+    {
+        m_stats.branches++;
+
+        bool shadow = (i.pc & 4) && m_prev.pc == i.pc - 4 && m_bpred.btb_hit(i.pc - 4);
+        uint32_t predicted = m_bpred.predict(i.pc, shadow);
+
+        if (predicted != i.next_pc)
+        {
+            m_stats.mispredicts++;
+            m_fetch_ready = t + m_cfg.bp_penalty + (m_cfg.extra_decode ? 1 : 0);
+            m_fetch_line  = ~0u;
+        }
+        else if (i.taken)
+        {
+            m_fetch_ready = t + 1 + m_cfg.taken_bubble;
+            m_fetch_line  = ~0u;
+        }
+
+        m_bpred.update(i.pc, i.next_pc, i.taken, i.is_call, i.is_ret, i.is_jmp);
+    }
+    else if (i.next_pc != i.pc + 4)
+    {
+        // mret: resolved in the CSR unit
+        m_fetch_ready = t + m_cfg.bp_penalty + (m_cfg.extra_decode ? 1 : 0);
+        m_fetch_line  = ~0u;
+    }
+
+    m_prev = i;
+}
@@ -0,0 +1,204 @@
+#ifndef PERF_CORE_H
+#define PERF_CORE_H
+
+#include <stdint.h>
+
+#include "perf_mem.h"
+#include "perf_cache.h"
+#include "perf_bpred.h"
+#include "perf_bbv.h"
+
+//-----------------------------------------------------------------
+// Defines
+//-----------------------------------------------------------------
+#define PERF_MEM_BASE       0x80000000
+#define PERF_CSR_SIM_CTRL   0x8b2
+#define PERF_CSR_DSCRATCH   0x7b2
+
+//-----------------------------------------------------------------
+// perf_config: Core configuration (riscv_top parameters) and
+// timing constants fitted against the RTL (--fit)
+//-----------------------------------------------------------------
+struct perf_config
+{
+    // riscv_top parameters
+    bool     dual_issue;
+    bool     load_bypass;
+    bool     mul_bypass;
+    bool     extra_decode;
+    bool     bpred;
+    bool     gshare;
+    int      btb_entries;
+    int      bht_entries;
+    int      ras_entries;
+    uint32_t cache_min;
+    uint32_t cache_max;
+
+    // icache.v / dcache_core.v geometry
+    uint32_t icache_size;
+    uint32_t icache_ways;
+    uint32_t dcache_size;
+    uint32_t dcache_ways;
+    uint32_t line_size;
+
+    // Memory (tb_top --latency)
+    int      latency;
+
+    // Timing constants
+    int      bp_penalty;        // Mispredict redirect to next issue
+    int      taken_bubble;      // Correctly predicted taken branch
+    int      miss_overhead;     // Refill cycles beyond latency + beats
+    int      uncached;          // Uncached (peripheral) access
+    int      div_cycles;        // biriscv_divider (non repeat)
+    int      csr_cycles;        // CSR issue to writeback
+
+    perf_config()
+    {
+        dual_issue    = true;
+        load_bypass   = true;
+        mul_bypass    = true;
+        extra_decode  = false;
+        bpred         = true;
+        gshare        = false;
+        btb_entries   = 32;
+        bht_entries   = 512;
+        ras_entries   = 8;
+        cache_min     = 0x80000000;
+        cache_max     = 0x8fffffff;
+        icache_size   = 16 * 1024;
+        icache_ways   = 2;
+        dcache_size   = 16 * 1024;
+        dcache_ways   = 2;
+        line_size     = 32;
+        latency       = 0;
+        bp_penalty    = 3;
+        taken_bubble  = 0;
+        miss_overhead = 3;
+        uncached      = 3;
+        div_cycles    = 34;
+        csr_cycles    = 3;
+    }
+};
+
+//-----------------------------------------------------------------
+// perf_stats: Counters from a run
+//-----------------------------------------------------------------
+struct perf_stats
+{
+    uint64_t cycles;
+    uint64_t instret;
+    uint64_t dual_issue;
+    uint64_t branches;
+    uint64_t mispredicts;
+    uint64_t icache_misses;
+    uint64_t dcache_accesses;
+    uint64_t dcache_misses;
+    uint64_t dcache_writebacks;
+    uint64_t stall_data;        // Operand not ready
+    uint64_t stall_frontend;    // Mispredict / icache
+    uint64_t stall_memory;      // dcache / uncached
+    uint64_t stall_serial;      // div / csr
+};
+
+//-----------------------------------------------------------------
+// perf_core: Cycle approximate model of the biRISC-V pipeline.
+// Executes RV32IM + Zicsr (machine mode) functionally, one instruction at
+// a time in program order, and assigns each an issue cycle using
+// the biriscv_issue.v pairing and scoreboard rules, the
+// biriscv_npc.v predictor and tag-only caches.
+//-----------------------------------------------------------------
+class perf_core
+{
+public:
+    perf_core(perf_mem *mem, const perf_config &cfg);
+
+    void        reset(uint32_t pc);
+
+    // Returns true on SIM_CTRL exit, false at the instruction limit
+    bool        run(uint64_t max_instr);
+
+    perf_stats  get_stats(void);
+    int         get_exit_code(void) { return m_exit_code; }
+    uint32_t    get_pc(void)        { return m_pc; }
+    uint32_t    get_reg(int r)      { return m_x[r & 31]; }
+    uint32_t    get_csr(uint32_t a) { return csr_read(a); }
+    uint64_t    get_instret(void)   { return m_stats.instret; }
+    uint64_t    get_cycle(void)     { return m_cycle; }
+
+    // Basic block vector collection (NULL = off)
+    void        set_bbv(perf_bbv *bbv) { m_bbv = bbv; }
+
+protected:
+    enum eClass
+    {
+        CLASS_ALU,
+        CLASS_MUL,
+        CLASS_DIV,
+        CLASS_LOAD,
+        CLASS_STORE,
+        CLASS_BRANCH,
+        CLASS_CSR
+    };
+
+    struct inst
+    {
+        uint32_t pc;
+        uint32_t opcode;
+        uint32_t next_pc;
+        int      cls;
+        bool     rd_valid;
+        bool     mem;
+        uint32_t mem_addr;
+        bool     is_call;
+        bool     is_ret;
+        bool     is_jmp;
+        bool     taken;
+        bool     div_repeat;
+    };
+
+    bool        execute(inst &i);
+    void        timing(const inst &i);
+    void        trap(uint32_t cause, uint32_t tval);
+    uint32_t    csr_read(uint32_t addr);
+    void        csr_write(uint32_t addr, uint32_t value);
+    uint32_t    load(uint32_t addr, int bytes, bool sign);
+    void        store(uint32_t addr, uint32_t data, int bytes);
+    int         mem_penalty(perf_cache &cache, uint32_t addr, bool write);
+    bool        can_pair(const inst &b);
+
+    perf_mem   *m_mem;
+    perf_bbv   *m_bbv;
+    perf_config m_cfg;
+    perf_cache  m_icache;
+    perf_cache  m_dcache;
+    perf_bpred  m_bpred;
+
+    // Architectural state
+    uint32_t    m_pc;
+    uint32_t    m_x[32];
+    uint32_t    m_mstatus;
+    uint32_t    m_mtvec;
+    uint32_t    m_mepc;
+    uint32_t    m_mcause;
+    uint32_t    m_mtval;
+    uint32_t    m_mscratch;
+    uint32_t    m_mie;
+    bool        m_exit;
+    int         m_exit_code;
+
+    // Timing state
+    uint64_t    m_cycle;            // Issue cycle of the last instruction
+    uint64_t    m_ready[32];        // Register result available (bypass)
+    uint64_t    m_fetch_ready;      // Front end can supply next instruction
+    uint64_t    m_serial_until;     // div / csr pending
+    uint64_t    m_stall_until;      // dcache refill (lsu_stall)
+    uint64_t    m_lsu_cycle;        // Last LSU issue (no mul/div/csr next)
+    uint32_t    m_fetch_line;
+    bool        m_slot_a;           // Last instruction issued alone in slot A
+    inst        m_prev;
+    uint32_t    m_last_div[3];      // {opcode, ra, rb} of last divide
+
+    perf_stats  m_stats;
+};
+
+#endif
@@ -0,0 +1,106 @@
+#ifndef PERF_MEM_H
+#define PERF_MEM_H
+
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+
+#include "mem_api.h"
+
+//-----------------------------------------------------------------
+// perf_mem: Flat memory regions for the performance model.
+// Accesses outside a region read as zero and are otherwise ignored
+// (no peripheral models).
+//-----------------------------------------------------------------
+class perf_mem: public mem_api
+{
+public:
+    struct region
+    {
+        uint32_t               base;
+        uint32_t               size;
+        std::vector <uint8_t>  data;
+    };
+
+    perf_mem() { m_last = NULL; }
+
+    bool create_memory(uint32_t addr, uint32_t size, uint8_t *mem = NULL)
+    {
+        // Already backed (e.g. ELF section inside the RAM region)
+        if (!mem && valid_addr(addr) && valid_addr(addr + size - 1))
+            return true;
+
+        region r;
+        r.base = addr;
+        r.size = size;
+        r.data.resize(size, 0);
+        if (mem)
+            memcpy(&r.data[0], mem, size);
+        m_regions.push_back(r);
+        m_last = NULL;
+        return true;
+    }
+
+    bool valid_addr(uint32_t addr) { return find(addr) != NULL; }
+
+    void write(uint32_t addr, uint8_t data)
+    {
+        region *r = find(addr);
+        if (r)
+            r->data[addr - r->base] = data;
+    }
+
+    uint8_t read(uint32_t addr)
+    {
+        region *r = find(addr);
+        return r ? r->data[addr - r->base] : 0;
+    }
+
+    //-------------------------------------------------------------
+    // Word access (little endian, may straddle regions byte-wise)
+    //-------------------------------------------------------------
+    uint32_t read32(uint32_t addr)
+    {
+        region *r = find(addr);
+        if (r && (addr - r->base) + 4 <= r->size)
+        {
+            uint32_t v;
+            memcpy(&v, &r->data[addr - r->base], 4);
+            return v;
+        }
+        return read(addr) | (read(addr + 1) << 8) | (read(addr + 2) << 16) | ((uint32_t)read(addr + 3) << 24);
+    }
+
+    void write_bytes(uint32_t addr, uint32_t data, int bytes)
+    {
+        for (int i=0;i<bytes;i++)
+            write(addr + i, data >> (8 * i));
+    }
+
+    size_t         num_regions(void)      { return m_regions.size(); }
+    const region & get_region(size_t idx) { return m_regions[idx]; }
+
+    void clear(void)
+    {
+        m_regions.clear();
+        m_last = NULL;
+    }
+
+protected:
+    region *find(uint32_t addr)
+    {
+        if (m_last && (addr - m_last->base) < m_last->size)
+            return m_last;
+
+        for (size_t i=0;i<m_regions.size();i++)
+            if ((addr - m_regions[i].base) < m_regions[i].size)
+                return m_last = &m_regions[i];
+
+        return NULL;
+    }
+
+    std::vector <region> m_regions;
+    region *             m_last;
+};
+
+#endif
@@ -0,0 +1,541 @@
+//-----------------------------------------------------------------
+// perf_model: Cycle approximate biRISC-V performance model.
+// Runs an image functionally and estimates cycles / IPC from the
+// pipeline rules (perf_core), orders of magnitude faster than the
+// RTL. --ref compares against RTL counts (biriscv_run), --fit
+// tunes the timing constants to minimise the IPC error.
+// --bbv / --checkpoint drive SimPoint sampling (simpoint.py).
+//-----------------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <sys/stat.h>
+#include <getopt.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "perf_core.h"
+#include "perf_bbv.h"
+#include "perf_checkpoint.h"
+#include "image_load.h"
+#include "elf_load.h"
+
+//-----------------------------------------------------------------
+// Defines
+//-----------------------------------------------------------------
+#define DEFAULT_RAM_SIZE    (64 * 1024 * 1024)
+#define DEFAULT_MAX_INSTR   1000000000ULL
+#define DEFAULT_INTERVAL    10000000ULL
+
+//-----------------------------------------------------------------
+// ref_entry: RTL reference counts for one image
+//-----------------------------------------------------------------
+struct ref_entry
+{
+    std::string image;
+    uint64_t    cycles;
+    uint64_t    instret;
+};
+
+//-----------------------------------------------------------------
+// load_image: RAM + image into mem, returns entry point (0 = error)
+//-----------------------------------------------------------------
+static uint32_t load_image(const char *image, perf_mem &mem, uint32_t ram_size)
+{
+    if (ram_size)
+        mem.create_memory(PERF_MEM_BASE, ram_size);
+
+    image_load img(image, &mem, PERF_MEM_BASE);
+    if (!img.load())
+    {
+        fprintf(stderr, "ERROR: Could not load %s\n", image);
+        return 0;
+    }
+
+    return img.get_entry_point() ? img.get_entry_point() : PERF_MEM_BASE;
+}
+//-----------------------------------------------------------------
+// run_image: Load and run one image on a fresh model
+//-----------------------------------------------------------------
+static bool run_image(const char *image, const perf_config &cfg, uint32_t ram_size,
+                      uint64_t max_instr, perf_stats &stats, int &exit_code,
+                      perf_bbv *bbv = NULL)
+{
+    perf_mem mem;
+    uint32_t entry = load_image(image, mem, ram_size);
+    if (!entry)
+        return false;
+
+    perf_core core(&mem, cfg);
+    core.reset(entry);
+    core.set_bbv(bbv);
+
+    if (!core.run(max_instr))
+        fprintf(stderr, "WARNING: %s: instruction limit reached (pc 0x%08x)\n", image, core.get_pc());
+
+    if (bbv)
+        bbv->close(core.get_cycle());
+
+    stats     = core.get_stats();
+    exit_code = core.get_exit_code();
+    return true;
+}
+//-----------------------------------------------------------------
+// print_stats
+//-----------------------------------------------------------------
+static void print_stats(const char *image, const perf_stats &s, int exit_code)
+{
+    printf("Image: %s (exit %d)\n", image, exit_code);
+    printf("Cycles: %lu Instructions: %lu IPC: %.3f\n",
+           (unsigned long)s.cycles, (unsigned long)s.instret,
+           s.cycles ? (double)s.instret / s.cycles : 0.0);
+    printf("  Dual issue:   %lu (%.1f%% of instructions)\n",
+           (unsigned long)s.dual_issue, s.instret ? (100.0 * 2 * s.dual_issue) / s.instret : 0.0);
+    printf("  Branches:     %lu, mispredicted %lu (%.2f%%)\n",
+           (unsigned long)s.branches, (unsigned long)s.mispredicts,
+           s.branches ? (100.0 * s.mispredicts) / s.branches : 0.0);
+    printf("  I-cache:      %lu misses\n", (unsigned long)s.icache_misses);
+    printf("  D-cache:      %lu accesses, %lu misses, %lu writebacks\n",
+           (unsigned long)s.dcache_accesses, (unsigned long)s.dcache_misses, (unsigned long)s.dcache_writebacks);
+    printf("  Stall cycles: data %lu, frontend %lu, memory %lu, div/csr %lu\n",
+           (unsigned long)s.stall_data, (unsigned long)s.stall_frontend,
+           (unsigned long)s.stall_memory, (unsigned long)s.stall_serial);
+}
+//-----------------------------------------------------------------
+// load_ref: 'image rtl_cycles rtl_instret' per line, # comments
+//-----------------------------------------------------------------
+static bool load_ref(const char *filename, std::vector<ref_entry> &refs)
+{
+    FILE *f = fopen(filename, "r");
+    if (!f)
+    {
+        fprintf(stderr, "ERROR: Could not open %s\n", filename);
+        return false;
+    }
+
+    char line[1024];
+    while (fgets(line, sizeof(line), f))
+    {
+        char name[768];
+        unsigned long cycles, instret;
+
+        if (line[0] == '#')
+            continue;
+        if (sscanf(line, "%767s %lu %lu", name, &cycles, &instret) != 3)
+            continue;
+
+        ref_entry r;
+        r.image   = name;
+        r.cycles  = cycles;
+        r.instret = instret;
+        refs.push_back(r);
+    }
+
+    fclose(f);
+    return !refs.empty();
+}
+//-----------------------------------------------------------------
+// compare: Run all reference images, returns mean |IPC error| (%)
+//-----------------------------------------------------------------
+static double compare(const std::vector<ref_entry> &refs, const perf_config &cfg,
+                      uint32_t ram_size, uint64_t max_instr, bool verbose)
+{
+    double total = 0;
+    int    count = 0;
+
+    if (verbose)
+        printf("%-32s %12s %12s %8s %8s %8s\n", "Image", "RTL cycles", "Model cycles", "RTL IPC", "Model", "Error");
+
+    for (size_t i=0;i<refs.size();i++)
+    {
+        perf_stats s;
+        int exit_code;
+
+        if (!run_image(refs[i].image.c_str(), cfg, ram_size, max_instr, s, exit_code) || !s.cycles || !refs[i].cycles)
+            continue;
+
+        double rtl_ipc = (double)refs[i].instret / refs[i].cycles;
+        double ipc     = (double)s.instret / s.cycles;
+        double err     = 100.0 * (ipc - rtl_ipc) / rtl_ipc;
+
+        if (verbose)
+        {
+            printf("%-32s %12lu %12lu %8.3f %8.3f %+7.1f%%",
+                   refs[i].image.c_str(), (unsigned long)refs[i].cycles, (unsigned long)s.cycles,
+                   rtl_ipc, ipc, err);
+            if (s.instret != refs[i].instret)
+                printf("  (instret %lu vs %lu)", (unsigned long)s.instret, (unsigned long)refs[i].instret);
+            printf("\n");
+        }
+
+        total += fabs(err);
+        count++;
+    }
+
+    double mean = count ? (total / count) : 0.0;
+    if (verbose)
+        printf("Mean absolute IPC error: %.2f%% (%d images)\n", mean, count);
+    return mean;
+}
+//-----------------------------------------------------------------
+// fit: Grid search over the timing constants
+//-----------------------------------------------------------------
+static void fit(const std::vector<ref_entry> &refs, perf_config &cfg, uint32_t ram_size, uint64_t max_instr)
+{
+    perf_config best = cfg;
+    double best_err  = compare(refs, cfg, ram_size, max_instr, false);
+
+    for (int bp=1;bp<=6;bp++)
+        for (int miss=0;miss<=12;miss+=2)
+            for (int taken=0;taken<=1;taken++)
+            {
+                perf_config c = cfg;
+                c.bp_penalty    = bp;
+                c.miss_overhead = miss;
+                c.taken_bubble  = taken;
+
+                double err = compare(refs, c, ram_size, max_instr, false);
+                if (err < best_err)
+                {
+                    best_err = err;
+                    best     = c;
+                }
+            }
+
+    cfg = best;
+    printf("Fit: --bp-penalty %d --miss-overhead %d --taken-bubble %d (mean error %.2f%%)\n",
+           cfg.bp_penalty, cfg.miss_overhead, cfg.taken_bubble, best_err);
+}
+
+//-----------------------------------------------------------------
+// load_symbols: ELF function symbols (spec may carry @addr)
+//-----------------------------------------------------------------
+static void load_symbols(const char *image, perf_bbv &bbv)
+{
+    std::string filename = image;
+    size_t pos = filename.rfind('@');
+    if (pos != std::string::npos)
+        filename = filename.substr(0, pos);
+
+    std::map<uint32_t, std::string> symbols;
+    elf_load elf(filename.c_str(), NULL);
+    if (elf.get_symbols(symbols))
+        bbv.set_symbols(symbols);
+}
+//-----------------------------------------------------------------
+// checkpoint: Save state at the start of each selected interval
+// ('interval cluster' per line, SimPoint .simpoints format) and
+// the model cycles of the interval as the RTL cycle budget.
+//-----------------------------------------------------------------
+static bool checkpoint(const char *image, const char *simpoints, const char *dir,
+                       const perf_config &cfg, uint32_t ram_size, uint64_t interval, uint32_t stub_addr)
+{
+    std::vector<uint64_t> starts;
+
+    FILE *f = fopen(simpoints, "r");
+    if (!f)
+    {
+        fprintf(stderr, "ERROR: Could not open %s\n", simpoints);
+        return false;
+    }
+
+    unsigned long idx, cluster;
+    while (fscanf(f, "%lu %lu", &idx, &cluster) == 2)
+        starts.push_back(idx);
+    fclose(f);
+
+    std::sort(starts.begin(), starts.end());
+
+    perf_mem mem;
+    uint32_t entry = load_image(image, mem, ram_size);
+    if (!entry)
+        return false;
+
+    perf_core core(&mem, cfg);
+    core.reset(entry);
+
+    mkdir(dir, 0755);
+    std::string list = std::string(dir) + "/simpoints.run";
+    FILE *out = fopen(list.c_str(), "w");
+    if (!out)
+    {
+        fprintf(stderr, "ERROR: Could not create %s\n", list.c_str());
+        return false;
+    }
+    fprintf(out, "# interval model_cycles args\n");
+
+    bool via_mret = false;
+
+    for (size_t i=0;i<starts.size();i++)
+    {
+        uint64_t start = starts[i] * interval;
+        if (start > core.get_instret())
+            core.run(start - core.get_instret());
+        if (core.get_instret() < start)
+        {
+            fprintf(stderr, "ERROR: Program exited before instruction %lu\n", (unsigned long)start);
+            break;
+        }
+
+        char sub[64];
+        snprintf(sub, sizeof(sub), "/%lu", (unsigned long)starts[i]);
+
+        perf_checkpoint ckpt(&core, &mem, stub_addr);
+        if (!ckpt.save((std::string(dir) + sub).c_str()))
+        {
+            fclose(out);
+            return false;
+        }
+
+        printf("Checkpoint %lu: instruction %lu, pc 0x%08x\n",
+               (unsigned long)starts[i], (unsigned long)start, core.get_pc());
+        via_mret |= ckpt.via_mret();
+
+        uint64_t cycle = core.get_cycle();
+        core.run(interval);
+
+        fprintf(out, "%lu %lu %s\n", (unsigned long)starts[i],
+                (unsigned long)(core.get_cycle() - cycle), ckpt.get_args().c_str());
+    }
+
+    fclose(out);
+
+    if (via_mret)
+        printf("NOTE: Boot stub beyond jal range of the pc, returns via mret (mepc not preserved)\n");
+    return true;
+}
+
+//-----------------------------------------------------------------
+// Command line options
+//-----------------------------------------------------------------
+#define GETOPTS_ARGS "c:r:l:i:d:sBMxng:P:O:T:R:Fb:I:k:K:S:h"
+
+static struct option long_options[] =
+{
+    {"max-instr",     required_argument, 0, 'c'},
+    {"ram-size",      required_argument, 0, 'r'},
+    {"latency",       required_argument, 0, 'l'},
+    {"icache",        required_argument, 0, 'i'},
+    {"dcache",        required_argument, 0, 'd'},
+    {"single-issue",  no_argument,       0, 's'},
+    {"no-load-bypass",no_argument,       0, 'B'},
+    {"no-mul-bypass", no_argument,       0, 'M'},
+    {"extra-decode",  no_argument,       0, 'x'},
+    {"no-bpred",      no_argument,       0, 'n'},
+    {"gshare",        required_argument, 0, 'g'},
+    {"bp-penalty",    required_argument, 0, 'P'},
+    {"miss-overhead", required_argument, 0, 'O'},
+    {"taken-bubble",  required_argument, 0, 'T'},
+    {"ref",           required_argument, 0, 'R'},
+    {"fit",           no_argument,       0, 'F'},
+    {"bbv",           required_argument, 0, 'b'},
+    {"interval",      required_argument, 0, 'I'},
+    {"checkpoint",    required_argument, 0, 'k'},
+    {"checkpoint-dir",required_argument, 0, 'K'},
+    {"stub-addr",     required_argument, 0, 'S'},
+    {"help",          no_argument,       0, 'h'},
+    {0, 0, 0, 0}
+};
+
+static void help_options(void)
+{
+    perf_config d;
+    fprintf (stderr,"Usage: perf_model [options] image [image ...]\n");
+    fprintf (stderr,"  --max-instr      | -c NUM        Instruction limit per image (default %llu)\n", DEFAULT_MAX_INSTR);
+    fprintf (stderr,"  --ram-size       | -r BYTES      RAM at 0x%08x independent of image (default %d)\n", PERF_MEM_BASE, DEFAULT_RAM_SIZE);
+    fprintf (stderr,"  --latency        | -l NUM        Memory latency (tb_top --latency, default %d)\n", d.latency);
+    fprintf (stderr,"  --icache         | -i SIZE:WAYS  I-cache geometry (default %u:%u)\n", d.icache_size, d.icache_ways);
+    fprintf (stderr,"  --dcache         | -d SIZE:WAYS  D-cache geometry (default %u:%u)\n", d.dcache_size, d.dcache_ways);
+    fprintf (stderr,"  --single-issue   | -s            SUPPORT_DUAL_ISSUE=0\n");
+    fprintf (stderr,"  --no-load-bypass | -B            SUPPORT_LOAD_BYPASS=0\n");
+    fprintf (stderr,"  --no-mul-bypass  | -M            SUPPORT_MUL_BYPASS=0\n");
+    fprintf (stderr,"  --extra-decode   | -x            EXTRA_DECODE_STAGE=1\n");
+    fprintf (stderr,"  --no-bpred       | -n            SUPPORT_BRANCH_PREDICTION=0\n");
+    fprintf (stderr,"  --gshare         | -g 0|1        GSHARE_ENABLE (default %d)\n", d.gshare);
+    fprintf (stderr,"  --bp-penalty     | -P NUM        Mispredict penalty (default %d)\n", d.bp_penalty);
+    fprintf (stderr,"  --miss-overhead  | -O NUM        Cache refill overhead (default %d)\n", d.miss_overhead);
+    fprintf (stderr,"  --taken-bubble   | -T NUM        Predicted taken branch bubble (default %d)\n", d.taken_bubble);
+    fprintf (stderr,"  --ref            | -R FILE       Compare with RTL counts ('image cycles instret' per line)\n");
+    fprintf (stderr,"  --fit            | -F            Fit timing constants to --ref before comparing\n");
+    fprintf (stderr,"  --bbv            | -b FILE       Basic block vectors per interval (SimPoint .bb)\n");
+    fprintf (stderr,"  --interval       | -I NUM        BBV / checkpoint interval (default %llu instructions)\n", DEFAULT_INTERVAL);
+    fprintf (stderr,"  --checkpoint     | -k FILE       Checkpoint intervals listed in FILE (simpoint.py output)\n");
+    fprintf (stderr,"  --checkpoint-dir | -K DIR        Checkpoint output directory (default 'checkpoints')\n");
+    fprintf (stderr,"  --stub-addr      | -S ADDR       Checkpoint boot stub (default free memory near the pc)\n");
+    exit(-1);
+}
+
+//-----------------------------------------------------------------
+// parse_geometry: SIZE:WAYS
+//-----------------------------------------------------------------
+static bool parse_geometry(const char *str, uint32_t &size, uint32_t &ways)
+{
+    char *end = NULL;
+    size = (uint32_t)strtoul(str, &end, 0);
+    if (*end == 'K' || *end == 'k')
+    {
+        size *= 1024;
+        end++;
+    }
+    if (*end != ':')
+        return false;
+    ways = (uint32_t)strtoul(end + 1, NULL, 0);
+    return size && ways;
+}
+
+//-----------------------------------------------------------------
+// main
+//-----------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+    perf_config  cfg;
+    uint64_t     max_instr = DEFAULT_MAX_INSTR;
+    uint32_t     ram_size  = DEFAULT_RAM_SIZE;
+    const char * ref       = NULL;
+    bool         do_fit    = false;
+    const char * bbv_file  = NULL;
+    uint64_t     interval  = DEFAULT_INTERVAL;
+    const char * ckpt_file = NULL;
+    const char * ckpt_dir  = "checkpoints";
+    uint32_t     stub_addr = 0;
+    int          help      = 0;
+    int c;
+
+    int option_index = 0;
+    while ((c = getopt_long (argc, argv, GETOPTS_ARGS, long_options, &option_index)) != -1)
+    {
+        switch(c)
+        {
+            case 'c':
+                max_instr = strtoull(optarg, NULL, 0);
+                break;
+            case 'r':
+                ram_size = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'l':
+                cfg.latency = atoi(optarg);
+                break;
+            case 'i':
+                if (!parse_geometry(optarg, cfg.icache_size, cfg.icache_ways))
+                    help = 1;
+                break;
+            case 'd':
+                if (!parse_geometry(optarg, cfg.dcache_size, cfg.dcache_ways))
+                    help = 1;
+                break;
+            case 's':
+                cfg.dual_issue = false;
+                break;
+            case 'B':
+                cfg.load_bypass = false;
+                break;
+            case 'M':
+                cfg.mul_bypass = false;
+                break;
+            case 'x':
+                cfg.extra_decode = true;
+                break;
+            case 'n':
+                cfg.bpred = false;
+                break;
+            case 'g':
+                cfg.gshare = atoi(optarg) != 0;
+                break;
+            case 'P':
+                cfg.bp_penalty = atoi(optarg);
+                break;
+            case 'O':
+                cfg.miss_overhead = atoi(optarg);
+                break;
+            case 'T':
+                cfg.taken_bubble = atoi(optarg);
+                break;
+            case 'R':
+                ref = optarg;
+                break;
+            case 'F':
+                do_fit = true;
+                break;
+            case 'b':
+                bbv_file = optarg;
+                break;
+            case 'I':
+                interval = strtoull(optarg, NULL, 0);
+                break;
+            case 'k':
+                ckpt_file = optarg;
+                break;
+            case 'K':
+                ckpt_dir = optarg;
+                break;
+            case 'S':
+                stub_addr = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case '?':
+            default:
+                help = 1;
+                break;
+        }
+    }
+
+    if (help || (!ref && optind >= argc) || (do_fit && !ref) || !interval)
+        help_options();
+
+    if ((bbv_file || ckpt_file) && optind + 1 != argc)
+    {
+        fprintf(stderr, "ERROR: --bbv / --checkpoint take a single image\n");
+        return -1;
+    }
+
+    if (ckpt_file)
+    {
+        return checkpoint(argv[optind], ckpt_file, ckpt_dir, cfg, ram_size, interval, stub_addr) ? 0 : -1;
+    }
+
+    if (bbv_file)
+    {
+        perf_bbv bbv(interval);
+        if (!bbv.open(bbv_file))
+            return -1;
+        load_symbols(argv[optind], bbv);
+
+        perf_stats s;
+        int exit_code;
+        if (!run_image(argv[optind], cfg, ram_size, max_instr, s, exit_code, &bbv))
+            return -1;
+        print_stats(argv[optind], s, exit_code);
+        printf("BBV: %lu intervals of %lu instructions -> %s\n",
+               (unsigned long)bbv.get_intervals(), (unsigned long)interval, bbv_file);
+        return 0;
+    }
+
+    if (ref)
+    {
+        std::vector<ref_entry> refs;
+        if (!load_ref(ref, refs))
+        {
+            fprintf(stderr, "ERROR: No reference entries in %s\n", ref);
+            return -1;
+        }
+
+        if (do_fit)
+            fit(refs, cfg, ram_size, max_instr);
+
+        compare(refs, cfg, ram_size, max_instr, true);
+        return 0;
+    }
+
+    for (int i=optind;i<argc;i++)
+    {
+        perf_stats s;
+        int exit_code;
+
+        if (!run_image(argv[i], cfg, ram_size, max_instr, s, exit_code))
+            return -1;
+        print_stats(argv[i], s, exit_code);
+    }
+
+    return 0;
+}
@@ -0,0 +1,234 @@
+#!/usr/bin/env python3
+###############################################################################
+# simpoint.py: Pick representative intervals from basic block vectors
+#
+# Input is a SimPoint .bb file from 'perf_model --bbv'. Vectors are
+# normalised, randomly projected and clustered with k-means; k is the
+# smallest whose BIC reaches --bic of the best score. One interval per
+# cluster (closest to the centroid) is written with its weight:
+#
+#   PREFIX.simpoints   'interval cluster'
+#   PREFIX.weights     'weight cluster'
+#
+# --estimate combines per-interval RTL results ('interval cycles instret',
+# e.g. from 'make simpoint_rtl') into a whole program IPC.
+#
+#   ./simpoint.py coremark.bb -k 10
+#   ./simpoint.py coremark.bb --estimate rtl.txt
+###############################################################################
+import argparse
+import math
+import os
+import random
+import sys
+
+###############################################################################
+# load_bb: .bb -> list of {block id: instructions}
+###############################################################################
+def load_bb(filename):
+    vectors = []
+    with open(filename) as f:
+        for line in f:
+            line = line.strip()
+            if not line.startswith('T'):
+                continue
+            vec = {}
+            for item in line[1:].split():
+                _, bb, count = item.split(':')
+                vec[int(bb)] = int(count)
+            vectors.append(vec)
+    return vectors
+
+###############################################################################
+# project: Normalise and project onto 'dim' random dimensions
+###############################################################################
+def project(vectors, dim, seed):
+    basis = {}
+    points = []
+    for vec in vectors:
+        total = float(sum(vec.values())) or 1.0
+        p = [0.0] * dim
+        for bb, count in vec.items():
+            if bb not in basis:
+                rng = random.Random(seed * 1000003 + bb)
+                basis[bb] = [rng.uniform(-1.0, 1.0) for _ in range(dim)]
+            w = count / total
+            b = basis[bb]
+            for d in range(dim):
+                p[d] += w * b[d]
+        points.append(p)
+    return points
+
+def dist2(a, b):
+    return sum((x - y) * (x - y) for x, y in zip(a, b))
+
+###############################################################################
+# kmeans: k-means++ seeding, best of 'restarts' by distortion
+###############################################################################
+def kmeans(points, k, seed, restarts=5, iters=100):
+    best = None
+    for r in range(restarts):
+        rng = random.Random(seed + 7919 * r)
+        centres = [list(rng.choice(points))]
+        while len(centres) < k:
+            d = [min(dist2(p, c) for c in centres) for p in points]
+            total = sum(d)
+            if total == 0:
+                centres.append(list(rng.choice(points)))
+                continue
+            x = rng.uniform(0, total)
+            for i, di in enumerate(d):
+                x -= di
+                if x <= 0:
+                    break
+            centres.append(list(points[i]))
+
+        assign = [0] * len(points)
+        for _ in range(iters):
+            changed = False
+            for i, p in enumerate(points):
+                c = min(range(k), key=lambda j: dist2(p, centres[j]))
+                if c != assign[i]:
+                    assign[i] = c
+                    changed = True
+            for j in range(k):
+                members = [points[i] for i in range(len(points)) if assign[i] == j]
+                if members:
+                    centres[j] = [sum(col) / len(members) for col in zip(*members)]
+            if not changed:
+                break
+
+        sse = sum(dist2(p, centres[assign[i]]) for i, p in enumerate(points))
+        if best is None or sse < best[0]:
+            best = (sse, centres, assign)
+    return best
+
+###############################################################################
+# bic: Spherical Gaussian BIC (Pelleg & Moore, as SimPoint)
+###############################################################################
+def bic(points, k, sse, assign):
+    r = len(points)
+    m = len(points[0])
+    if r <= k:
+        return float('-inf')
+    var = max(sse / (m * (r - k)), 1e-12)
+
+    ll = 0.0
+    for j in range(k):
+        rj = assign.count(j)
+        if rj == 0:
+            continue
+        ll += (rj * math.log(rj) - rj * math.log(r)
+               - rj * m / 2.0 * math.log(2.0 * math.pi * var)
+               - (rj - 1) * m / 2.0)
+    params = (k - 1) + m * k + 1
+    return ll - params / 2.0 * math.log(r)
+
+###############################################################################
+# load_weights / load_results
+###############################################################################
+def load_pairs(filename):
+    pairs = []
+    with open(filename) as f:
+        for line in f:
+            fields = line.split()
+            if len(fields) >= 2 and not line.startswith('#'):
+                pairs.append(fields)
+    return pairs
+
+def estimate(args, prefix):
+    points  = dict((int(c), int(i)) for i, c in load_pairs(prefix + '.simpoints'))
+    weights = dict((int(c), float(w)) for w, c in load_pairs(prefix + '.weights'))
+    results = dict((int(f[0]), (int(f[1]), int(f[2]))) for f in load_pairs(args.estimate))
+
+    cpi   = 0.0
+    total = 0.0
+    for cluster, interval in sorted(points.items()):
+        if interval not in results:
+            sys.stderr.write('WARNING: No result for interval %d (cluster %d)\n' % (interval, cluster))
+            continue
+        cycles, instret = results[interval]
+        if not instret:
+            continue
+        print('Interval %-8d weight %.3f  IPC %.3f' % (interval, weights[cluster], float(instret) / cycles))
+        cpi   += weights[cluster] * float(cycles) / instret
+        total += weights[cluster]
+
+    if total == 0:
+        sys.stderr.write('ERROR: No usable results\n')
+        return 1
+
+    print('Estimated IPC: %.3f (%.0f%% of weight covered)' % (total / cpi, 100.0 * total))
+    return 0
+
+###############################################################################
+# main
+###############################################################################
+def main():
+    parser = argparse.ArgumentParser(description='SimPoint interval selection')
+    parser.add_argument('bb', help='Basic block vectors (perf_model --bbv)')
+    parser.add_argument('-o', dest='prefix', default=None, help='Output prefix (default: bb file without .bb)')
+    parser.add_argument('-k', dest='maxk', type=int, default=10, help='Max clusters')
+    parser.add_argument('--dim', type=int, default=15, help='Projected dimensions')
+    parser.add_argument('--bic', type=float, default=0.9, help='BIC threshold (fraction of range)')
+    parser.add_argument('--seed', type=int, default=1)
+    parser.add_argument('--estimate', metavar='RESULTS', default=None,
+                        help="Combine RTL results ('interval cycles instret' per line)")
+    args = parser.parse_args()
+
+    prefix = args.prefix or (args.bb[:-3] if args.bb.endswith('.bb') else args.bb)
+
+    if args.estimate:
+        return estimate(args, prefix)
+
+    vectors = load_bb(args.bb)
+    if not vectors:
+        sys.stderr.write('ERROR: No intervals in %s\n' % args.bb)
+        return 1
+
+    points = project(vectors, args.dim, args.seed)
+
+    runs = []
+    for k in range(1, min(args.maxk, len(points)) + 1):
+        sse, centres, assign = kmeans(points, k, args.seed)
+        runs.append((k, bic(points, k, sse, assign), centres, assign))
+
+    scores = [s for _, s, _, _ in runs if s != float('-inf')] or [0.0]
+    lo, hi = min(scores), max(scores)
+    k, score, centres, assign = next(r for r in runs if r[1] >= lo + args.bic * (hi - lo))
+
+    # Representative interval and weight per cluster
+    chosen = []
+    for j in range(k):
+        members = [i for i in range(len(points)) if assign[i] == j]
+        if members:
+            rep = min(members, key=lambda i: dist2(points[i], centres[j]))
+            chosen.append((j, rep, float(len(members)) / len(points)))
+
+    with open(prefix + '.simpoints', 'w') as f:
+        for j, rep, _ in chosen:
+            f.write('%d %d\n' % (rep, j))
+    with open(prefix + '.weights', 'w') as f:
+        for j, _, w in chosen:
+            f.write('%.6f %d\n' % (w, j))
+
+    print('%d intervals, k=%d' % (len(points), k))
+    for j, rep, w in chosen:
+        print('  cluster %-3d interval %-8d weight %.3f' % (j, rep, w))
+
+    # Sampling error against the model's own per-interval timing
+    ipc_file = args.bb + '.ipc'
+    if os.path.exists(ipc_file):
+        ipc = dict((int(f[0]), (int(f[1]), int(f[2]))) for f in load_pairs(ipc_file))
+        cycles  = sum(c for c, _ in ipc.values())
+        instret = sum(n for _, n in ipc.values())
+        cpi = sum(w * float(ipc[rep][0]) / ipc[rep][1] for _, rep, w in chosen if ipc[rep][1])
+        if cycles and cpi:
+            full = float(instret) / cycles
+            print('Model IPC: full run %.3f, from simpoints %.3f (%+.2f%%)'
+                  % (full, 1.0 / cpi, 100.0 * (1.0 / cpi - full) / full))
+
+    return 0
+
+if __name__ == '__main__':
+    sys.exit(main())
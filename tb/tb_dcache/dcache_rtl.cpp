@@ -0,0 +1,109 @@
+#include "dcache_rtl.h"
+#include "Vdcache.h"
+
+//-------------------------------------------------------------
+// Constructor
+//-------------------------------------------------------------
+dcache_rtl::dcache_rtl(sc_module_name name): sc_module(name)
+{
+    m_rtl = new Vdcache("Vdcache");
+    m_rtl->clk_i(clk_in);
+    m_rtl->rst_i(rst_in);
+    m_rtl->mem_addr_i(mem_addr_in);
+    m_rtl->mem_data_wr_i(mem_data_wr_in);
+    m_rtl->mem_rd_i(mem_rd_in);
+    m_rtl->mem_wr_i(mem_wr_in);
+    m_rtl->mem_cacheable_i(mem_cacheable_in);
+    m_rtl->mem_req_tag_i(mem_req_tag_in);
+    m_rtl->mem_invalidate_i(mem_invalidate_in);
+    m_rtl->mem_writeback_i(mem_writeback_in);
+    m_rtl->mem_flush_i(mem_flush_in);
+    m_rtl->mem_data_rd_o(mem_data_rd_out);
+    m_rtl->mem_accept_o(mem_accept_out);
+    m_rtl->mem_ack_o(mem_ack_out);
+    m_rtl->mem_error_o(mem_error_out);
+    m_rtl->mem_resp_tag_o(mem_resp_tag_out);
+    m_rtl->axi_awready_i(m_axi_awready_in);
+    m_rtl->axi_wready_i(m_axi_wready_in);
+    m_rtl->axi_bvalid_i(m_axi_bvalid_in);
+    m_rtl->axi_bresp_i(m_axi_bresp_in);
+    m_rtl->axi_bid_i(m_axi_bid_in);
+    m_rtl->axi_arready_i(m_axi_arready_in);
+    m_rtl->axi_rvalid_i(m_axi_rvalid_in);
+    m_rtl->axi_rdata_i(m_axi_rdata_in);
+    m_rtl->axi_rresp_i(m_axi_rresp_in);
+    m_rtl->axi_rid_i(m_axi_rid_in);
+    m_rtl->axi_rlast_i(m_axi_rlast_in);
+    m_rtl->axi_awvalid_o(m_axi_awvalid_out);
+    m_rtl->axi_awaddr_o(m_axi_awaddr_out);
+    m_rtl->axi_awid_o(m_axi_awid_out);
+    m_rtl->axi_awlen_o(m_axi_awlen_out);
+    m_rtl->axi_awburst_o(m_axi_awburst_out);
+    m_rtl->axi_wvalid_o(m_axi_wvalid_out);
+    m_rtl->axi_wdata_o(m_axi_wdata_out);
+    m_rtl->axi_wstrb_o(m_axi_wstrb_out);
+    m_rtl->axi_wlast_o(m_axi_wlast_out);
+    m_rtl->axi_bready_o(m_axi_bready_out);
+    m_rtl->axi_arvalid_o(m_axi_arvalid_out);
+    m_rtl->axi_araddr_o(m_axi_araddr_out);
+    m_rtl->axi_arid_o(m_axi_arid_out);
+    m_rtl->axi_arlen_o(m_axi_arlen_out);
+    m_rtl->axi_arburst_o(m_axi_arburst_out);
+    m_rtl->axi_rready_o(m_axi_rready_out);
+
+    SC_METHOD(async_outputs);
+    sensitive << axi_in;
+    sensitive << m_axi_awvalid_out;
+    sensitive << m_axi_awaddr_out;
+    sensitive << m_axi_awid_out;
+    sensitive << m_axi_awlen_out;
+    sensitive << m_axi_awburst_out;
+    sensitive << m_axi_wvalid_out;
+    sensitive << m_axi_wdata_out;
+    sensitive << m_axi_wstrb_out;
+    sensitive << m_axi_wlast_out;
+    sensitive << m_axi_bready_out;
+    sensitive << m_axi_arvalid_out;
+    sensitive << m_axi_araddr_out;
+    sensitive << m_axi_arid_out;
+    sensitive << m_axi_arlen_out;
+    sensitive << m_axi_arburst_out;
+    sensitive << m_axi_rready_out;
+}
+//-------------------------------------------------------------
+// async_outputs: AXI struct <-> RTL pins
+//-------------------------------------------------------------
+void dcache_rtl::async_outputs(void)
+{
+    axi4_slave axi_i = axi_in.read();
+    m_axi_awready_in.write(axi_i.AWREADY);
+    m_axi_wready_in.write(axi_i.WREADY);
+    m_axi_bvalid_in.write(axi_i.BVALID);
+    m_axi_bresp_in.write(axi_i.BRESP);
+    m_axi_bid_in.write(axi_i.BID);
+    m_axi_arready_in.write(axi_i.ARREADY);
+    m_axi_rvalid_in.write(axi_i.RVALID);
+    m_axi_rdata_in.write(axi_i.RDATA);
+    m_axi_rresp_in.write(axi_i.RRESP);
+    m_axi_rid_in.write(axi_i.RID);
+    m_axi_rlast_in.write(axi_i.RLAST);
+
+    axi4_master axi_o;
+    axi_o.AWVALID = m_axi_awvalid_out.read();
+    axi_o.AWADDR = m_axi_awaddr_out.read();
+    axi_o.AWID = m_axi_awid_out.read();
+    axi_o.AWLEN = m_axi_awlen_out.read();
+    axi_o.AWBURST = m_axi_awburst_out.read();
+    axi_o.WVALID = m_axi_wvalid_out.read();
+    axi_o.WDATA = m_axi_wdata_out.read();
+    axi_o.WSTRB = m_axi_wstrb_out.read();
+    axi_o.WLAST = m_axi_wlast_out.read();
+    axi_o.BREADY = m_axi_bready_out.read();
+    axi_o.ARVALID = m_axi_arvalid_out.read();
+    axi_o.ARADDR = m_axi_araddr_out.read();
+    axi_o.ARID = m_axi_arid_out.read();
+    axi_o.ARLEN = m_axi_arlen_out.read();
+    axi_o.ARBURST = m_axi_arburst_out.read();
+    axi_o.RREADY = m_axi_rready_out.read();
+    axi_out.write(axi_o);
+}
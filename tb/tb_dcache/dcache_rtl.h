@@ -0,0 +1,106 @@
+#ifndef DCACHE_RTL_H
+#define DCACHE_RTL_H
+#include <systemc.h>
+
+#include "axi4.h"
+
+class Vdcache;
+class VerilatedVcdC;
+
+//-------------------------------------------------------------
+// dcache_rtl: RTL wrapper class (dcache.v)
+//-------------------------------------------------------------
+class dcache_rtl: public sc_module
+{
+public:
+    sc_in <bool> clk_in;
+    sc_in <bool> rst_in;
+
+    // LSU side
+    sc_in  <sc_uint<32> > mem_addr_in;
+    sc_in  <sc_uint<32> > mem_data_wr_in;
+    sc_in  <bool>         mem_rd_in;
+    sc_in  <sc_uint<4> >  mem_wr_in;
+    sc_in  <bool>         mem_cacheable_in;
+    sc_in  <sc_uint<11> > mem_req_tag_in;
+    sc_in  <bool>         mem_invalidate_in;
+    sc_in  <bool>         mem_writeback_in;
+    sc_in  <bool>         mem_flush_in;
+
+    sc_out <sc_uint<32> > mem_data_rd_out;
+    sc_out <bool>         mem_accept_out;
+    sc_out <bool>         mem_ack_out;
+    sc_out <bool>         mem_error_out;
+    sc_out <sc_uint<11> > mem_resp_tag_out;
+
+    // Memory side
+    sc_in  <axi4_slave>  axi_in;
+    sc_out <axi4_master> axi_out;
+
+    //-------------------------------------------------------------
+    // Constructor
+    //-------------------------------------------------------------
+    SC_HAS_PROCESS(dcache_rtl);
+    dcache_rtl(sc_module_name name);
+
+    //-------------------------------------------------------------
+    // Trace
+    //-------------------------------------------------------------
+    virtual void add_trace(sc_trace_file *vcd, std::string prefix)
+    {
+        #undef  TRACE_SIGNAL
+        #define TRACE_SIGNAL(s) sc_trace(vcd,s,prefix + #s)
+
+        TRACE_SIGNAL(clk_in);
+        TRACE_SIGNAL(rst_in);
+        TRACE_SIGNAL(mem_addr_in);
+        TRACE_SIGNAL(mem_rd_in);
+        TRACE_SIGNAL(mem_wr_in);
+        TRACE_SIGNAL(mem_accept_out);
+        TRACE_SIGNAL(mem_ack_out);
+        TRACE_SIGNAL(axi_in);
+        TRACE_SIGNAL(axi_out);
+
+        #undef  TRACE_SIGNAL
+    }
+
+    void async_outputs(void);
+
+    //-------------------------------------------------------------
+    // Signals
+    //-------------------------------------------------------------
+private:
+    sc_signal <bool> m_axi_awready_in;
+    sc_signal <bool> m_axi_wready_in;
+    sc_signal <bool> m_axi_bvalid_in;
+    sc_signal <sc_uint<2> > m_axi_bresp_in;
+    sc_signal <sc_uint<4> > m_axi_bid_in;
+    sc_signal <bool> m_axi_arready_in;
+    sc_signal <bool> m_axi_rvalid_in;
+    sc_signal <sc_uint<32> > m_axi_rdata_in;
+    sc_signal <sc_uint<2> > m_axi_rresp_in;
+    sc_signal <sc_uint<4> > m_axi_rid_in;
+    sc_signal <bool> m_axi_rlast_in;
+
+    sc_signal <bool> m_axi_awvalid_out;
+    sc_signal <sc_uint<32> > m_axi_awaddr_out;
+    sc_signal <sc_uint<4> > m_axi_awid_out;
+    sc_signal <sc_uint<8> > m_axi_awlen_out;
+    sc_signal <sc_uint<2> > m_axi_awburst_out;
+    sc_signal <bool> m_axi_wvalid_out;
+    sc_signal <sc_uint<32> > m_axi_wdata_out;
+    sc_signal <sc_uint<4> > m_axi_wstrb_out;
+    sc_signal <bool> m_axi_wlast_out;
+    sc_signal <bool> m_axi_bready_out;
+    sc_signal <bool> m_axi_arvalid_out;
+    sc_signal <sc_uint<32> > m_axi_araddr_out;
+    sc_signal <sc_uint<4> > m_axi_arid_out;
+    sc_signal <sc_uint<8> > m_axi_arlen_out;
+    sc_signal <sc_uint<2> > m_axi_arburst_out;
+    sc_signal <bool> m_axi_rready_out;
+
+public:
+    Vdcache *m_rtl;
+};
+
+#endif
@@ -0,0 +1,608 @@
+#include "testbench_vbase.h"
+#include <getopt.h>
+#include <unistd.h>
+#include <vector>
+#include <algorithm>
+
+#include "dcache_rtl.h"
+#include "tb_axi4_mem.h"
+#include "tb_axi4_trace.h"
+
+#include "verilated.h"
+#include "verilated_vcd_sc.h"
+
+#define MEM_BASE            0x80000000
+#define LINE_SIZE           32
+
+// Request tags (mem_req_tag_i width)
+#define TAG_W               11
+#define TAG_NUM             (1 << TAG_W)
+
+// Latency histogram (cycles, last bucket is overflow)
+#define LAT_BUCKETS         4096
+
+// Give up if the cache stops responding
+#define STALL_TIMEOUT       100000
+
+//-----------------------------------------------------------------
+// Request stream patterns
+//-----------------------------------------------------------------
+typedef enum
+{
+    PATTERN_STREAM,     // Sequential words
+    PATTERN_STRIDE,     // Fixed stride through the footprint
+    PATTERN_RANDOM,     // Uniform random words in the footprint
+    PATTERN_CHASE,      // Dependent loads through a random line chain
+    PATTERN_TRACE       // LSU records of an access trace (tb_top -A)
+} ePATTERN;
+
+//-----------------------------------------------------------------
+// Command line options
+//-----------------------------------------------------------------
+#define GETOPTS_ARGS "p:n:s:w:f:t:l:o:d:rh"
+
+static struct option long_options[] =
+{
+    {"pattern",    required_argument, 0, 'p'},
+    {"requests",   required_argument, 0, 'n'},
+    {"stride",     required_argument, 0, 's'},
+    {"writes",     required_argument, 0, 'w'},
+    {"footprint",  required_argument, 0, 'f'},
+    {"trace",      required_argument, 0, 't'},
+    {"latency",    required_argument, 0, 'l'},
+    {"outstanding",required_argument, 0, 'o'},
+    {"depth",      required_argument, 0, 'd'},
+    {"delays",     no_argument,       0, 'r'},
+    {"help",       no_argument,       0, 'h'},
+    {0, 0, 0, 0}
+};
+
+//-----------------------------------------------------------------
+// parse_size: Size with optional K/M suffix
+//-----------------------------------------------------------------
+static uint32_t parse_size(const char *str)
+{
+    char *end = NULL;
+    uint64_t size = strtoull(str, &end, 0);
+
+    switch (*end)
+    {
+        case 'k': case 'K': size <<= 10; break;
+        case 'm': case 'M': size <<= 20; break;
+        default: break;
+    }
+
+    if (size > 0x40000000ULL)
+    {
+        fprintf (stderr,"Error: Size too large '%s'\n", str);
+        exit(-1);
+    }
+
+    return (uint32_t)size;
+}
+
+static void help_options(void)
+{
+    fprintf (stderr,"Usage:\n");
+    fprintf (stderr,"  --pattern     | -p NAME       stream, stride, random, chase or trace (default stream)\n");
+    fprintf (stderr,"  --requests    | -n NUM        Requests to issue (default 100000, trace: whole file)\n");
+    fprintf (stderr,"  --stride      | -s NUM        Stride in bytes for 'stride' (default %d)\n", LINE_SIZE);
+    fprintf (stderr,"  --writes      | -w PCT        Percentage of stores (default 0)\n");
+    fprintf (stderr,"  --footprint   | -f NUM[K|M]   Address range at 0x%08x touched (default 64K)\n", MEM_BASE);
+    fprintf (stderr,"  --trace       | -t FILE       Access trace to replay ('lsu' port records)\n");
+    fprintf (stderr,"  --latency     | -l NUM        AXI response latency (cycles)\n");
+    fprintf (stderr,"  --outstanding | -o RD[:WR]    Outstanding AXI bursts in the memory model\n");
+    fprintf (stderr,"  --depth       | -d NUM        LSU requests in flight (default 2)\n");
+    fprintf (stderr,"  --delays      | -r            Random AXI handshake delays in the memory model\n");
+    exit(-1);
+}
+
+//-----------------------------------------------------------------
+// Module
+//-----------------------------------------------------------------
+class testbench: public testbench_vbase
+{
+public:
+    //-----------------------------------------------------------------
+    // Instances / Members
+    //-----------------------------------------------------------------
+    dcache_rtl                  *m_dut;
+    tb_axi4_mem                 *m_mem;
+
+    int                          m_argc;
+    char**                       m_argv;
+
+    // Request generation
+    ePATTERN                     m_pattern;
+    uint64_t                     m_requests;
+    uint32_t                     m_stride;
+    int                          m_write_pct;
+    uint32_t                     m_footprint;
+    uint32_t                     m_offset;
+    uint32_t                     m_chase_addr;
+    tb_axi4_trace_reader         m_trace;
+    int                          m_trace_port;
+
+    // Statistics
+    uint64_t                     m_cycles;
+    uint64_t                     m_issued;
+    uint64_t                     m_acked;
+    uint64_t                     m_reads;
+    uint64_t                     m_writes;
+    uint64_t                     m_first_cycle;
+    uint64_t                     m_last_cycle;
+    uint64_t                     m_issue_cycle[TAG_NUM];
+    std::vector <uint64_t>       m_latency;
+    uint64_t                     m_lat_total;
+    uint64_t                     m_lat_max;
+    uint64_t                     m_refills;
+    uint64_t                     m_refill_beats;
+    uint64_t                     m_evicts;
+    uint64_t                     m_evict_beats;
+
+    sc_signal <axi4_slave>      mem_in;
+    sc_signal <axi4_master>     mem_out;
+
+    sc_signal < sc_uint<32> >   mem_addr_in;
+    sc_signal < sc_uint<32> >   mem_data_wr_in;
+    sc_signal < bool >          mem_rd_in;
+    sc_signal < sc_uint<4> >    mem_wr_in;
+    sc_signal < bool >          mem_cacheable_in;
+    sc_signal < sc_uint<11> >   mem_req_tag_in;
+    sc_signal < bool >          mem_invalidate_in;
+    sc_signal < bool >          mem_writeback_in;
+    sc_signal < bool >          mem_flush_in;
+
+    sc_signal < sc_uint<32> >   mem_data_rd_out;
+    sc_signal < bool >          mem_accept_out;
+    sc_signal < bool >          mem_ack_out;
+    sc_signal < bool >          mem_error_out;
+    sc_signal < sc_uint<11> >   mem_resp_tag_out;
+
+    //-----------------------------------------------------------------
+    // Request
+    //-----------------------------------------------------------------
+    struct request
+    {
+        uint32_t addr;
+        uint32_t data;
+        uint8_t  wr;    // Byte strobes (0 = read)
+    };
+
+    //-----------------------------------------------------------------
+    // process: Drive the LSU port
+    //-----------------------------------------------------------------
+    void process(void)
+    {
+        const char *   trace_file     = NULL;
+        int            rd_outstanding = TB_AXI4_MEM_RD_OUTSTANDING;
+        int            wr_outstanding = TB_AXI4_MEM_WR_OUTSTANDING;
+        int            latency        = 0;
+        int            depth          = 2;
+        bool           delays         = false;
+        bool           requests_set   = false;
+        int            help           = 0;
+        int c;
+
+        int option_index = 0;
+        while ((c = getopt_long (m_argc, m_argv, GETOPTS_ARGS, long_options, &option_index)) != -1)
+        {
+            switch(c)
+            {
+                case 'p':
+                    if (!strcmp(optarg, "stream"))
+                        m_pattern = PATTERN_STREAM;
+                    else if (!strcmp(optarg, "stride"))
+                        m_pattern = PATTERN_STRIDE;
+                    else if (!strcmp(optarg, "random"))
+                        m_pattern = PATTERN_RANDOM;
+                    else if (!strcmp(optarg, "chase"))
+                        m_pattern = PATTERN_CHASE;
+                    else if (!strcmp(optarg, "trace"))
+                        m_pattern = PATTERN_TRACE;
+                    else
+                        help = 1;
+                    break;
+                case 'n':
+                    m_requests   = strtoull(optarg, NULL, 0);
+                    requests_set = true;
+                    break;
+                case 's':
+                    m_stride = (uint32_t)strtoul(optarg, NULL, 0);
+                    break;
+                case 'w':
+                    m_write_pct = (int)strtoul(optarg, NULL, 0);
+                    break;
+                case 'f':
+                    m_footprint = parse_size(optarg);
+                    break;
+                case 't':
+                    trace_file = optarg;
+                    m_pattern  = PATTERN_TRACE;
+                    break;
+                case 'l':
+                    latency = (int)strtoul(optarg, NULL, 0);
+                    break;
+                case 'o':
+                {
+                    char *wr = NULL;
+                    rd_outstanding = (int)strtoul(optarg, &wr, 0);
+                    wr_outstanding = (*wr == ':') ? (int)strtoul(wr + 1, NULL, 0) : rd_outstanding;
+                    break;
+                }
+                case 'd':
+                    depth = (int)strtoul(optarg, NULL, 0);
+                    break;
+                case 'r':
+                    delays = true;
+                    break;
+                case '?':
+                default:
+                    help = 1;
+                    break;
+            }
+        }
+
+        m_footprint = (m_footprint + LINE_SIZE - 1) & ~(LINE_SIZE - 1);
+        m_stride    = (m_stride + 3) & ~3;
+
+        if (help || m_footprint < LINE_SIZE || !m_stride || depth < 1 || depth >= TAG_NUM ||
+            (m_pattern == PATTERN_TRACE && !trace_file))
+        {
+            help_options();
+            sc_stop();
+            return;
+        }
+
+        if (m_pattern == PATTERN_TRACE)
+        {
+            if (!m_trace.open(trace_file))
+            {
+                sc_stop();
+                return;
+            }
+
+            m_trace_port = -1;
+            for (int i=0;i<m_trace.get_num_ports();i++)
+                if (m_trace.get_port_name(i) == "lsu")
+                    m_trace_port = i;
+
+            // AXI traces (--axi-trace) name ports icache / dcache
+            if (m_trace_port < 0)
+            {
+                fprintf(stderr, "ERROR: %s has no 'lsu' port (record with test.x --access-trace)\n", trace_file);
+                sc_stop();
+                return;
+            }
+
+            if (!requests_set)
+                m_requests = (uint64_t)-1;
+        }
+
+        // Memory model behaviour
+        m_mem->add_region(MEM_BASE, m_footprint);
+        m_mem->enable_delays(delays);
+        m_mem->set_outstanding(rd_outstanding, wr_outstanding);
+        m_mem->set_latency(latency);
+
+        if (m_pattern == PATTERN_CHASE)
+            chase_init();
+
+        mem_rd_in.write(false);
+        mem_wr_in.write(0);
+        mem_cacheable_in.write(true);
+        mem_invalidate_in.write(false);
+        mem_writeback_in.write(false);
+        mem_flush_in.write(false);
+
+        // Issue loop: hold each request until accepted (the cache
+        // deasserts accept during its reset flush and on misses).
+        request  req     = { 0, 0, 0 };
+        bool     pending = false;
+        uint32_t tag     = 0;
+        uint64_t stall   = 0;
+
+        while (true)
+        {
+            uint64_t inflight = m_issued - m_acked;
+
+            if (!pending && m_issued < m_requests && inflight < (uint64_t)depth)
+            {
+                // Pointer chase: next address comes from the previous load
+                if (m_pattern != PATTERN_CHASE || inflight == 0)
+                {
+                    pending = next_request(req);
+
+                    // End of trace
+                    if (!pending)
+                        m_requests = m_issued;
+                }
+            }
+
+            mem_addr_in.write(pending ? req.addr : 0);
+            mem_data_wr_in.write(req.data);
+            mem_rd_in.write(pending && !req.wr);
+            mem_wr_in.write(pending ? req.wr : 0);
+            mem_req_tag_in.write(tag);
+
+            wait();
+            m_cycles++;
+
+            // Handshakes completed on this edge
+            if (pending && mem_accept_out.read())
+            {
+                if (!m_issued)
+                    m_first_cycle = m_cycles;
+
+                m_issue_cycle[tag] = m_cycles;
+                m_issued++;
+                req.wr ? m_writes++ : m_reads++;
+                tag = (tag + 1) & (TAG_NUM - 1);
+                pending = false;
+            }
+
+            if (mem_ack_out.read())
+            {
+                response(mem_resp_tag_out.read(), mem_data_rd_out.read());
+                stall = 0;
+            }
+            else if (m_issued != m_acked && ++stall > STALL_TIMEOUT)
+            {
+                printf("ERROR: No response for %d cycles (%lu outstanding)\n",
+                       STALL_TIMEOUT, (unsigned long)(m_issued - m_acked));
+                break;
+            }
+
+            axi_monitor();
+
+            if (!pending && m_issued >= m_requests && m_acked == m_issued)
+                break;
+        }
+
+        sc_stop();
+    }
+
+    //-----------------------------------------------------------------
+    // next_request: Generate / read the next LSU access
+    //-----------------------------------------------------------------
+    bool next_request(request &req)
+    {
+        uint32_t words = m_footprint / 4;
+
+        req.wr   = 0;
+        req.data = (uint32_t)rand();
+
+        switch (m_pattern)
+        {
+            case PATTERN_STREAM:
+                req.addr = MEM_BASE + m_offset;
+                m_offset = (m_offset + 4) % m_footprint;
+                break;
+            case PATTERN_STRIDE:
+                req.addr = MEM_BASE + m_offset;
+                m_offset = (m_offset + m_stride) % m_footprint;
+                break;
+            case PATTERN_RANDOM:
+                req.addr = MEM_BASE + (((uint32_t)rand() % words) * 4);
+                break;
+            case PATTERN_CHASE:
+                // Loads only - stores would break the chain
+                req.addr = m_chase_addr;
+                return true;
+            case PATTERN_TRACE:
+            {
+                tb_axi4_trace_rec rec;
+                do
+                {
+                    if (!m_trace.next(rec))
+                        return false;
+                }
+                while (rec.port != m_trace_port);
+
+                // Fold into the modelled RAM, word aligned as the LSU issues them
+                req.addr = MEM_BASE + (((rec.addr - MEM_BASE) % m_footprint) & ~3);
+                req.wr   = rec.is_write() ? (rec.strb & 0xF) : 0;
+                return true;
+            }
+        }
+
+        if ((int)((uint32_t)rand() % 100) < m_write_pct)
+            req.wr = 0xF;
+
+        return true;
+    }
+
+    //-----------------------------------------------------------------
+    // chase_init: Link every line into one randomly ordered cycle
+    //-----------------------------------------------------------------
+    void chase_init(void)
+    {
+        uint32_t lines = m_footprint / LINE_SIZE;
+        std::vector <uint32_t> order(lines);
+
+        for (uint32_t i=0;i<lines;i++)
+            order[i] = i;
+
+        for (uint32_t i=lines-1;i>0;i--)
+            std::swap(order[i], order[(uint32_t)rand() % (i + 1)]);
+
+        for (uint32_t i=0;i<lines;i++)
+        {
+            uint32_t from = MEM_BASE + order[i] * LINE_SIZE;
+            uint32_t to   = MEM_BASE + order[(i + 1) % lines] * LINE_SIZE;
+            m_mem->write32(from, to);
+        }
+
+        m_chase_addr = MEM_BASE + order[0] * LINE_SIZE;
+    }
+
+    //-----------------------------------------------------------------
+    // response: Request completed
+    //-----------------------------------------------------------------
+    void response(uint32_t tag, uint32_t data)
+    {
+        uint64_t lat = m_cycles - m_issue_cycle[tag];
+
+        m_latency[std::min(lat, (uint64_t)(LAT_BUCKETS - 1))]++;
+        m_lat_total += lat;
+        m_lat_max    = std::max(m_lat_max, lat);
+        m_last_cycle = m_cycles;
+        m_acked++;
+
+        if (m_pattern == PATTERN_CHASE)
+            m_chase_addr = data;
+    }
+
+    //-----------------------------------------------------------------
+    // axi_monitor: Refill / write-back traffic on the memory port
+    //-----------------------------------------------------------------
+    void axi_monitor(void)
+    {
+        axi4_master axi_o = mem_out.read();
+        axi4_slave  axi_i = mem_in.read();
+
+        if (axi_o.ARVALID && axi_i.ARREADY)
+            m_refills++;
+        if (axi_i.RVALID && axi_o.RREADY)
+            m_refill_beats++;
+        if (axi_o.AWVALID && axi_i.AWREADY)
+            m_evicts++;
+        if (axi_o.WVALID && axi_i.WREADY)
+            m_evict_beats++;
+    }
+
+    //-----------------------------------------------------------------
+    // percentile: Latency at or below which PCT% of requests completed
+    //-----------------------------------------------------------------
+    uint64_t percentile(int pct)
+    {
+        uint64_t target = (m_acked * pct + 99) / 100;
+        uint64_t count  = 0;
+
+        for (int i=0;i<LAT_BUCKETS;i++)
+        {
+            count += m_latency[i];
+            if (count >= target && count)
+                return i;
+        }
+        return m_lat_max;
+    }
+
+    //-----------------------------------------------------------------
+    // report: Print end of simulation statistics
+    //-----------------------------------------------------------------
+    void report(void)
+    {
+        if (!m_acked)
+            return;
+
+        uint64_t cycles = m_last_cycle - m_first_cycle + 1;
+
+        // Hits complete at the minimum latency, anything slower waited on memory
+        uint64_t hit_lat = 0;
+        while (hit_lat < LAT_BUCKETS - 1 && !m_latency[hit_lat])
+            hit_lat++;
+
+        uint64_t misses = m_acked - m_latency[hit_lat];
+        uint64_t miss_lat_total = m_lat_total - m_latency[hit_lat] * hit_lat;
+
+        printf("Requests:   %lu (%lu reads, %lu writes) in %lu cycles\n",
+               (unsigned long)m_issued, (unsigned long)m_reads, (unsigned long)m_writes, (unsigned long)cycles);
+        printf("Throughput: %.3f requests/cycle\n", (double)m_acked / cycles);
+        printf("Latency:    mean %.2f, p50 %lu, p90 %lu, p99 %lu, max %lu cycles\n",
+               (double)m_lat_total / m_acked,
+               (unsigned long)percentile(50), (unsigned long)percentile(90),
+               (unsigned long)percentile(99), (unsigned long)m_lat_max);
+        printf("Slow path:  %lu requests (%.2f%%) above %lu cycles, mean %.2f cycles\n",
+               (unsigned long)misses, (100.0 * misses) / m_acked, (unsigned long)hit_lat,
+               misses ? (double)miss_lat_total / misses : 0.0);
+        printf("Refills:    %lu bursts, %.3f bytes/cycle\n",
+               (unsigned long)m_refills, (double)(m_refill_beats * 4) / cycles);
+        printf("Writeback:  %lu bursts, %.3f bytes/cycle\n",
+               (unsigned long)m_evicts, (double)(m_evict_beats * 4) / cycles);
+    }
+
+    void set_argcv(int argc, char* argv[])
+    {
+        m_argc = argc;
+        m_argv = argv;
+    }
+
+    //-----------------------------------------------------------------
+    // Construction
+    //-----------------------------------------------------------------
+    SC_HAS_PROCESS(testbench);
+    testbench(sc_module_name name): testbench_vbase(name)
+    {
+        m_dut = new dcache_rtl("DUT");
+        m_dut->clk_in(clk);
+        m_dut->rst_in(rst);
+        m_dut->mem_addr_in(mem_addr_in);
+        m_dut->mem_data_wr_in(mem_data_wr_in);
+        m_dut->mem_rd_in(mem_rd_in);
+        m_dut->mem_wr_in(mem_wr_in);
+        m_dut->mem_cacheable_in(mem_cacheable_in);
+        m_dut->mem_req_tag_in(mem_req_tag_in);
+        m_dut->mem_invalidate_in(mem_invalidate_in);
+        m_dut->mem_writeback_in(mem_writeback_in);
+        m_dut->mem_flush_in(mem_flush_in);
+        m_dut->mem_data_rd_out(mem_data_rd_out);
+        m_dut->mem_accept_out(mem_accept_out);
+        m_dut->mem_ack_out(mem_ack_out);
+        m_dut->mem_error_out(mem_error_out);
+        m_dut->mem_resp_tag_out(mem_resp_tag_out);
+        m_dut->axi_out(mem_out);
+        m_dut->axi_in(mem_in);
+
+        m_mem = new tb_axi4_mem("MEM");
+        m_mem->clk_in(clk);
+        m_mem->rst_in(rst);
+        m_mem->axi_in(mem_out);
+        m_mem->axi_out(mem_in);
+
+        m_argc         = 0;
+        m_argv         = NULL;
+        m_pattern      = PATTERN_STREAM;
+        m_requests     = 100000;
+        m_stride       = LINE_SIZE;
+        m_write_pct    = 0;
+        m_footprint    = 64 * 1024;
+        m_offset       = 0;
+        m_chase_addr   = MEM_BASE;
+        m_trace_port   = -1;
+
+        m_cycles       = 0;
+        m_issued       = 0;
+        m_acked        = 0;
+        m_reads        = 0;
+        m_writes       = 0;
+        m_first_cycle  = 0;
+        m_last_cycle   = 0;
+        m_lat_total    = 0;
+        m_lat_max      = 0;
+        m_refills      = 0;
+        m_refill_beats = 0;
+        m_evicts       = 0;
+        m_evict_beats  = 0;
+        m_latency.resize(LAT_BUCKETS, 0);
+        memset(m_issue_cycle, 0, sizeof(m_issue_cycle));
+
+        m_verilate_vcd = NULL;
+    }
+
+    //-----------------------------------------------------------------
+    // Trace
+    //-----------------------------------------------------------------
+    void add_trace(sc_trace_file * fp, std::string prefix)
+    {
+        if (!waves_enabled())
+            return;
+
+        // Add signals to trace file
+        #define TRACE_SIGNAL(a) sc_trace(fp,a,#a);
+        TRACE_SIGNAL(clk);
+        TRACE_SIGNAL(rst);
+
+        m_dut->add_trace(fp, "");
+    }
+};
@@ -0,0 +1,220 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <signal.h>
+#include <time.h>
+#include <vector>
+
+#include "verilated.h"
+#include "Vtb_dpi_top.h"
+
+#include "tb_dpi_mem.h"
+#include "tb_periph.h"
+#include "image_load.h"
+
+#define MEM_BASE            0x80000000
+#define RESET_CYCLES        5
+
+//-----------------------------------------------------------------
+// Command line options
+//-----------------------------------------------------------------
+#define GETOPTS_ARGS "f:L:c:l:m:b:h"
+
+static struct option long_options[] =
+{
+    {"elf",        required_argument, 0, 'f'},
+    {"load",       required_argument, 0, 'L'},
+    {"cycles",     required_argument, 0, 'c'},
+    {"latency",    required_argument, 0, 'l'},
+    {"ram-size",   required_argument, 0, 'm'},
+    {"boot-marker",required_argument, 0, 'b'},
+    {"help",       no_argument,       0, 'h'},
+    {0, 0, 0, 0}
+};
+
+//-----------------------------------------------------------------
+// parse_size: Size with optional K/M/G suffix
+//-----------------------------------------------------------------
+static uint32_t parse_size(const char *str)
+{
+    char *end = NULL;
+    uint64_t size = strtoull(str, &end, 0);
+
+    switch (*end)
+    {
+        case 'k': case 'K': size <<= 10; break;
+        case 'm': case 'M': size <<= 20; break;
+        case 'g': case 'G': size <<= 30; break;
+        default: break;
+    }
+
+    if (size > 0xFFFFFFFFULL)
+    {
+        fprintf (stderr,"Error: Size too large '%s'\n", str);
+        exit(-1);
+    }
+
+    return (uint32_t)size;
+}
+
+static void help_options(void)
+{
+    fprintf (stderr,"Usage:\n");
+    fprintf (stderr,"  --elf         | -f FILE       File to load\n");
+    fprintf (stderr,"  --load        | -L FILE[@ADDR] Image to load (ELF, binary, .hex, .srec), may be repeated\n");
+    fprintf (stderr,"  --cycles      | -c NUM        Max cycles to execute\n");
+    fprintf (stderr,"  --latency     | -l NUM        AXI response latency (cycles)\n");
+    fprintf (stderr,"  --ram-size    | -m NUM[K|M|G] RAM at 0x%08x (allocated on first write)\n", MEM_BASE);
+    fprintf (stderr,"  --boot-marker | -b STR        Stop and report cycles when UART prints STR\n");
+    exit(-1);
+}
+
+//-----------------------------------------------------------------
+// Locals
+//-----------------------------------------------------------------
+static volatile bool g_stop = false;
+
+static void sigint_handler(int s)
+{
+    g_stop = true;
+}
+
+static double time_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+//-----------------------------------------------------------------
+// main
+//-----------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+    std::vector <const char *> images;
+    int64_t        max_cycles  = (int64_t)-1;
+    uint32_t       latency     = 0;
+    uint32_t       ram_size    = 0;
+    const char *   boot_marker = NULL;
+    int            help        = 0;
+    int c;
+
+    Verilated::commandArgs(argc, argv);
+
+    int option_index = 0;
+    while ((c = getopt_long (argc, argv, GETOPTS_ARGS, long_options, &option_index)) != -1)
+    {
+        switch(c)
+        {
+            case 'f':
+            case 'L':
+                images.push_back(optarg);
+                break;
+            case 'c':
+                max_cycles = (int64_t)strtoull(optarg, NULL, 0);
+                break;
+            case 'l':
+                latency = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'm':
+                ram_size = parse_size(optarg);
+                break;
+            case 'b':
+                boot_marker = optarg;
+                break;
+            case '?':
+            default:
+                help = 1;
+                break;
+        }
+    }
+
+    if (help || images.empty())
+        help_options();
+
+    // Backing store + peripherals (uncached data accesses)
+    tb_dpi_mem   mem;
+    tb_clint     clint(CLINT_BASE);
+    tb_uart_lite uart(UART_LITE_BASE);
+    tb_plic      plic(PLIC_BASE);
+    plic.add_source(PLIC_SRC_UART, &uart);
+
+    mem.add_device(&clint);
+    mem.add_device(&uart);
+    mem.add_device(&plic);
+
+    // RAM independent of ELF sections (e.g. Linux)
+    if (ram_size)
+        mem.create_memory(MEM_BASE, ram_size);
+
+    for (size_t i=0;i<images.size();i++)
+    {
+        printf("Running: %s\n", images[i]);
+        image_load img(images[i], &mem, MEM_BASE);
+        if (!img.load())
+        {
+            fprintf (stderr,"Error: Could not open %s\n", images[i]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (boot_marker)
+        uart.set_marker(boot_marker);
+
+    signal(SIGINT, sigint_handler);
+
+    Vtb_dpi_top *top = new Vtb_dpi_top;
+    top->clk_i          = 0;
+    top->rst_i          = 1;
+    top->intr_i         = 0;
+    top->reset_vector_i = MEM_BASE;
+    top->latency_i      = latency;
+
+    for (int i=0;i<RESET_CYCLES;i++)
+    {
+        top->clk_i = 1;
+        top->eval();
+        top->clk_i = 0;
+        top->eval();
+    }
+    top->rst_i = 0;
+
+    uint64_t cycles = 0;
+    double   start  = time_now();
+
+    while (!Verilated::gotFinish() && !g_stop)
+    {
+        if (max_cycles != -1 && (int64_t)cycles >= max_cycles)
+            break;
+
+        // Peripherals
+        clint.clock();
+        uart.clock();
+        plic.clock();
+        top->intr_i = plic.irq() || clint.irq();
+
+        top->clk_i = 1;
+        top->eval();
+        top->clk_i = 0;
+        top->eval();
+        cycles++;
+
+        if (uart.marker_seen())
+        {
+            printf("\nBOOT: '%s' reached after %lu cycles\n", boot_marker, (unsigned long)cycles);
+            break;
+        }
+    }
+
+    double elapsed = time_now() - start;
+
+    top->final();
+    delete top;
+
+    printf("\nCycles: %lu in %.2fs (%.1f kHz), %lu bus reads, %lu bus writes\n",
+           (unsigned long)cycles, elapsed, elapsed > 0 ? cycles / elapsed / 1000.0 : 0.0,
+           (unsigned long)mem.get_reads(), (unsigned long)mem.get_writes());
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,254 @@
+//-----------------------------------------------------------------
+// tb_dpi_axi_mem: AXI4 slave memory for the Verilator-only flow.
+// Burst sequencing and response timing are modelled here; data
+// lives in the C++ backing store and is accessed through DPI-C,
+// once per R / W beat handshake.
+//-----------------------------------------------------------------
+module tb_dpi_axi_mem
+//-----------------------------------------------------------------
+// Params
+//-----------------------------------------------------------------
+#(
+     parameter RD_OUTSTANDING   = 4
+    ,parameter RD_OUTSTANDING_W = 2
+)
+//-----------------------------------------------------------------
+// Ports
+//-----------------------------------------------------------------
+(
+    // Inputs
+     input           clk_i
+    ,input           rst_i
+    ,input  [ 31:0]  latency_i
+    ,input           axi_awvalid_i
+    ,input  [ 31:0]  axi_awaddr_i
+    ,input  [  3:0]  axi_awid_i
+    ,input  [  7:0]  axi_awlen_i
+    ,input  [  1:0]  axi_awburst_i
+    ,input           axi_wvalid_i
+    ,input  [ 31:0]  axi_wdata_i
+    ,input  [  3:0]  axi_wstrb_i
+    ,input           axi_wlast_i
+    ,input           axi_bready_i
+    ,input           axi_arvalid_i
+    ,input  [ 31:0]  axi_araddr_i
+    ,input  [  3:0]  axi_arid_i
+    ,input  [  7:0]  axi_arlen_i
+    ,input  [  1:0]  axi_arburst_i
+    ,input           axi_rready_i
+
+    // Outputs
+    ,output          axi_awready_o
+    ,output          axi_wready_o
+    ,output          axi_bvalid_o
+    ,output [  1:0]  axi_bresp_o
+    ,output [  3:0]  axi_bid_o
+    ,output          axi_arready_o
+    ,output          axi_rvalid_o
+    ,output [ 31:0]  axi_rdata_o
+    ,output [  1:0]  axi_rresp_o
+    ,output [  3:0]  axi_rid_o
+    ,output          axi_rlast_o
+);
+
+//-----------------------------------------------------------------
+// Backing store (tb_dpi_mem.cpp)
+//-----------------------------------------------------------------
+import "DPI-C" function int  dpi_mem_read(input int addr);
+import "DPI-C" function void dpi_mem_write(input int addr, input int data, input int strb);
+
+//-----------------------------------------------------------------
+// Cycle counter (response timing)
+//-----------------------------------------------------------------
+reg [31:0] cycle_q;
+
+always @ (posedge clk_i or posedge rst_i)
+if (rst_i)
+    cycle_q <= 32'b0;
+else
+    cycle_q <= cycle_q + 32'd1;
+
+//-----------------------------------------------------------------
+// next_addr: Address of the following beat (32-bit data bus)
+//-----------------------------------------------------------------
+function [31:0] next_addr;
+    input [31:0] addr;
+    input [1:0]  burst;
+    input [7:0]  len;
+    reg   [31:0] mask;
+begin
+    mask = {22'b0, len, 2'b11};
+
+    case (burst)
+    2'd0:    next_addr = addr;                                         // FIXED
+    2'd2:    next_addr = (addr & ~mask) | ((addr + 32'd4) & mask);     // WRAP
+    default: next_addr = addr + 32'd4;                                 // INCR
+    endcase
+end
+endfunction
+
+//-----------------------------------------------------------------
+// Read request queue
+//-----------------------------------------------------------------
+reg [31:0]                 ar_addr_q[RD_OUTSTANDING-1:0];
+reg [3:0]                  ar_id_q[RD_OUTSTANDING-1:0];
+reg [7:0]                  ar_len_q[RD_OUTSTANDING-1:0];
+reg [1:0]                  ar_burst_q[RD_OUTSTANDING-1:0];
+reg [31:0]                 ar_ready_q[RD_OUTSTANDING-1:0];
+
+reg [RD_OUTSTANDING_W-1:0] ar_wr_ptr_q;
+reg [RD_OUTSTANDING_W-1:0] ar_rd_ptr_q;
+reg [RD_OUTSTANDING_W:0]   ar_count_q;
+
+wire ar_push_w = axi_arvalid_i && axi_arready_o;
+wire ar_pop_w;
+
+always @ (posedge clk_i)
+if (ar_push_w)
+begin
+    ar_addr_q[ar_wr_ptr_q]  <= axi_araddr_i;
+    ar_id_q[ar_wr_ptr_q]    <= axi_arid_i;
+    ar_len_q[ar_wr_ptr_q]   <= axi_arlen_i;
+    ar_burst_q[ar_wr_ptr_q] <= axi_arburst_i;
+    ar_ready_q[ar_wr_ptr_q] <= cycle_q + latency_i;
+end
+
+always @ (posedge clk_i or posedge rst_i)
+if (rst_i)
+begin
+    ar_wr_ptr_q <= {(RD_OUTSTANDING_W){1'b0}};
+    ar_rd_ptr_q <= {(RD_OUTSTANDING_W){1'b0}};
+    ar_count_q  <= {(RD_OUTSTANDING_W+1){1'b0}};
+end
+else
+begin
+    if (ar_push_w)
+        ar_wr_ptr_q <= ar_wr_ptr_q + 1'b1;
+    if (ar_pop_w)
+        ar_rd_ptr_q <= ar_rd_ptr_q + 1'b1;
+
+    if (ar_push_w && !ar_pop_w)
+        ar_count_q <= ar_count_q + 1'b1;
+    else if (!ar_push_w && ar_pop_w)
+        ar_count_q <= ar_count_q - 1'b1;
+end
+
+// RD_OUTSTANDING is a power of 2 - top count bit set when full
+assign axi_arready_o = !ar_count_q[RD_OUTSTANDING_W];
+
+//-----------------------------------------------------------------
+// Read data: head burst streams out once its latency has elapsed
+//-----------------------------------------------------------------
+reg        rvalid_q;
+reg [31:0] rdata_q;
+reg [3:0]  rid_q;
+reg        rlast_q;
+reg        rd_busy_q;
+reg [31:0] rd_addr_q;
+reg [7:0]  rd_beat_q;
+
+wire [31:0] rd_wait_w   = cycle_q - ar_ready_q[ar_rd_ptr_q];
+wire        rd_avail_w  = (ar_count_q != {(RD_OUTSTANDING_W+1){1'b0}}) && !rd_wait_w[31];
+wire        rd_load_w   = rd_avail_w && (!rvalid_q || axi_rready_i);
+wire [31:0] rd_addr_w   = rd_busy_q ? rd_addr_q : ar_addr_q[ar_rd_ptr_q];
+wire        rd_last_w   = (rd_beat_q == ar_len_q[ar_rd_ptr_q]);
+
+assign ar_pop_w = rd_load_w && rd_last_w;
+
+always @ (posedge clk_i or posedge rst_i)
+if (rst_i)
+begin
+    rvalid_q  <= 1'b0;
+    rdata_q   <= 32'b0;
+    rid_q     <= 4'b0;
+    rlast_q   <= 1'b0;
+    rd_busy_q <= 1'b0;
+    rd_addr_q <= 32'b0;
+    rd_beat_q <= 8'b0;
+end
+else if (rd_load_w)
+begin
+    rvalid_q  <= 1'b1;
+    rdata_q   <= dpi_mem_read(rd_addr_w);
+    rid_q     <= ar_id_q[ar_rd_ptr_q];
+    rlast_q   <= rd_last_w;
+    rd_busy_q <= !rd_last_w;
+    rd_addr_q <= next_addr(rd_addr_w, ar_burst_q[ar_rd_ptr_q], ar_len_q[ar_rd_ptr_q]);
+    rd_beat_q <= rd_last_w ? 8'b0 : (rd_beat_q + 8'd1);
+end
+else if (axi_rready_i)
+    rvalid_q  <= 1'b0;
+
+assign axi_rvalid_o = rvalid_q;
+assign axi_rdata_o  = rdata_q;
+assign axi_rresp_o  = 2'b0;
+assign axi_rid_o    = rid_q;
+assign axi_rlast_o  = rlast_q;
+
+//-----------------------------------------------------------------
+// Write: one burst at a time (AW then W beats then B)
+//-----------------------------------------------------------------
+reg        aw_busy_q;
+reg [31:0] aw_addr_q;
+reg [3:0]  aw_id_q;
+reg [7:0]  aw_len_q;
+reg [1:0]  aw_burst_q;
+reg        b_pending_q;
+reg [31:0] b_ready_q;
+reg        bvalid_q;
+
+wire [31:0] b_wait_w = cycle_q - b_ready_q;
+
+assign axi_awready_o = !aw_busy_q && !b_pending_q && !bvalid_q;
+assign axi_wready_o  = aw_busy_q;
+
+always @ (posedge clk_i or posedge rst_i)
+if (rst_i)
+begin
+    aw_busy_q   <= 1'b0;
+    aw_addr_q   <= 32'b0;
+    aw_id_q     <= 4'b0;
+    aw_len_q    <= 8'b0;
+    aw_burst_q  <= 2'b0;
+    b_pending_q <= 1'b0;
+    b_ready_q   <= 32'b0;
+    bvalid_q    <= 1'b0;
+end
+else
+begin
+    if (axi_awvalid_i && axi_awready_o)
+    begin
+        aw_busy_q  <= 1'b1;
+        aw_addr_q  <= axi_awaddr_i;
+        aw_id_q    <= axi_awid_i;
+        aw_len_q   <= axi_awlen_i;
+        aw_burst_q <= axi_awburst_i;
+    end
+
+    if (axi_wvalid_i && axi_wready_o)
+    begin
+        dpi_mem_write(aw_addr_q, axi_wdata_i, {28'b0, axi_wstrb_i});
+        aw_addr_q <= next_addr(aw_addr_q, aw_burst_q, aw_len_q);
+
+        if (axi_wlast_i)
+        begin
+            aw_busy_q   <= 1'b0;
+            b_pending_q <= 1'b1;
+            b_ready_q   <= cycle_q + latency_i;
+        end
+    end
+
+    if (b_pending_q && !b_wait_w[31])
+    begin
+        b_pending_q <= 1'b0;
+        bvalid_q    <= 1'b1;
+    end
+    else if (bvalid_q && axi_bready_i)
+        bvalid_q    <= 1'b0;
+end
+
+assign axi_bvalid_o = bvalid_q;
+assign axi_bresp_o  = 2'b0;
+assign axi_bid_o    = aw_id_q;
+
+endmodule
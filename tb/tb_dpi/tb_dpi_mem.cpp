@@ -0,0 +1,107 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "tb_dpi_mem.h"
+#include "Vtb_dpi_top__Dpi.h"
+
+//-----------------------------------------------------------------
+// Locals
+//-----------------------------------------------------------------
+static tb_dpi_mem *g_mem = NULL;
+
+//-----------------------------------------------------------------
+// Constructor
+//-----------------------------------------------------------------
+tb_dpi_mem::tb_dpi_mem()
+{
+    m_reads  = 0;
+    m_writes = 0;
+    g_mem    = this;
+}
+tb_dpi_mem::~tb_dpi_mem()
+{
+    clear();
+
+    if (g_mem == this)
+        g_mem = NULL;
+}
+//-----------------------------------------------------------------
+// create_memory: Add RAM region (skips parts already mapped)
+//-----------------------------------------------------------------
+bool tb_dpi_mem::create_memory(uint32_t base, uint32_t size, uint8_t *mem)
+{
+    base = base & ~(32-1);
+    size = (size + 31) & ~(32-1);
+
+    while (size && valid_addr(base))
+    {
+        base += 1;
+        size -= 1;
+    }
+
+    while (size && valid_addr(base + size - 1))
+        size -= 1;
+
+    if (!size)
+        return true;
+
+    return mem ? add_region(mem, base, size) : add_region(base, size);
+}
+//-----------------------------------------------------------------
+// write_block: Bulk copy (falls back to bytes across regions)
+//-----------------------------------------------------------------
+bool tb_dpi_mem::write_block(uint32_t addr, const uint8_t *data, uint32_t size)
+{
+    if (tb_memory::write_block(addr, data, size))
+        return true;
+
+    return mem_api::write_block(addr, data, size);
+}
+//-----------------------------------------------------------------
+// read32: Bus read (one per R beat)
+//-----------------------------------------------------------------
+uint32_t tb_dpi_mem::read32(uint32_t addr)
+{
+    addr &= ~3;
+    m_reads++;
+
+    tb_device *dev = find_device(addr);
+    if (dev)
+        return dev->read32(addr - dev->get_base());
+
+    uint32_t data = 0;
+    for (int i=0;i<4;i++)
+        data |= ((uint32_t)tb_memory::read(addr + i)) << (i*8);
+    return data;
+}
+//-----------------------------------------------------------------
+// write32: Bus write (one per W beat)
+//-----------------------------------------------------------------
+void tb_dpi_mem::write32(uint32_t addr, uint32_t data, uint8_t strb)
+{
+    addr &= ~3;
+    m_writes++;
+
+    tb_device *dev = find_device(addr);
+    if (dev)
+    {
+        dev->write32(addr - dev->get_base(), data, strb);
+        return;
+    }
+
+    for (int i=0;i<4;i++)
+        if (strb & (1 << i))
+            tb_memory::write(addr + i, data >> (i*8));
+}
+
+//-----------------------------------------------------------------
+// DPI-C imports (tb_dpi_axi_mem.v)
+//-----------------------------------------------------------------
+int dpi_mem_read(int addr)
+{
+    return (int)g_mem->read32((uint32_t)addr);
+}
+void dpi_mem_write(int addr, int data, int strb)
+{
+    g_mem->write32((uint32_t)addr, (uint32_t)data, (uint8_t)strb);
+}
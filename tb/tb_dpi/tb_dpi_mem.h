@@ -0,0 +1,40 @@
+#ifndef TB_DPI_MEM_H
+#define TB_DPI_MEM_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "tb_memory.h"
+#include "mem_api.h"
+
+//-----------------------------------------------------------------
+// tb_dpi_mem: Backing store behind the DPI-C memory ports.
+// RAM regions and peripheral decode are the tb_top memory model
+// (tb_memory), so both benches see the same memory.
+//-----------------------------------------------------------------
+class tb_dpi_mem: public tb_memory, public mem_api
+{
+public:
+    tb_dpi_mem();
+    ~tb_dpi_mem();
+
+    // mem_api (image loading)
+    bool     create_memory(uint32_t base, uint32_t size, uint8_t *mem = NULL);
+    bool     valid_addr(uint32_t addr) { return tb_memory::valid_addr(addr); }
+    void     write(uint32_t addr, uint8_t data) { tb_memory::write(addr, data); }
+    uint8_t  read(uint32_t addr) { return tb_memory::read(addr); }
+    bool     write_block(uint32_t addr, const uint8_t *data, uint32_t size);
+
+    // Bus side (called from tb_dpi_axi_mem)
+    uint32_t read32(uint32_t addr);
+    void     write32(uint32_t addr, uint32_t data, uint8_t strb);
+
+    uint64_t get_reads(void)  { return m_reads; }
+    uint64_t get_writes(void) { return m_writes; }
+
+protected:
+    uint64_t m_reads;
+    uint64_t m_writes;
+};
+
+#endif
@@ -0,0 +1,250 @@
+//-----------------------------------------------------------------
+// tb_dpi_top: riscv_top with the instruction / data AXI ports
+// connected to DPI-C backed memories, so Verilator evaluates the
+// whole system as a single model (no SystemC channels).
+//-----------------------------------------------------------------
+module tb_dpi_top
+//-----------------------------------------------------------------
+// Params (passed through to riscv_top, e.g. -GSUPPORT_SUPER=1)
+//-----------------------------------------------------------------
+#(
+     parameter SUPPORT_BRANCH_PREDICTION = 1
+    ,parameter SUPPORT_MULDIV       = 1
+    ,parameter SUPPORT_SUPER        = 0
+    ,parameter SUPPORT_MMU          = 0
+    ,parameter SUPPORT_DUAL_ISSUE   = 1
+    ,parameter SUPPORT_LOAD_BYPASS  = 1
+    ,parameter SUPPORT_MUL_BYPASS   = 1
+    ,parameter EXTRA_DECODE_STAGE   = 0
+    ,parameter MEM_CACHE_ADDR_MIN   = 32'h80000000
+    ,parameter MEM_CACHE_ADDR_MAX   = 32'h8fffffff
+)
+//-----------------------------------------------------------------
+// Ports
+//-----------------------------------------------------------------
+(
+    // Inputs
+     input           clk_i
+    ,input           rst_i
+    ,input           intr_i
+    ,input  [ 31:0]  reset_vector_i
+    ,input  [ 31:0]  latency_i
+);
+
+wire          axi_i_awvalid_w;
+wire [ 31:0]  axi_i_awaddr_w;
+wire [  3:0]  axi_i_awid_w;
+wire [  7:0]  axi_i_awlen_w;
+wire [  1:0]  axi_i_awburst_w;
+wire          axi_i_wvalid_w;
+wire [ 31:0]  axi_i_wdata_w;
+wire [  3:0]  axi_i_wstrb_w;
+wire          axi_i_wlast_w;
+wire          axi_i_bready_w;
+wire          axi_i_arvalid_w;
+wire [ 31:0]  axi_i_araddr_w;
+wire [  3:0]  axi_i_arid_w;
+wire [  7:0]  axi_i_arlen_w;
+wire [  1:0]  axi_i_arburst_w;
+wire          axi_i_rready_w;
+wire          axi_i_awready_w;
+wire          axi_i_wready_w;
+wire          axi_i_bvalid_w;
+wire [  1:0]  axi_i_bresp_w;
+wire [  3:0]  axi_i_bid_w;
+wire          axi_i_arready_w;
+wire          axi_i_rvalid_w;
+wire [ 31:0]  axi_i_rdata_w;
+wire [  1:0]  axi_i_rresp_w;
+wire [  3:0]  axi_i_rid_w;
+wire          axi_i_rlast_w;
+
+wire          axi_d_awvalid_w;
+wire [ 31:0]  axi_d_awaddr_w;
+wire [  3:0]  axi_d_awid_w;
+wire [  7:0]  axi_d_awlen_w;
+wire [  1:0]  axi_d_awburst_w;
+wire          axi_d_wvalid_w;
+wire [ 31:0]  axi_d_wdata_w;
+wire [  3:0]  axi_d_wstrb_w;
+wire          axi_d_wlast_w;
+wire          axi_d_bready_w;
+wire          axi_d_arvalid_w;
+wire [ 31:0]  axi_d_araddr_w;
+wire [  3:0]  axi_d_arid_w;
+wire [  7:0]  axi_d_arlen_w;
+wire [  1:0]  axi_d_arburst_w;
+wire          axi_d_rready_w;
+wire          axi_d_awready_w;
+wire          axi_d_wready_w;
+wire          axi_d_bvalid_w;
+wire [  1:0]  axi_d_bresp_w;
+wire [  3:0]  axi_d_bid_w;
+wire          axi_d_arready_w;
+wire          axi_d_rvalid_w;
+wire [ 31:0]  axi_d_rdata_w;
+wire [  1:0]  axi_d_rresp_w;
+wire [  3:0]  axi_d_rid_w;
+wire          axi_d_rlast_w;
+
+riscv_top
+#(
+     .SUPPORT_BRANCH_PREDICTION(SUPPORT_BRANCH_PREDICTION)
+    ,.SUPPORT_MULDIV(SUPPORT_MULDIV)
+    ,.SUPPORT_SUPER(SUPPORT_SUPER)
+    ,.SUPPORT_MMU(SUPPORT_MMU)
+    ,.SUPPORT_DUAL_ISSUE(SUPPORT_DUAL_ISSUE)
+    ,.SUPPORT_LOAD_BYPASS(SUPPORT_LOAD_BYPASS)
+    ,.SUPPORT_MUL_BYPASS(SUPPORT_MUL_BYPASS)
+    ,.EXTRA_DECODE_STAGE(EXTRA_DECODE_STAGE)
+    ,.MEM_CACHE_ADDR_MIN(MEM_CACHE_ADDR_MIN)
+    ,.MEM_CACHE_ADDR_MAX(MEM_CACHE_ADDR_MAX)
+)
+u_core
+(
+    // Inputs
+     .clk_i(clk_i)
+    ,.rst_i(rst_i)
+    ,.axi_i_awready_i(axi_i_awready_w)
+    ,.axi_i_wready_i(axi_i_wready_w)
+    ,.axi_i_bvalid_i(axi_i_bvalid_w)
+    ,.axi_i_bresp_i(axi_i_bresp_w)
+    ,.axi_i_bid_i(axi_i_bid_w)
+    ,.axi_i_arready_i(axi_i_arready_w)
+    ,.axi_i_rvalid_i(axi_i_rvalid_w)
+    ,.axi_i_rdata_i(axi_i_rdata_w)
+    ,.axi_i_rresp_i(axi_i_rresp_w)
+    ,.axi_i_rid_i(axi_i_rid_w)
+    ,.axi_i_rlast_i(axi_i_rlast_w)
+    ,.axi_d_awready_i(axi_d_awready_w)
+    ,.axi_d_wready_i(axi_d_wready_w)
+    ,.axi_d_bvalid_i(axi_d_bvalid_w)
+    ,.axi_d_bresp_i(axi_d_bresp_w)
+    ,.axi_d_bid_i(axi_d_bid_w)
+    ,.axi_d_arready_i(axi_d_arready_w)
+    ,.axi_d_rvalid_i(axi_d_rvalid_w)
+    ,.axi_d_rdata_i(axi_d_rdata_w)
+    ,.axi_d_rresp_i(axi_d_rresp_w)
+    ,.axi_d_rid_i(axi_d_rid_w)
+    ,.axi_d_rlast_i(axi_d_rlast_w)
+    ,.intr_i(intr_i)
+    ,.reset_vector_i(reset_vector_i)
+
+    // Outputs
+    ,.axi_i_awvalid_o(axi_i_awvalid_w)
+    ,.axi_i_awaddr_o(axi_i_awaddr_w)
+    ,.axi_i_awid_o(axi_i_awid_w)
+    ,.axi_i_awlen_o(axi_i_awlen_w)
+    ,.axi_i_awburst_o(axi_i_awburst_w)
+    ,.axi_i_wvalid_o(axi_i_wvalid_w)
+    ,.axi_i_wdata_o(axi_i_wdata_w)
+    ,.axi_i_wstrb_o(axi_i_wstrb_w)
+    ,.axi_i_wlast_o(axi_i_wlast_w)
+    ,.axi_i_bready_o(axi_i_bready_w)
+    ,.axi_i_arvalid_o(axi_i_arvalid_w)
+    ,.axi_i_araddr_o(axi_i_araddr_w)
+    ,.axi_i_arid_o(axi_i_arid_w)
+    ,.axi_i_arlen_o(axi_i_arlen_w)
+    ,.axi_i_arburst_o(axi_i_arburst_w)
+    ,.axi_i_rready_o(axi_i_rready_w)
+    ,.axi_d_awvalid_o(axi_d_awvalid_w)
+    ,.axi_d_awaddr_o(axi_d_awaddr_w)
+    ,.axi_d_awid_o(axi_d_awid_w)
+    ,.axi_d_awlen_o(axi_d_awlen_w)
+    ,.axi_d_awburst_o(axi_d_awburst_w)
+    ,.axi_d_wvalid_o(axi_d_wvalid_w)
+    ,.axi_d_wdata_o(axi_d_wdata_w)
+    ,.axi_d_wstrb_o(axi_d_wstrb_w)
+    ,.axi_d_wlast_o(axi_d_wlast_w)
+    ,.axi_d_bready_o(axi_d_bready_w)
+    ,.axi_d_arvalid_o(axi_d_arvalid_w)
+    ,.axi_d_araddr_o(axi_d_araddr_w)
+    ,.axi_d_arid_o(axi_d_arid_w)
+    ,.axi_d_arlen_o(axi_d_arlen_w)
+    ,.axi_d_arburst_o(axi_d_arburst_w)
+    ,.axi_d_rready_o(axi_d_rready_w)
+);
+
+//-----------------------------------------------------------------
+// Instruction fetch memory port
+//-----------------------------------------------------------------
+tb_dpi_axi_mem
+u_mem_i
+(
+    // Inputs
+     .clk_i(clk_i)
+    ,.rst_i(rst_i)
+    ,.latency_i(latency_i)
+    ,.axi_awvalid_i(axi_i_awvalid_w)
+    ,.axi_awaddr_i(axi_i_awaddr_w)
+    ,.axi_awid_i(axi_i_awid_w)
+    ,.axi_awlen_i(axi_i_awlen_w)
+    ,.axi_awburst_i(axi_i_awburst_w)
+    ,.axi_wvalid_i(axi_i_wvalid_w)
+    ,.axi_wdata_i(axi_i_wdata_w)
+    ,.axi_wstrb_i(axi_i_wstrb_w)
+    ,.axi_wlast_i(axi_i_wlast_w)
+    ,.axi_bready_i(axi_i_bready_w)
+    ,.axi_arvalid_i(axi_i_arvalid_w)
+    ,.axi_araddr_i(axi_i_araddr_w)
+    ,.axi_arid_i(axi_i_arid_w)
+    ,.axi_arlen_i(axi_i_arlen_w)
+    ,.axi_arburst_i(axi_i_arburst_w)
+    ,.axi_rready_i(axi_i_rready_w)
+
+    // Outputs
+    ,.axi_awready_o(axi_i_awready_w)
+    ,.axi_wready_o(axi_i_wready_w)
+    ,.axi_bvalid_o(axi_i_bvalid_w)
+    ,.axi_bresp_o(axi_i_bresp_w)
+    ,.axi_bid_o(axi_i_bid_w)
+    ,.axi_arready_o(axi_i_arready_w)
+    ,.axi_rvalid_o(axi_i_rvalid_w)
+    ,.axi_rdata_o(axi_i_rdata_w)
+    ,.axi_rresp_o(axi_i_rresp_w)
+    ,.axi_rid_o(axi_i_rid_w)
+    ,.axi_rlast_o(axi_i_rlast_w)
+);
+
+//-----------------------------------------------------------------
+// Data memory port
+//-----------------------------------------------------------------
+tb_dpi_axi_mem
+u_mem_d
+(
+    // Inputs
+     .clk_i(clk_i)
+    ,.rst_i(rst_i)
+    ,.latency_i(latency_i)
+    ,.axi_awvalid_i(axi_d_awvalid_w)
+    ,.axi_awaddr_i(axi_d_awaddr_w)
+    ,.axi_awid_i(axi_d_awid_w)
+    ,.axi_awlen_i(axi_d_awlen_w)
+    ,.axi_awburst_i(axi_d_awburst_w)
+    ,.axi_wvalid_i(axi_d_wvalid_w)
+    ,.axi_wdata_i(axi_d_wdata_w)
+    ,.axi_wstrb_i(axi_d_wstrb_w)
+    ,.axi_wlast_i(axi_d_wlast_w)
+    ,.axi_bready_i(axi_d_bready_w)
+    ,.axi_arvalid_i(axi_d_arvalid_w)
+    ,.axi_araddr_i(axi_d_araddr_w)
+    ,.axi_arid_i(axi_d_arid_w)
+    ,.axi_arlen_i(axi_d_arlen_w)
+    ,.axi_arburst_i(axi_d_arburst_w)
+    ,.axi_rready_i(axi_d_rready_w)
+
+    // Outputs
+    ,.axi_awready_o(axi_d_awready_w)
+    ,.axi_wready_o(axi_d_wready_w)
+    ,.axi_bvalid_o(axi_d_bvalid_w)
+    ,.axi_bresp_o(axi_d_bresp_w)
+    ,.axi_bid_o(axi_d_bid_w)
+    ,.axi_arready_o(axi_d_arready_w)
+    ,.axi_rvalid_o(axi_d_rvalid_w)
+    ,.axi_rdata_o(axi_d_rdata_w)
+    ,.axi_rresp_o(axi_d_rresp_w)
+    ,.axi_rid_o(axi_d_rid_w)
+    ,.axi_rlast_o(axi_d_rlast_w)
+);
+
+endmodule
@@ -0,0 +1,108 @@
+#include "tb_axi4_lite_periph.h"
+#include <queue>
+
+//-----------------------------------------------------------------
+// Defines
+//-----------------------------------------------------------------
+#define AXI4_LITE_RESP_OKAY     0
+#define AXI4_LITE_RESP_DECERR   3
+#define AXI4_LITE_QUEUE_DEPTH   4
+
+//-----------------------------------------------------------------
+// process: Handle AXI4-Lite requests
+//-----------------------------------------------------------------
+void tb_axi4_lite_periph::process(void)
+{
+    std::queue <uint32_t>         axi_rd_q;
+    std::queue <uint32_t>         axi_aw_q;
+    std::queue <axi4_lite_master> axi_w_q;
+    std::queue <uint32_t>         axi_b_q;
+
+    while (1)
+    {
+        axi4_lite_master axi_i = axi_in.read();
+        axi4_lite_slave  axi_o = axi_out.read();
+
+        // Read command
+        if (axi_i.ARVALID && axi_o.ARREADY)
+            axi_rd_q.push((uint32_t)axi_i.ARADDR);
+
+        // Write command
+        if (axi_i.AWVALID && axi_o.AWREADY)
+            axi_aw_q.push((uint32_t)axi_i.AWADDR);
+
+        // Write data
+        if (axi_i.WVALID && axi_o.WREADY)
+            axi_w_q.push(axi_i);
+
+        // Perform writes once address and data are both present
+        while (axi_aw_q.size() > 0 && axi_w_q.size() > 0)
+        {
+            uint32_t         addr = axi_aw_q.front();
+            axi4_lite_master item = axi_w_q.front();
+            axi_aw_q.pop();
+            axi_w_q.pop();
+
+            tb_device *dev = find_device(addr);
+            if (dev)
+                dev->write32((addr & ~3) - dev->get_base(), (uint32_t)item.WDATA, (uint8_t)item.WSTRB);
+            else
+                printf("ERROR: Peripheral write out of range 0x%08x\n", addr);
+
+            axi_b_q.push(dev ? AXI4_LITE_RESP_OKAY : AXI4_LITE_RESP_DECERR);
+        }
+
+        if (axi_o.RVALID && axi_i.RREADY)
+        {
+            axi_o.RVALID = false;
+            axi_o.RDATA  = 0;
+            axi_o.RRESP  = 0;
+        }
+
+        if (!axi_o.RVALID && axi_rd_q.size() > 0)
+        {
+            uint32_t addr = axi_rd_q.front();
+            axi_rd_q.pop();
+
+            tb_device *dev = find_device(addr);
+            if (!dev)
+                printf("ERROR: Peripheral read out of range 0x%08x\n", addr);
+
+            axi_o.RVALID = true;
+            axi_o.RDATA  = dev ? dev->read32((addr & ~3) - dev->get_base()) : 0;
+            axi_o.RRESP  = dev ? AXI4_LITE_RESP_OKAY : AXI4_LITE_RESP_DECERR;
+        }
+
+        if (axi_o.BVALID && axi_i.BREADY)
+        {
+            axi_o.BVALID = false;
+            axi_o.BRESP  = 0;
+        }
+
+        if (!axi_o.BVALID && axi_b_q.size() > 0)
+        {
+            axi_o.BVALID = true;
+            axi_o.BRESP  = axi_b_q.front();
+            axi_b_q.pop();
+        }
+
+        axi_o.ARREADY = axi_rd_q.size() < AXI4_LITE_QUEUE_DEPTH;
+        axi_o.AWREADY = axi_aw_q.size() < AXI4_LITE_QUEUE_DEPTH;
+        axi_o.WREADY  = axi_w_q.size()  < AXI4_LITE_QUEUE_DEPTH;
+
+        axi_out.write(axi_o);
+
+        wait();
+    }
+}
+//-----------------------------------------------------------------
+// find_device: Decode address to peripheral
+//-----------------------------------------------------------------
+tb_device* tb_axi4_lite_periph::find_device(uint32_t addr)
+{
+    for (size_t i=0;i<m_devices.size();i++)
+        if (m_devices[i]->match(addr))
+            return m_devices[i];
+
+    return NULL;
+}
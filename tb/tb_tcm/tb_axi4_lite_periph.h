@@ -0,0 +1,58 @@
+#ifndef TB_AXI4_LITE_PERIPH_H
+#define TB_AXI4_LITE_PERIPH_H
+
+#include "axi4_lite.h"
+#include "tb_periph.h"
+#include <vector>
+
+//-------------------------------------------------------------
+// tb_axi4_lite_periph: AXI4-Lite slave for peripheral models
+//-------------------------------------------------------------
+class tb_axi4_lite_periph: public sc_module
+{
+public:
+    //-------------------------------------------------------------
+    // Interface I/O
+    //-------------------------------------------------------------
+    sc_in <bool>                clk_in;
+    sc_in <bool>                rst_in;
+
+    sc_in <axi4_lite_master>    axi_in;
+    sc_out <axi4_lite_slave>    axi_out;
+
+    //-------------------------------------------------------------
+    // Constructor
+    //-------------------------------------------------------------
+    SC_HAS_PROCESS(tb_axi4_lite_periph);
+    tb_axi4_lite_periph(sc_module_name name): sc_module(name)
+    {
+        SC_CTHREAD(process, clk_in.pos());
+    }
+
+    //-------------------------------------------------------------
+    // Trace
+    //-------------------------------------------------------------
+    void add_trace(sc_trace_file *vcd, std::string prefix)
+    {
+        #undef  TRACE_SIGNAL
+        #define TRACE_SIGNAL(s) sc_trace(vcd,s,prefix + #s)
+
+        TRACE_SIGNAL(axi_out);
+        TRACE_SIGNAL(axi_in);
+
+        #undef  TRACE_SIGNAL
+    }
+
+    //-------------------------------------------------------------
+    // API
+    //-------------------------------------------------------------
+    void         add_device(tb_device *dev) { m_devices.push_back(dev); }
+    tb_device*   find_device(uint32_t addr);
+
+    void         process(void);
+
+protected:
+    std::vector <tb_device *> m_devices;
+};
+
+#endif
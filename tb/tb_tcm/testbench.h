@@ -9,6 +9,7 @@
 #include "Vriscv_tcm_top_tcm_mem.h"
 
 #include "riscv_tcm_top_rtl.h"
+#include "tb_axi4_lite_periph.h"
 #include "Vriscv_tcm_top.h"
 
 #include "verilated.h"
@@ -50,6 +51,11 @@ public:
     // Instances / Members
     //-----------------------------------------------------------------      
     std::unique_ptr<riscv_tcm_top_rtl> m_dut;
+    std::unique_ptr<tb_axi4_lite_periph> m_periph;
+
+    std::unique_ptr<tb_clint>     m_clint;
+    std::unique_ptr<tb_uart_lite> m_uart;
+    std::unique_ptr<tb_plic>      m_plic;
 
     int                          m_argc;
     char**                       m_argv;
@@ -125,6 +131,12 @@ public:
             if (cycles >= max_cycles && max_cycles != -1)
                 break;
 
+            // Peripherals
+            m_clint->clock();
+            m_uart->clock();
+            m_plic->clock();
+            intr_in.write((m_plic->irq() ? 1 : 0) | (m_clint->irq() ? 2 : 0));
+
             wait();
         }
 
@@ -148,6 +160,21 @@ public:
         m_dut->axi_i_out(axi_i_out);
         m_dut->axi_i_in(axi_i_in);
         m_dut->intr_in(intr_in);
+
+        // Peripherals on the AXI4-Lite port
+        m_clint = std::make_unique<tb_clint>(CLINT_BASE);
+        m_uart  = std::make_unique<tb_uart_lite>(UART_LITE_BASE);
+        m_plic  = std::make_unique<tb_plic>(PLIC_BASE);
+        m_plic->add_source(PLIC_SRC_UART, m_uart.get());
+
+        m_periph = std::make_unique<tb_axi4_lite_periph>("PERIPH");
+        m_periph->clk_in(clk);
+        m_periph->rst_in(rst);
+        m_periph->axi_in(axi_i_out);
+        m_periph->axi_out(axi_i_in);
+        m_periph->add_device(m_clint.get());
+        m_periph->add_device(m_uart.get());
+        m_periph->add_device(m_plic.get());
     }
     
     //Enabling the design tracer
@@ -81,19 +81,12 @@ bool elf_load::load(void)
                 }
 
                 if (shdr64->sh_type == SHT_PROGBITS)
-                {                
-                    int i;
-                    for (i=0;i<shdr64->sh_size;i++)
+                {
+                    if (!m_target->write_block(shdr64->sh_addr, (uint8_t*)data->d_buf, shdr64->sh_size))
                     {
-                        uint32_t load_addr = shdr64->sh_addr + i;
-                        if (m_target->valid_addr(load_addr))
-                            m_target->write(load_addr, ((uint8_t*)data->d_buf)[i]);
-                        else
-                        {
-                            fprintf(stderr, "ERROR: Cannot write byte to 0x%08x\n", load_addr);
-                            close (fd);
-                            return false;
-                        }
+                        fprintf(stderr, "ERROR: Cannot write section to 0x%08lx\n", shdr64->sh_addr);
+                        close (fd);
+                        return false;
                     }
                 }
             }            
@@ -113,19 +106,12 @@ bool elf_load::load(void)
             }
 
             if (shdr->sh_type == SHT_PROGBITS)
-            {                
-                int i;
-                for (i=0;i<shdr->sh_size;i++)
+            {
+                if (!m_target->write_block(shdr->sh_addr, (uint8_t*)data->d_buf, shdr->sh_size))
                 {
-                    uint32_t load_addr = shdr->sh_addr + i;
-                    if (m_target->valid_addr(load_addr))
-                        m_target->write(load_addr, ((uint8_t*)data->d_buf)[i]);
-                    else
-                    {
-                        fprintf(stderr, "ERROR: Cannot write byte to 0x%08x\n", load_addr);
-                        close (fd);
-                        return false;
-                    }
+                    fprintf(stderr, "ERROR: Cannot write section to 0x%08x\n", shdr->sh_addr);
+                    close (fd);
+                    return false;
                 }
             }
         }
@@ -185,3 +171,44 @@ bool elf_load::get_symbol(const char *symname, uint32_t &value)
 
     return found;
 }
+//--------------------------------------------------------------------
+// get_symbols: Function symbols from ELF (address -> name)
+//--------------------------------------------------------------------
+bool elf_load::get_symbols(std::map<uint32_t, std::string> &symbols)
+{
+    bfd *ibfd;
+    asymbol **symtab;
+    long nsize, nsyms, i;
+    symbol_info syminfo;
+    char **matching;
+
+    bfd_init();
+
+    ibfd = bfd_openr(m_filename.c_str(), NULL);
+    if (ibfd == NULL)
+        return false;
+
+    if (!bfd_check_format_matches(ibfd, bfd_object, &matching))
+    {
+        bfd_close(ibfd);
+        return false;
+    }
+
+    nsize  = bfd_get_symtab_upper_bound (ibfd);
+    symtab = (asymbol **)malloc(nsize);
+    nsyms  = bfd_canonicalize_symtab(ibfd, symtab);
+
+    for (i = 0; i < nsyms; i++)
+    {
+        if (!(symtab[i]->flags & BSF_FUNCTION))
+            continue;
+
+        bfd_symbol_info(symtab[i], &syminfo);
+        symbols[(uint32_t)syminfo.value] = symtab[i]->name;
+    }
+
+    free(symtab);
+    bfd_close(ibfd);
+
+    return !symbols.empty();
+}
@@ -3,6 +3,7 @@
 
 #include "mem_api.h"
 #include <string>
+#include <map>
 
 //--------------------------------------------------------------------
 // ELF loader
@@ -15,6 +16,7 @@ public:
     bool     load(void);
     uint32_t get_entry_point(void) { return m_entry_point; }
     bool     get_symbol(const char *symname, uint32_t &value);
+    bool     get_symbols(std::map<uint32_t, std::string> &symbols);
 
 protected:
     std::string m_filename;
@@ -0,0 +1,393 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <string>
+#include <algorithm>
+
+#include "image_load.h"
+#include "elf_load.h"
+
+//--------------------------------------------------------------------
+// parse_hex: Parse fixed width hex field
+//--------------------------------------------------------------------
+static bool parse_hex(const char *str, int digits, uint32_t &value)
+{
+    value = 0;
+    for (int i=0;i<digits;i++)
+    {
+        char c = str[i];
+        value <<= 4;
+
+        if (c >= '0' && c <= '9')      value |= c - '0';
+        else if (c >= 'a' && c <= 'f') value |= c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F') value |= c - 'A' + 10;
+        else return false;
+    }
+    return true;
+}
+//--------------------------------------------------------------------
+// Constructor
+//--------------------------------------------------------------------
+image_load::image_load(const char *spec, mem_api *target, uint32_t default_addr)
+{
+    m_filename    = std::string(spec);
+    m_target      = target;
+    m_addr        = default_addr;
+    m_has_addr    = false;
+    m_entry_point = 0;
+    m_chunk_base  = 0;
+
+    // file@addr
+    size_t pos = m_filename.rfind('@');
+    if (pos != std::string::npos && pos + 1 < m_filename.size())
+    {
+        char *end = NULL;
+        uint32_t addr = (uint32_t)strtoul(m_filename.c_str() + pos + 1, &end, 0);
+        if (*end == 0)
+        {
+            m_addr     = addr;
+            m_has_addr = true;
+            m_filename = m_filename.substr(0, pos);
+        }
+    }
+
+    m_format = detect_format();
+}
+//--------------------------------------------------------------------
+// detect_format: ELF by magic, HEX / SREC by extension, else binary
+//--------------------------------------------------------------------
+eImageFormat image_load::detect_format(void)
+{
+    FILE *f = fopen(m_filename.c_str(), "rb");
+    if (f)
+    {
+        uint8_t magic[4] = {0};
+        size_t len = fread(magic, 1, sizeof(magic), f);
+        fclose(f);
+
+        if (len == 4 && magic[0] == 0x7F && magic[1] == 'E' && magic[2] == 'L' && magic[3] == 'F')
+            return IMAGE_ELF;
+    }
+
+    std::string ext;
+    size_t pos = m_filename.rfind('.');
+    if (pos != std::string::npos)
+        ext = m_filename.substr(pos + 1);
+
+    if (ext == "hex" || ext == "ihex" || ext == "ihx")
+        return IMAGE_IHEX;
+    else if (ext == "srec" || ext == "s19" || ext == "s28" || ext == "s37" || ext == "mot")
+        return IMAGE_SREC;
+
+    return IMAGE_BINARY;
+}
+//--------------------------------------------------------------------
+// load: Load image to target
+//--------------------------------------------------------------------
+bool image_load::load(void)
+{
+    switch (m_format)
+    {
+        case IMAGE_ELF:
+        {
+            if (m_has_addr)
+                printf("WARNING: %s: load address ignored for ELF\n", m_filename.c_str());
+
+            elf_load elf(m_filename.c_str(), m_target);
+            if (!elf.load())
+                return false;
+
+            m_entry_point = elf.get_entry_point();
+            return true;
+        }
+        case IMAGE_IHEX:
+            return load_ihex();
+        case IMAGE_SREC:
+            return load_srec();
+        case IMAGE_BINARY:
+        default:
+            return load_binary();
+    }
+}
+//--------------------------------------------------------------------
+// load_binary: Raw image at load address
+//--------------------------------------------------------------------
+bool image_load::load_binary(void)
+{
+    FILE *f = fopen(m_filename.c_str(), "rb");
+    if (!f)
+        return false;
+
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+
+    m_chunk_base = m_addr;
+    m_chunk.resize(size > 0 ? size : 0);
+
+    bool ok = fread(m_chunk.data(), 1, m_chunk.size(), f) == m_chunk.size();
+    fclose(f);
+
+    m_entry_point = m_addr;
+
+    return ok && flush() && commit();
+}
+//--------------------------------------------------------------------
+// load_ihex: Intel HEX (I8HEX / I16HEX / I32HEX)
+//--------------------------------------------------------------------
+bool image_load::load_ihex(void)
+{
+    FILE *f = fopen(m_filename.c_str(), "r");
+    if (!f)
+        return false;
+
+    uint32_t base    = 0;
+    uint32_t offset  = m_has_addr ? m_addr : 0;
+    int      line_no = 0;
+    char     line[1024];
+    bool     ok      = true;
+    bool     done    = false;
+
+    while (ok && !done && fgets(line, sizeof(line), f))
+    {
+        line_no++;
+
+        if (line[0] != ':')
+            continue;
+
+        uint32_t count, addr, type;
+        if (strlen(line) < 11 || !parse_hex(line + 1, 2, count) || !parse_hex(line + 3, 4, addr) ||
+            !parse_hex(line + 7, 2, type) || strlen(line) < 11 + count * 2)
+        {
+            fprintf(stderr, "ERROR: %s:%d: Malformed record\n", m_filename.c_str(), line_no);
+            ok = false;
+            break;
+        }
+
+        uint8_t  data[256];
+        uint32_t checksum = count + (addr >> 8) + (addr & 0xFF) + type;
+        for (uint32_t i=0;i<count+1;i++)
+        {
+            uint32_t value;
+            if (!parse_hex(line + 9 + i*2, 2, value))
+            {
+                ok = false;
+                break;
+            }
+            if (i < count)
+                data[i] = (uint8_t)value;
+            checksum += value;
+        }
+
+        if (!ok || (checksum & 0xFF) != 0)
+        {
+            fprintf(stderr, "ERROR: %s:%d: Bad checksum\n", m_filename.c_str(), line_no);
+            ok = false;
+            break;
+        }
+
+        switch (type)
+        {
+            // Data
+            case 0x00:
+                for (uint32_t i=0;i<count && ok;i++)
+                    ok = add_byte(offset + base + addr + i, data[i]);
+                break;
+            // End of file
+            case 0x01:
+                done = true;
+                break;
+            // Extended segment address
+            case 0x02:
+                base = ((data[0] << 8) | data[1]) << 4;
+                break;
+            // Start segment address (CS:IP)
+            case 0x03:
+                m_entry_point = (((data[0] << 8) | data[1]) << 4) + ((data[2] << 8) | data[3]);
+                break;
+            // Extended linear address
+            case 0x04:
+                base = ((data[0] << 8) | data[1]) << 16;
+                break;
+            // Start linear address
+            case 0x05:
+                m_entry_point = (data[0] << 24) | (data[1] << 16) | (data[2] << 8) | data[3];
+                break;
+            default:
+                break;
+        }
+    }
+
+    fclose(f);
+
+    return ok && flush() && commit();
+}
+//--------------------------------------------------------------------
+// load_srec: Motorola S-record (S19 / S28 / S37)
+//--------------------------------------------------------------------
+bool image_load::load_srec(void)
+{
+    FILE *f = fopen(m_filename.c_str(), "r");
+    if (!f)
+        return false;
+
+    uint32_t offset  = m_has_addr ? m_addr : 0;
+    int      line_no = 0;
+    char     line[1024];
+    bool     ok      = true;
+
+    while (ok && fgets(line, sizeof(line), f))
+    {
+        line_no++;
+
+        if (line[0] != 'S' || line[1] < '0' || line[1] > '9')
+            continue;
+
+        int      type = line[1] - '0';
+        uint32_t count;
+        if (!parse_hex(line + 2, 2, count) || count < 3 || strlen(line) < 4 + count * 2)
+        {
+            fprintf(stderr, "ERROR: %s:%d: Malformed record\n", m_filename.c_str(), line_no);
+            ok = false;
+            break;
+        }
+
+        // Address width
+        int addr_bytes;
+        switch (type)
+        {
+            case 2: case 8: addr_bytes = 3; break;
+            case 3: case 7: addr_bytes = 4; break;
+            default:        addr_bytes = 2; break;
+        }
+
+        uint8_t  bytes[256];
+        uint32_t checksum = 0;
+        for (uint32_t i=0;i<count+1;i++)
+        {
+            uint32_t value;
+            if (!parse_hex(line + 2 + i*2, 2, value))
+            {
+                ok = false;
+                break;
+            }
+            bytes[i]  = (uint8_t)value;
+            checksum += value;
+        }
+
+        // Sum of count, address, data and checksum is 0xFF
+        if (!ok || (checksum & 0xFF) != 0xFF || (int)count < addr_bytes + 1)
+        {
+            fprintf(stderr, "ERROR: %s:%d: Bad checksum\n", m_filename.c_str(), line_no);
+            ok = false;
+            break;
+        }
+
+        uint32_t addr = 0;
+        for (int i=0;i<addr_bytes;i++)
+            addr = (addr << 8) | bytes[1 + i];
+
+        switch (type)
+        {
+            // Data
+            case 1: case 2: case 3:
+            {
+                uint32_t len = count - addr_bytes - 1;
+                for (uint32_t i=0;i<len && ok;i++)
+                    ok = add_byte(offset + addr + i, bytes[1 + addr_bytes + i]);
+                break;
+            }
+            // Start address
+            case 7: case 8: case 9:
+                m_entry_point = addr;
+                break;
+            default:
+                break;
+        }
+    }
+
+    fclose(f);
+
+    return ok && flush() && commit();
+}
+//--------------------------------------------------------------------
+// add_byte: Append to current chunk (new chunk on discontinuity)
+//--------------------------------------------------------------------
+bool image_load::add_byte(uint32_t addr, uint8_t data)
+{
+    if (m_chunk.size() > 0 && addr != m_chunk_base + (uint32_t)m_chunk.size())
+    {
+        if (!flush())
+            return false;
+    }
+
+    if (m_chunk.size() == 0)
+        m_chunk_base = addr;
+
+    m_chunk.push_back(data);
+    return true;
+}
+//--------------------------------------------------------------------
+// flush: Close the current chunk
+//--------------------------------------------------------------------
+bool image_load::flush(void)
+{
+    if (m_chunk.size() == 0)
+        return true;
+
+    chunk c;
+    c.base = m_chunk_base;
+    c.data.swap(m_chunk);
+    m_chunks.push_back(c);
+    return true;
+}
+//--------------------------------------------------------------------
+// commit: Create one memory region per group of nearby chunks (a HEX
+// / SREC file with many gaps would otherwise use up the target's
+// regions), then bulk copy the chunks
+//--------------------------------------------------------------------
+bool image_load::commit(void)
+{
+    std::sort(m_chunks.begin(), m_chunks.end(),
+              [](const chunk &a, const chunk &b) { return a.base < b.base; });
+
+    size_t first = 0;
+    while (first < m_chunks.size())
+    {
+        uint32_t base = m_chunks[first].base;
+        uint64_t end  = (uint64_t)base + m_chunks[first].data.size();
+        size_t   last = first + 1;
+
+        while (last < m_chunks.size() && m_chunks[last].base <= end + IMAGE_MERGE_GAP)
+        {
+            uint64_t chunk_end = (uint64_t)m_chunks[last].base + m_chunks[last].data.size();
+            if (chunk_end > end)
+                end = chunk_end;
+            last++;
+        }
+
+        uint32_t size = (uint32_t)(end - base);
+
+        printf("Memory: 0x%x - 0x%x (Size=%dKB) [%s]\n", base, base + size - 1, size / 1024, m_filename.c_str());
+
+        if (!m_target->create_memory(base, size))
+        {
+            fprintf(stderr, "ERROR: Cannot allocate memory region\n");
+            return false;
+        }
+
+        for (size_t i=first;i<last;i++)
+        {
+            if (!m_target->write_block(m_chunks[i].base, m_chunks[i].data.data(), (uint32_t)m_chunks[i].data.size()))
+            {
+                fprintf(stderr, "ERROR: Cannot write image to 0x%08x\n", m_chunks[i].base);
+                return false;
+            }
+        }
+
+        first = last;
+    }
+
+    m_chunks.clear();
+    return true;
+}
@@ -0,0 +1,70 @@
+#ifndef __IMAGE_LOAD_H__
+#define __IMAGE_LOAD_H__
+
+#include "mem_api.h"
+#include <string>
+#include <vector>
+
+//--------------------------------------------------------------------
+// Defines
+//--------------------------------------------------------------------
+// HEX / SREC chunks closer than this share one memory region
+#define IMAGE_MERGE_GAP     (16 * 1024 * 1024)
+
+//--------------------------------------------------------------------
+// Image formats
+//--------------------------------------------------------------------
+enum eImageFormat
+{
+    IMAGE_ELF,
+    IMAGE_BINARY,
+    IMAGE_IHEX,
+    IMAGE_SREC
+};
+
+//--------------------------------------------------------------------
+// Image loader: ELF, raw binary, Intel HEX or Motorola SREC.
+// Spec is 'file[@addr]' - addr is the load address of a raw binary,
+// or an offset added to the record addresses of a HEX / SREC file.
+//--------------------------------------------------------------------
+class image_load
+{
+public:
+    image_load(const char *spec, mem_api *target, uint32_t default_addr);
+
+    bool         load(void);
+    uint32_t     get_entry_point(void) { return m_entry_point; }
+    eImageFormat get_format(void)      { return m_format; }
+
+protected:
+    eImageFormat detect_format(void);
+
+    bool         load_binary(void);
+    bool         load_ihex(void);
+    bool         load_srec(void);
+
+    bool         add_byte(uint32_t addr, uint8_t data);
+    bool         flush(void);
+    bool         commit(void);
+
+    std::string  m_filename;
+    mem_api *    m_target;
+    uint32_t     m_addr;
+    bool         m_has_addr;
+    eImageFormat m_format;
+    uint32_t     m_entry_point;
+
+    // Contiguous chunk being assembled from HEX / SREC records
+    uint32_t             m_chunk_base;
+    std::vector<uint8_t> m_chunk;
+
+    // Completed chunks, written out by commit()
+    struct chunk
+    {
+        uint32_t             base;
+        std::vector<uint8_t> data;
+    };
+    std::vector<chunk>   m_chunks;
+};
+
+#endif
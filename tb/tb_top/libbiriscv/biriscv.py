@@ -0,0 +1,144 @@
+#!/usr/bin/env python3
+###############################################################################
+# biriscv.py: ctypes bindings for libbiriscv.so
+#
+#   sim = Biriscv(ram_size=32 << 20)
+#   sim.load('test.elf')
+#   sim.reset(sim.entry_point())
+#   sim.run_until_pc(0x80000100, max_cycles=100000)
+#   print(hex(sim.reg(10)), sim.counters())
+#
+# Biriscv(model='fast') loads the variant lib/libbiriscv_fast.so (make models)
+###############################################################################
+import ctypes
+import os
+
+EVENT_CYCLES = 1 << 0
+EVENT_PC     = 1 << 1
+EVENT_FINISH = 1 << 2
+
+MEM_BASE     = 0x80000000
+
+class Counters(ctypes.Structure):
+    _fields_ = [(name, ctypes.c_uint64) for name in [
+        'cycles',
+        'instret',
+        'dual_retire_cycles',
+        'icache_rd_bursts',
+        'icache_rd_wait_cycles',
+        'dcache_rd_bursts',
+        'dcache_wr_bursts',
+        'dcache_rd_wait_cycles',
+        'dcache_wr_wait_cycles']]
+
+    def as_dict(self):
+        return {name: getattr(self, name) for name, _ in self._fields_}
+
+def _load_library(path, model=None):
+    if path is None and model not in (None, 'default'):
+        path = os.path.join(os.path.dirname(os.path.abspath(__file__)), 'lib', 'libbiriscv_%s.so' % model)
+    if path is None:
+        path = os.environ.get('LIBBIRISCV', os.path.join(os.path.dirname(os.path.abspath(__file__)), 'lib', 'libbiriscv.so'))
+
+    lib = ctypes.CDLL(path)
+    u32, u64, ptr = ctypes.c_uint32, ctypes.c_uint64, ctypes.c_void_p
+    buf = ctypes.POINTER(ctypes.c_uint8)
+
+    def proto(name, res, *args):
+        fn = getattr(lib, name)
+        fn.restype  = res
+        fn.argtypes = list(args)
+
+    proto('biriscv_create',       ptr, u32)
+    proto('biriscv_destroy',      None, ptr)
+    proto('biriscv_load',         ctypes.c_int, ptr, ctypes.c_char_p)
+    proto('biriscv_entry_point',  u32, ptr)
+    proto('biriscv_clear_memory', None, ptr)
+    proto('biriscv_reset',        None, ptr, u32)
+    proto('biriscv_step',         u64, ptr, u64)
+    proto('biriscv_run_until',    ctypes.c_int, ptr, u32, u32, u64)
+    proto('biriscv_get_reg',      u32, ptr, ctypes.c_int)
+    proto('biriscv_get_pc',       u32, ptr)
+    proto('biriscv_get_csr',      u32, ptr, u32)
+    proto('biriscv_read_mem',     ctypes.c_int, ptr, u32, buf, u32)
+    proto('biriscv_write_mem',    ctypes.c_int, ptr, u32, buf, u32)
+    proto('biriscv_get_counters', None, ptr, ctypes.POINTER(Counters))
+    proto('biriscv_abi_version',  u32)
+    proto('biriscv_model_name',   ctypes.c_char_p)
+    proto('biriscv_model_params', ctypes.c_char_p)
+    return lib
+
+class Biriscv:
+    """Single instance per process (SystemC elaborates the model once)"""
+    def __init__(self, ram_size=0, lib=None, model=None):
+        self._lib = _load_library(lib, model)
+        self._sim = self._lib.biriscv_create(ram_size)
+        if not self._sim:
+            raise RuntimeError('libbiriscv: model already in use')
+
+    def close(self):
+        if self._sim:
+            self._lib.biriscv_destroy(self._sim)
+            self._sim = None
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *args):
+        self.close()
+
+    # Images / reset
+    def load(self, spec):
+        if not self._lib.biriscv_load(self._sim, spec.encode()):
+            raise IOError('libbiriscv: could not load %s' % spec)
+
+    def entry_point(self):
+        return self._lib.biriscv_entry_point(self._sim)
+
+    def clear_memory(self):
+        self._lib.biriscv_clear_memory(self._sim)
+
+    def reset(self, pc=MEM_BASE):
+        self._lib.biriscv_reset(self._sim, pc)
+
+    # Execution
+    def step(self, cycles=1):
+        return self._lib.biriscv_step(self._sim, cycles)
+
+    def run_until(self, events, pc=0, max_cycles=0):
+        return self._lib.biriscv_run_until(self._sim, events, pc, max_cycles)
+
+    def run_until_pc(self, pc, max_cycles=0):
+        return self.run_until(EVENT_PC, pc, max_cycles)
+
+    def run_until_finish(self, max_cycles=0):
+        return self.run_until(EVENT_FINISH, 0, max_cycles)
+
+    # State
+    def reg(self, r):
+        return self._lib.biriscv_get_reg(self._sim, r)
+
+    def pc(self):
+        return self._lib.biriscv_get_pc(self._sim)
+
+    def csr(self, addr):
+        return self._lib.biriscv_get_csr(self._sim, addr)
+
+    def read_mem(self, addr, length):
+        data = (ctypes.c_uint8 * length)()
+        if not self._lib.biriscv_read_mem(self._sim, addr, data, length):
+            raise IndexError('libbiriscv: bad address 0x%08x' % addr)
+        return bytes(data)
+
+    def write_mem(self, addr, data):
+        data = (ctypes.c_uint8 * len(data)).from_buffer_copy(data)
+        if not self._lib.biriscv_write_mem(self._sim, addr, data, len(data)):
+            raise IndexError('libbiriscv: bad address 0x%08x' % addr)
+
+    def model(self):
+        return self._lib.biriscv_model_name().decode(), self._lib.biriscv_model_params().decode()
+
+    def counters(self):
+        c = Counters()
+        self._lib.biriscv_get_counters(self._sim, ctypes.byref(c))
+        return c.as_dict()
@@ -0,0 +1,267 @@
+//-----------------------------------------------------------------
+// biriscv_run: Run an image on a prebuilt model variant selected
+// at runtime (--model NAME -> libbiriscv_NAME.so, via dlopen).
+// Not linked against SystemC / Verilator; everything goes through
+// the libbiriscv C API.
+//-----------------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <getopt.h>
+#include <dlfcn.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <limits.h>
+#include <string>
+#include <vector>
+
+#include "biriscv_sim.h"
+
+//-----------------------------------------------------------------
+// biriscv_api: C API resolved from the model library
+//-----------------------------------------------------------------
+struct biriscv_api
+{
+    uint32_t     (*abi_version)(void);
+    const char * (*model_name)(void);
+    const char * (*model_params)(void);
+    void *       (*create)(uint32_t ram_size);
+    void         (*destroy)(void *sim);
+    int          (*load)(void *sim, const char *spec);
+    uint32_t     (*entry_point)(void *sim);
+    void         (*reset)(void *sim, uint32_t pc);
+    int          (*run_until)(void *sim, uint32_t events, uint32_t pc, uint64_t max_cycles);
+    void         (*get_counters)(void *sim, biriscv_counters *counters);
+};
+
+//-----------------------------------------------------------------
+// model_dir: Model search directory ($BIRISCV_MODEL_DIR or next
+// to this executable)
+//-----------------------------------------------------------------
+static std::string model_dir(void)
+{
+    const char *env = getenv("BIRISCV_MODEL_DIR");
+    if (env)
+        return env;
+
+    char path[PATH_MAX];
+    ssize_t len = readlink("/proc/self/exe", path, sizeof(path) - 1);
+    if (len <= 0)
+        return ".";
+    path[len] = 0;
+
+    char *slash = strrchr(path, '/');
+    if (slash)
+        *slash = 0;
+    return path;
+}
+
+//-----------------------------------------------------------------
+// model_path: NAME -> DIR/libbiriscv_NAME.so (paths used as is)
+//-----------------------------------------------------------------
+static std::string model_path(const char *name)
+{
+    if (strchr(name, '/'))
+        return name;
+    if (!strcmp(name, "default"))
+        return model_dir() + "/libbiriscv.so";
+    return model_dir() + "/libbiriscv_" + name + ".so";
+}
+
+//-----------------------------------------------------------------
+// list_models: Print available variants
+//-----------------------------------------------------------------
+static void list_models(void)
+{
+    std::string dir = model_dir();
+    DIR *d = opendir(dir.c_str());
+    if (!d)
+    {
+        fprintf(stderr, "ERROR: Cannot open model directory %s\n", dir.c_str());
+        return;
+    }
+
+    struct dirent *e;
+    while ((e = readdir(d)) != NULL)
+    {
+        const char *n   = e->d_name;
+        size_t      len = strlen(n);
+
+        if (len < 3 || strcmp(n + len - 3, ".so") || strncmp(n, "libbiriscv", 10))
+            continue;
+
+        if (!strcmp(n, "libbiriscv.so"))
+            printf("default\n");
+        else if (n[10] == '_')
+            printf("%.*s\n", (int)(len - 14), n + 11);
+    }
+    closedir(d);
+}
+
+//-----------------------------------------------------------------
+// open_model: dlopen + resolve API
+//-----------------------------------------------------------------
+static bool open_model(const char *name, biriscv_api &api)
+{
+    std::string path = model_path(name);
+
+    void *lib = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (!lib)
+    {
+        fprintf(stderr, "ERROR: Cannot load model '%s': %s\n", name, dlerror());
+        return false;
+    }
+
+    #define RESOLVE(f) \
+        *(void **)(&api.f) = dlsym(lib, "biriscv_" #f); \
+        if (!api.f) { fprintf(stderr, "ERROR: %s: missing biriscv_" #f "\n", path.c_str()); return false; }
+
+    RESOLVE(abi_version);
+    RESOLVE(model_name);
+    RESOLVE(model_params);
+    RESOLVE(create);
+    RESOLVE(destroy);
+    RESOLVE(load);
+    RESOLVE(entry_point);
+    RESOLVE(reset);
+    RESOLVE(run_until);
+    RESOLVE(get_counters);
+
+    #undef RESOLVE
+
+    if (api.abi_version() != BIRISCV_ABI_VERSION)
+    {
+        fprintf(stderr, "ERROR: %s: ABI version %u, expected %u\n",
+                path.c_str(), api.abi_version(), BIRISCV_ABI_VERSION);
+        return false;
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------
+// Command line options
+//-----------------------------------------------------------------
+#define GETOPTS_ARGS "M:lf:c:p:r:e:h"
+
+static struct option long_options[] =
+{
+    {"model",      required_argument, 0, 'M'},
+    {"list",       no_argument,       0, 'l'},
+    {"elf",        required_argument, 0, 'f'},
+    {"cycles",     required_argument, 0, 'c'},
+    {"stop-pc",    required_argument, 0, 'p'},
+    {"ram-size",   required_argument, 0, 'r'},
+    {"entry",      required_argument, 0, 'e'},
+    {"help",       no_argument,       0, 'h'},
+    {0, 0, 0, 0}
+};
+
+static void help_options(void)
+{
+    fprintf (stderr,"Usage:\n");
+    fprintf (stderr,"  --model      | -M NAME        Model variant (libbiriscv_NAME.so, default 'default')\n");
+    fprintf (stderr,"  --list       | -l             List available model variants\n");
+    fprintf (stderr,"  --elf        | -f FILE[@ADDR] Image to load (ELF, binary, HEX, SREC)\n");
+    fprintf (stderr,"  --cycles     | -c NUM         Max cycles (default: no limit)\n");
+    fprintf (stderr,"  --stop-pc    | -p PC          Stop after PC retires (default: $finish)\n");
+    fprintf (stderr,"  --ram-size   | -r BYTES       RAM at 0x%08x independent of image\n", BIRISCV_MEM_BASE);
+    fprintf (stderr,"  --entry      | -e PC          Reset vector (default: image entry point)\n");
+    fprintf (stderr,"Model directory: $BIRISCV_MODEL_DIR or the directory of this executable\n");
+    exit(-1);
+}
+
+//-----------------------------------------------------------------
+// main
+//-----------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+    const char *  model      = "default";
+    std::vector <const char *> images;
+    uint64_t      max_cycles = 0;
+    uint32_t      stop_pc    = 0;
+    bool          stop_at_pc = false;
+    uint32_t      ram_size   = 0;
+    uint32_t      entry      = 0;
+    bool          set_entry  = false;
+    int           help       = 0;
+    int c;
+
+    int option_index = 0;
+    while ((c = getopt_long (argc, argv, GETOPTS_ARGS, long_options, &option_index)) != -1)
+    {
+        switch(c)
+        {
+            case 'M':
+                model = optarg;
+                break;
+            case 'l':
+                list_models();
+                return 0;
+            case 'f':
+                images.push_back(optarg);
+                break;
+            case 'c':
+                max_cycles = strtoull(optarg, NULL, 0);
+                break;
+            case 'p':
+                stop_pc    = (uint32_t)strtoul(optarg, NULL, 0);
+                stop_at_pc = true;
+                break;
+            case 'r':
+                ram_size = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'e':
+                entry     = (uint32_t)strtoul(optarg, NULL, 0);
+                set_entry = true;
+                break;
+            case '?':
+            default:
+                help = 1;
+                break;
+        }
+    }
+
+    if (help || images.empty())
+        help_options();
+
+    biriscv_api api;
+    if (!open_model(model, api))
+        return -1;
+
+    printf("Model: %s %s\n", api.model_name(), api.model_params());
+
+    void *sim = api.create(ram_size);
+    if (!sim)
+    {
+        fprintf(stderr, "ERROR: Could not create model\n");
+        return -1;
+    }
+
+    for (size_t i=0;i<images.size();i++)
+    {
+        if (!api.load(sim, images[i]))
+        {
+            fprintf(stderr, "ERROR: Could not load %s\n", images[i]);
+            api.destroy(sim);
+            return -1;
+        }
+    }
+
+    api.reset(sim, set_entry ? entry : api.entry_point(sim));
+
+    int event = api.run_until(sim, stop_at_pc ? BIRISCV_EVENT_PC : BIRISCV_EVENT_FINISH, stop_pc, max_cycles);
+
+    biriscv_counters counters;
+    api.get_counters(sim, &counters);
+
+    printf("Stopped: %s\n", (event & BIRISCV_EVENT_PC)     ? "pc" :
+                            (event & BIRISCV_EVENT_FINISH) ? "finish" : "cycles");
+    printf("Cycles: %lu Instructions: %lu IPC: %.3f\n",
+           (unsigned long)counters.cycles, (unsigned long)counters.instret,
+           counters.cycles ? (double)counters.instret / counters.cycles : 0.0);
+
+    api.destroy(sim);
+    return 0;
+}
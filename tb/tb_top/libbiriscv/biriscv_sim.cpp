@@ -0,0 +1,398 @@
+#include <systemc.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "biriscv_sim.h"
+#include "image_load.h"
+#include "sc_reset_gen.h"
+#include "tb_harness.h"
+
+//-----------------------------------------------------------------
+// Defines
+//-----------------------------------------------------------------
+#define BIRISCV_CLK_PERIOD      10
+
+// Set by the makefile for model variants (make models)
+#ifndef BIRISCV_MODEL_NAME
+#define BIRISCV_MODEL_NAME      "default"
+#endif
+#ifndef BIRISCV_MODEL_PARAMS
+#define BIRISCV_MODEL_PARAMS    ""
+#endif
+
+//-----------------------------------------------------------------
+// biriscv_harness: tb_harness clocked by a monitor thread which
+// pauses the scheduler on a stop event.
+//-----------------------------------------------------------------
+class biriscv_harness: public tb_harness
+{
+public:
+    //-----------------------------------------------------------------
+    // Instances / Members
+    //-----------------------------------------------------------------
+    // Stop conditions
+    uint32_t                     m_events;
+    uint32_t                     m_stop_pc;
+    uint64_t                     m_stop_cycle;
+    int                          m_event;
+
+    // Pending reset request
+    bool                         m_reset_req;
+    uint32_t                     m_reset_pc;
+
+    // State
+    bool                         m_finished;
+    uint32_t                     m_pc;
+    uint64_t                     m_cycles;
+    uint64_t                     m_instret;
+    uint64_t                     m_dual_retire;
+
+    //-----------------------------------------------------------------
+    // monitor: Clock peripherals, track retirement, check stop events
+    //-----------------------------------------------------------------
+    void monitor(void)
+    {
+        // Core held in reset until the first reset() request
+        rst_cpu_in.write(true);
+
+        while (true)
+        {
+            wait();
+
+            if (m_reset_req)
+            {
+                do_reset(m_reset_pc);
+                m_reset_req = false;
+                sc_pause();
+                continue;
+            }
+
+            m_cycles += 1;
+
+            // Peripherals
+            clock_peripherals();
+
+            int      event = 0;
+            int      retired = 0;
+            uint32_t pc, opcode, result;
+
+            for (int slot=0;slot<2;slot++)
+                if (m_dut->get_retire(slot, pc, opcode, result))
+                {
+                    m_pc = pc;
+                    retired++;
+
+                    if ((m_events & BIRISCV_EVENT_PC) && pc == m_stop_pc)
+                        event |= BIRISCV_EVENT_PC;
+                }
+
+            m_instret += retired;
+            if (retired == 2)
+                m_dual_retire++;
+
+            if ((m_events & BIRISCV_EVENT_CYCLES) && m_cycles >= m_stop_cycle)
+                event |= BIRISCV_EVENT_CYCLES;
+
+            // $finish always stops the core
+            if (m_finished)
+                event |= BIRISCV_EVENT_FINISH;
+
+            if (event)
+            {
+                m_event  = event;
+                m_events = 0;
+                sc_pause();
+            }
+        }
+    }
+
+    //-----------------------------------------------------------------
+    // do_reset: Reset core and peripherals (memory is retained)
+    //-----------------------------------------------------------------
+    void do_reset(uint32_t pc)
+    {
+        cpu_halt();
+        reset_peripherals();
+
+        m_finished    = false;
+        m_pc          = pc;
+        m_cycles      = 0;
+        m_instret     = 0;
+        m_dual_retire = 0;
+
+        cpu_release(pc);
+    }
+
+    //-----------------------------------------------------------------
+    // run: Run scheduler until one of events occurs
+    //-----------------------------------------------------------------
+    int run(uint32_t events, uint32_t pc, uint64_t max_cycles)
+    {
+        // Core stopped on $finish
+        if (m_finished)
+            return BIRISCV_EVENT_FINISH;
+
+        m_events     = events;
+        m_stop_pc    = pc;
+        m_stop_cycle = m_cycles + max_cycles;
+        m_event      = 0;
+
+        if (max_cycles)
+            m_events |= BIRISCV_EVENT_CYCLES;
+
+        sc_start();
+        return m_event;
+    }
+
+    //-----------------------------------------------------------------
+    // reset: Request reset, completes on the next clock edges
+    //-----------------------------------------------------------------
+    void reset(uint32_t pc)
+    {
+        m_reset_req = true;
+        m_reset_pc  = pc;
+        sc_start();
+    }
+
+    //-----------------------------------------------------------------
+    // finish_hook: $finish stops the core, the model is kept
+    //-----------------------------------------------------------------
+    bool finish_hook(void)
+    {
+        m_finished = true;
+        return true;
+    }
+
+    //-----------------------------------------------------------------
+    // Construction
+    //-----------------------------------------------------------------
+    SC_HAS_PROCESS(biriscv_harness);
+    biriscv_harness(sc_module_name name): tb_harness(name)
+    {
+        m_events      = 0;
+        m_stop_pc     = 0;
+        m_stop_cycle  = 0;
+        m_event       = 0;
+        m_reset_req   = false;
+        m_reset_pc    = BIRISCV_MEM_BASE;
+        m_finished    = false;
+        m_pc          = BIRISCV_MEM_BASE;
+        m_cycles      = 0;
+        m_instret     = 0;
+        m_dual_retire = 0;
+    }
+};
+
+//-----------------------------------------------------------------
+// Locals
+//-----------------------------------------------------------------
+static sc_clock        *g_clk     = NULL;
+static sc_reset_gen    *g_rst     = NULL;
+static biriscv_harness *g_harness = NULL;
+static bool             g_in_use  = false;
+
+//-----------------------------------------------------------------
+// vl_finish: Handling of verilog $finish (stop, keep the model)
+//-----------------------------------------------------------------
+void vl_finish (const char* filename, int linenum, const char* hier)
+{
+    if (g_harness)
+        g_harness->finish_hook();
+}
+
+//-----------------------------------------------------------------
+// sc_main: Not used - the embedding application owns main()
+//-----------------------------------------------------------------
+int __attribute__((weak)) sc_main(int argc, char* argv[])
+{
+    fprintf(stderr, "ERROR: libbiriscv does not provide sc_main\n");
+    return -1;
+}
+
+//-----------------------------------------------------------------
+// Constructor: The model is elaborated once and reused by later
+// instances (SystemC cannot elaborate a design twice)
+//-----------------------------------------------------------------
+biriscv_sim::biriscv_sim(uint32_t ram_size)
+{
+    sc_assert(!g_in_use);
+
+    if (!g_harness)
+    {
+        sc_report_handler::set_actions("/IEEE_Std_1666/deprecated", SC_DO_NOTHING);
+        sc_set_time_resolution(1, SC_NS);
+
+        // Same top level as test.x (main.cpp)
+        g_clk = new sc_clock("clk", BIRISCV_CLK_PERIOD, SC_NS);
+        g_rst = new sc_reset_gen("rst");
+        g_rst->clk(*g_clk);
+
+        g_harness = new biriscv_harness("biriscv");
+        g_harness->clk(*g_clk);
+        g_harness->rst(g_rst->rst);
+
+        // Elaborate, run power-on reset
+        sc_start(SC_ZERO_TIME);
+        g_harness->reset(BIRISCV_MEM_BASE);
+    }
+
+    g_in_use      = true;
+    m_tb          = g_harness;
+    m_ram_size    = ram_size;
+    m_entry_point = BIRISCV_MEM_BASE;
+
+    clear_memory();
+}
+//-----------------------------------------------------------------
+// Destructor: Release model for reuse
+//-----------------------------------------------------------------
+biriscv_sim::~biriscv_sim()
+{
+    m_tb->m_mem->clear();
+    g_in_use = false;
+}
+//-----------------------------------------------------------------
+// load: Load image (ELF, binary, HEX, SREC) - does not reset
+//-----------------------------------------------------------------
+bool biriscv_sim::load(const char *spec)
+{
+    image_load img(spec, m_tb, BIRISCV_MEM_BASE);
+    if (!img.load())
+    {
+        fprintf(stderr, "ERROR: Could not load %s\n", spec);
+        return false;
+    }
+
+    if (img.get_entry_point())
+        m_entry_point = img.get_entry_point();
+
+    return true;
+}
+//-----------------------------------------------------------------
+// clear_memory: Drop all regions, re-create RAM
+//-----------------------------------------------------------------
+void biriscv_sim::clear_memory(void)
+{
+    m_tb->m_mem->clear();
+    if (m_ram_size)
+        m_tb->create_memory(BIRISCV_MEM_BASE, m_ram_size);
+}
+//-----------------------------------------------------------------
+// reset: Reset core and peripherals, start at pc
+//-----------------------------------------------------------------
+void biriscv_sim::reset(uint32_t pc)
+{
+    m_tb->reset(pc);
+}
+//-----------------------------------------------------------------
+// step: Run for a number of cycles (returns cycles executed)
+//-----------------------------------------------------------------
+uint64_t biriscv_sim::step(uint64_t cycles)
+{
+    uint64_t start = m_tb->m_cycles;
+
+    if (cycles)
+        m_tb->run(0, 0, cycles);
+
+    return m_tb->m_cycles - start;
+}
+//-----------------------------------------------------------------
+// run_until: Run until an event (max_cycles = 0 for no limit).
+// BIRISCV_EVENT_PC stops after the instruction at pc retires.
+//-----------------------------------------------------------------
+int biriscv_sim::run_until(uint32_t events, uint32_t pc, uint64_t max_cycles)
+{
+    return m_tb->run(events, pc, max_cycles);
+}
+bool biriscv_sim::finished(void)
+{
+    return m_tb->m_finished;
+}
+//-----------------------------------------------------------------
+// State access
+//-----------------------------------------------------------------
+uint32_t biriscv_sim::get_reg(int r)
+{
+    return (r > 0 && r < 32) ? m_tb->m_dut->get_register(r) : 0;
+}
+uint32_t biriscv_sim::get_pc(void)
+{
+    return m_tb->m_pc;
+}
+uint32_t biriscv_sim::get_csr(uint32_t addr)
+{
+    return m_tb->m_dut->get_csr(addr);
+}
+bool biriscv_sim::read_mem(uint32_t addr, uint8_t *data, uint32_t len)
+{
+    for (uint32_t i=0;i<len;i++)
+    {
+        if (!m_tb->valid_addr(addr + i))
+            return false;
+        data[i] = m_tb->read(addr + i);
+    }
+    return true;
+}
+bool biriscv_sim::write_mem(uint32_t addr, const uint8_t *data, uint32_t len)
+{
+    return m_tb->write_block(addr, data, len);
+}
+//-----------------------------------------------------------------
+// get_counters: Snapshot of core / interconnect counters
+//-----------------------------------------------------------------
+biriscv_counters biriscv_sim::get_counters(void)
+{
+    biriscv_counters c;
+    memset(&c, 0, sizeof(c));
+
+    c.cycles             = m_tb->m_cycles;
+    c.instret            = m_tb->m_instret;
+    c.dual_retire_cycles = m_tb->m_dual_retire;
+
+    const tb_axi4_ic_stats &i = m_tb->m_interconnect->get_stats(0);
+    const tb_axi4_ic_stats &d = m_tb->m_interconnect->get_stats(1);
+
+    c.icache_rd_bursts      = i.rd_bursts;
+    c.icache_rd_wait_cycles = i.rd_wait_cycles;
+    c.dcache_rd_bursts      = d.rd_bursts;
+    c.dcache_wr_bursts      = d.wr_bursts;
+    c.dcache_rd_wait_cycles = d.rd_wait_cycles;
+    c.dcache_wr_wait_cycles = d.wr_wait_cycles;
+
+    return c;
+}
+
+//-----------------------------------------------------------------
+// C API
+//-----------------------------------------------------------------
+#define SIM(p) ((biriscv_sim*)(p))
+
+void *   biriscv_create(uint32_t ram_size)        { return g_in_use ? NULL : new biriscv_sim(ram_size); }
+void     biriscv_destroy(void *sim)               { delete SIM(sim); }
+int      biriscv_load(void *sim, const char *spec){ return SIM(sim)->load(spec); }
+uint32_t biriscv_entry_point(void *sim)           { return SIM(sim)->get_entry_point(); }
+void     biriscv_clear_memory(void *sim)          { SIM(sim)->clear_memory(); }
+void     biriscv_reset(void *sim, uint32_t pc)    { SIM(sim)->reset(pc); }
+uint64_t biriscv_step(void *sim, uint64_t cycles) { return SIM(sim)->step(cycles); }
+int      biriscv_run_until(void *sim, uint32_t events, uint32_t pc, uint64_t max_cycles)
+{
+    return SIM(sim)->run_until(events, pc, max_cycles);
+}
+uint32_t biriscv_get_reg(void *sim, int r)        { return SIM(sim)->get_reg(r); }
+uint32_t biriscv_get_pc(void *sim)                { return SIM(sim)->get_pc(); }
+uint32_t biriscv_get_csr(void *sim, uint32_t addr){ return SIM(sim)->get_csr(addr); }
+int      biriscv_read_mem(void *sim, uint32_t addr, uint8_t *data, uint32_t len)
+{
+    return SIM(sim)->read_mem(addr, data, len);
+}
+int      biriscv_write_mem(void *sim, uint32_t addr, const uint8_t *data, uint32_t len)
+{
+    return SIM(sim)->write_mem(addr, data, len);
+}
+void     biriscv_get_counters(void *sim, biriscv_counters *counters)
+{
+    *counters = SIM(sim)->get_counters();
+}
+uint32_t     biriscv_abi_version(void)            { return BIRISCV_ABI_VERSION; }
+const char * biriscv_model_name(void)             { return BIRISCV_MODEL_NAME; }
+const char * biriscv_model_params(void)           { return BIRISCV_MODEL_PARAMS; }
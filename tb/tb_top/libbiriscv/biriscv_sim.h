@@ -0,0 +1,113 @@
+#ifndef BIRISCV_SIM_H
+#define BIRISCV_SIM_H
+
+#include <stdint.h>
+
+//-----------------------------------------------------------------
+// Defines
+//-----------------------------------------------------------------
+#define BIRISCV_MEM_BASE        0x80000000
+
+// C API revision (biriscv_abi_version) - bump on any change below
+#define BIRISCV_ABI_VERSION     1
+
+// run_until() events
+#define BIRISCV_EVENT_CYCLES    (1 << 0)
+#define BIRISCV_EVENT_PC        (1 << 1)
+#define BIRISCV_EVENT_FINISH    (1 << 2)
+
+//-----------------------------------------------------------------
+// biriscv_counters: Performance counter snapshot
+//-----------------------------------------------------------------
+typedef struct
+{
+    uint64_t cycles;
+    uint64_t instret;
+    uint64_t dual_retire_cycles;
+
+    uint64_t icache_rd_bursts;
+    uint64_t icache_rd_wait_cycles;
+    uint64_t dcache_rd_bursts;
+    uint64_t dcache_wr_bursts;
+    uint64_t dcache_rd_wait_cycles;
+    uint64_t dcache_wr_wait_cycles;
+} biriscv_counters;
+
+#ifdef __cplusplus
+
+class biriscv_harness;
+
+//-----------------------------------------------------------------
+// biriscv_sim: Embeddable simulation of riscv_top with the tb_top
+// memory and peripheral models (CLINT, UART-Lite, PLIC).
+// SystemC only supports a single elaboration per process, so only
+// one instance may exist; use reset() / clear_memory() to run
+// further experiments.
+//-----------------------------------------------------------------
+class biriscv_sim
+{
+public:
+    biriscv_sim(uint32_t ram_size = 0);
+    ~biriscv_sim();
+
+    // Image loading ('file[@addr]' - ELF, binary, HEX, SREC)
+    bool             load(const char *spec);
+    uint32_t         get_entry_point(void) { return m_entry_point; }
+    void             clear_memory(void);
+
+    // Reset core and peripherals, start execution at pc
+    void             reset(uint32_t pc = BIRISCV_MEM_BASE);
+
+    // Execution - returns the event that stopped the simulation
+    uint64_t         step(uint64_t cycles);
+    int              run_until(uint32_t events, uint32_t pc, uint64_t max_cycles);
+    int              run_until_pc(uint32_t pc, uint64_t max_cycles) { return run_until(BIRISCV_EVENT_PC, pc, max_cycles); }
+    int              run_until_finish(uint64_t max_cycles) { return run_until(BIRISCV_EVENT_FINISH, 0, max_cycles); }
+    bool             finished(void);
+
+    // State access
+    uint32_t         get_reg(int r);
+    uint32_t         get_pc(void);
+    uint32_t         get_csr(uint32_t addr);
+    bool             read_mem(uint32_t addr, uint8_t *data, uint32_t len);
+    bool             write_mem(uint32_t addr, const uint8_t *data, uint32_t len);
+
+    biriscv_counters get_counters(void);
+
+protected:
+    biriscv_harness *m_tb;
+    uint32_t         m_ram_size;
+    uint32_t         m_entry_point;
+};
+
+extern "C" {
+#endif
+
+//-----------------------------------------------------------------
+// C API (Python ctypes bindings, see biriscv.py)
+//-----------------------------------------------------------------
+void *   biriscv_create(uint32_t ram_size);
+void     biriscv_destroy(void *sim);
+int      biriscv_load(void *sim, const char *spec);
+uint32_t biriscv_entry_point(void *sim);
+void     biriscv_clear_memory(void *sim);
+void     biriscv_reset(void *sim, uint32_t pc);
+uint64_t biriscv_step(void *sim, uint64_t cycles);
+int      biriscv_run_until(void *sim, uint32_t events, uint32_t pc, uint64_t max_cycles);
+uint32_t biriscv_get_reg(void *sim, int r);
+uint32_t biriscv_get_pc(void *sim);
+uint32_t biriscv_get_csr(void *sim, uint32_t addr);
+int      biriscv_read_mem(void *sim, uint32_t addr, uint8_t *data, uint32_t len);
+int      biriscv_write_mem(void *sim, uint32_t addr, const uint8_t *data, uint32_t len);
+void     biriscv_get_counters(void *sim, biriscv_counters *counters);
+
+// Model variant identification (libbiriscv_<name>.so)
+uint32_t     biriscv_abi_version(void);
+const char * biriscv_model_name(void);
+const char * biriscv_model_params(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -54,6 +54,15 @@ static void assert_handler(const sc_report& rep, const sc_actions& actions)
 //--------------------------------------------------------------------
 static void exit_override(void)
 {
+    static bool reported = false;
+
+    // Final statistics (once, also reached via SIGINT)
+    if (tb && !reported)
+    {
+        reported = true;
+        tb->report();
+    }
+
     if (tb)
         tb->abort();
 }
@@ -62,6 +71,10 @@ static void exit_override(void)
 //--------------------------------------------------------------------
 void vl_finish (const char* filename, int linenum, const char* hier)
 { 
+    // Daemon mode: end the job, keep the model
+    if (tb && tb->finish_hook())
+        return;
+
     std::cout << "\033[32m\nExit success!\n\033[0m \n"
         << "Filename is\t" << filename 
         << "\tlinenum is:\t" << linenum 
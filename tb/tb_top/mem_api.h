@@ -13,6 +13,18 @@ public:
     virtual bool    valid_addr(uint32_t addr) = 0;
     virtual void    write(uint32_t addr, uint8_t data) = 0;
     virtual uint8_t read(uint32_t addr) = 0;
+
+    // Bulk copy (image loading) - targets may override with a memcpy
+    virtual bool    write_block(uint32_t addr, const uint8_t *data, uint32_t size)
+    {
+        for (uint32_t i=0;i<size;i++)
+        {
+            if (!valid_addr(addr + i))
+                return false;
+            write(addr + i, data[i]);
+        }
+        return true;
+    }
 };
 
 #endif
\ No newline at end of file
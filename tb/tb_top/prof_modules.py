@@ -0,0 +1,122 @@
+#!/usr/bin/env python3
+###############################################################################
+# prof_modules.py: Rank host simulation time by RTL module / source line
+#
+# Input is a gprof flat profile or 'perf report --stdio --no-children -g none'
+# of a model verilated with --prof-cfuncs, where each C++ function is
+# suffixed with __PROF__<module>__l<line>.
+#
+#   gprof build_prof/test.x gmon.out > gprof.txt
+#   ./prof_modules.py gprof.txt -s ../../src/core -s ../../src/dcache
+###############################################################################
+import argparse
+import os
+import re
+import sys
+
+RE_PROF  = re.compile(r'__PROF__([A-Za-z0-9_]+?)__l?(\d+)')
+RE_GPROF = re.compile(r'^\s*([\d.]+)\s+[\d.]+\s+[\d.]+\s+(?:\d+\s+[\d.]+\s+[\d.]+\s+)?(\S.*)$')
+RE_PERF  = re.compile(r'^\s*([\d.]+)%\s+\S+\s+\S+\s+\[.\]\s+(\S.*)$')
+
+###############################################################################
+# classify: Symbol -> (module, line)
+###############################################################################
+def classify(symbol, top):
+    m = RE_PROF.search(symbol)
+    if m:
+        return m.group(1), int(m.group(2))
+
+    # Per-module class without --prof-cfuncs (not inlined)
+    m = re.match(r'V%s_([A-Za-z0-9_]+)::' % re.escape(top), symbol)
+    if m and not m.group(1).startswith('_'):
+        return m.group(1), None
+
+    if symbol.startswith('V%s' % top):
+        return '(top, inlined)', None
+    if 'Verilated' in symbol or symbol.startswith('VL_') or 'vl_' in symbol:
+        return '(verilator runtime)', None
+    if 'sc_core::' in symbol or 'sc_dt::' in symbol:
+        return '(systemc)', None
+    return '(testbench / other)', None
+
+###############################################################################
+# parse: Profile file -> [(percent, symbol)]
+###############################################################################
+def parse(filename):
+    samples = []
+    with open(filename) as f:
+        for line in f:
+            m = RE_PERF.match(line) or RE_GPROF.match(line)
+            if m:
+                samples.append((float(m.group(1)), m.group(2).strip()))
+            # gprof: flat profile ends at the call graph
+            elif line.startswith('Call graph') or 'Call graph (explanation follows)' in line:
+                break
+    return samples
+
+###############################################################################
+# source_line: Verilog source text for module:line
+###############################################################################
+def source_line(dirs, module, line, cache={}):
+    if module not in cache:
+        cache[module] = None
+        for d in dirs:
+            path = os.path.join(d, module + '.v')
+            if os.path.exists(path):
+                with open(path) as f:
+                    cache[module] = f.read().splitlines()
+                break
+
+    text = cache[module]
+    if text and 0 < line <= len(text):
+        return text[line-1].strip()
+    return ''
+
+###############################################################################
+# main
+###############################################################################
+def main():
+    parser = argparse.ArgumentParser(description='Rank simulation time by RTL module')
+    parser.add_argument('profile', help='gprof flat profile or perf report --stdio output')
+    parser.add_argument('-t', '--top', default='riscv_top', help='Verilated top name (default riscv_top)')
+    parser.add_argument('-s', '--src', action='append', default=[], help='Verilog source directory (repeatable)')
+    parser.add_argument('-n', '--lines', type=int, default=5, help='Hottest source lines per module (default 5)')
+    args = parser.parse_args()
+
+    samples = parse(args.profile)
+    if not samples:
+        sys.stderr.write('ERROR: No profile entries found in %s\n' % args.profile)
+        return 1
+
+    modules = {}
+    lines   = {}
+    total   = 0.0
+    for pct, symbol in samples:
+        module, line = classify(symbol, args.top)
+        modules[module] = modules.get(module, 0.0) + pct
+        if line is not None:
+            key = (module, line)
+            lines[key] = lines.get(key, 0.0) + pct
+        total += pct
+
+    if not lines:
+        sys.stderr.write('WARNING: No __PROF__ symbols - was the model verilated with --prof-cfuncs?\n')
+
+    print('%-28s %8s' % ('Module', 'Time %'))
+    for module, pct in sorted(modules.items(), key=lambda x: -x[1]):
+        print('%-28s %7.2f%%' % (module, pct))
+    print('%-28s %7.2f%%' % ('Total', total))
+
+    for module, _ in sorted(modules.items(), key=lambda x: -x[1]):
+        hot = sorted([(pct, line) for (m, line), pct in lines.items() if m == module], reverse=True)
+        if not hot:
+            continue
+
+        print('\n%s:' % module)
+        for pct, line in hot[:args.lines]:
+            print('  l%-6d %7.2f%%  %s' % (line, pct, source_line(args.src, module, line)[:80]))
+
+    return 0
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -1,16 +1,43 @@
 
 #include "riscv_top.h"
+#include "tb_timeline.h"
 #include "Vriscv_top.h"
+#include "Vriscv_top_riscv_top.h"
+#include "Vriscv_top_riscv_core.h"
+#include "Vriscv_top_biriscv_frontend.h"
+#include "Vriscv_top_biriscv_fetch.h"
+#include "Vriscv_top_biriscv_issue.h"
+#include "Vriscv_top_biriscv_csr.h"
+#include "Vriscv_top_biriscv_csr_regfile.h"
+#include "Vriscv_top_dcache.h"
+#include "Vriscv_top_dcache_core.h"
+#include "Vriscv_top_dcache_core_tag_ram.h"
+#include "Vriscv_top_dcache_core_data_ram.h"
+#include "Vriscv_top_icache.h"
+#include "Vriscv_top_icache_tag_ram.h"
 
 #if VM_TRACE
 #include "verilated.h"
 #include "verilated_vcd_c.h"
 #endif
 
+//-------------------------------------------------------------
+// Locals
+//-------------------------------------------------------------
+static const char *stall_names[] = { "memory", "serial", "operand", "frontend" };
+
 //-------------------------------------------------------------
 // Constructor
 //-------------------------------------------------------------
 riscv_top::riscv_top(sc_module_name name): sc_module(name)
+    , m_stat_cycles(sc_module::name(), "cycles", "Sampled cycles")
+    , m_stat_issue(sc_module::name(), "issue_cycles", "Cycles issuing at least one instruction")
+    , m_stat_dual_issue(sc_module::name(), "dual_issue_cycles", "Cycles issuing two instructions")
+    , m_stat_mispredicts(sc_module::name(), "mispredicts", "Branch mispredictions")
+    , m_stat_stalls(sc_module::name(), "stall_cycles", 4, stall_names, "Cycles without issue, by cause")
+    , m_stat_ipc(sc_module::name(), "issue_per_cycle",
+                 [this]() -> double { return m_stat_cycles ? (double)(m_stat_issue + m_stat_dual_issue) / m_stat_cycles : 0.0; },
+                 "Issued instructions per cycle")
 {
     m_rtl = new Vriscv_top("Vriscv_top");
     m_rtl->clk_i(m_clk_in);
@@ -137,6 +164,242 @@ void riscv_top::trace_enable(VerilatedVcdC *p, sc_core::sc_time start_time)
 #endif
 }
 //-------------------------------------------------------------
+// get_retire: Instruction retired this cycle on issue slot 0/1
+//-------------------------------------------------------------
+bool riscv_top::get_retire(int slot, uint32_t &pc, uint32_t &opcode, uint32_t &result)
+{
+    Vriscv_top_biriscv_issue *issue = m_rtl->v->u_core->u_issue;
+
+    if (slot == 0)
+    {
+        if (!issue->complete_valid0())
+            return false;
+
+        pc     = issue->complete_pc0();
+        opcode = issue->complete_opcode0();
+        result = issue->complete_rd_val0();
+    }
+    else
+    {
+        if (!issue->complete_valid1())
+            return false;
+
+        pc     = issue->complete_pc1();
+        opcode = issue->complete_opcode1();
+        result = issue->complete_rd_val1();
+    }
+
+    return true;
+}
+//-------------------------------------------------------------
+// get_retire_operands: Source operand values of retired instruction
+//-------------------------------------------------------------
+void riscv_top::get_retire_operands(int slot, uint32_t &ra, uint32_t &rb)
+{
+    Vriscv_top_biriscv_issue *issue = m_rtl->v->u_core->u_issue;
+
+    ra = slot ? issue->complete_ra_val1() : issue->complete_ra_val0();
+    rb = slot ? issue->complete_rb_val1() : issue->complete_rb_val0();
+}
+//-------------------------------------------------------------
+// get_retire_rd: Destination register of retired instruction (0 if
+// it does not write one)
+//-------------------------------------------------------------
+int riscv_top::get_retire_rd(int slot)
+{
+    Vriscv_top_biriscv_issue *issue = m_rtl->v->u_core->u_issue;
+
+    return slot ? issue->complete_rd1() : issue->complete_rd0();
+}
+//-------------------------------------------------------------
+// get_register: Architectural register file (x0-x31)
+//-------------------------------------------------------------
+uint32_t riscv_top::get_register(int r)
+{
+    return r ? m_rtl->v->u_core->u_issue->get_register(r) : 0;
+}
+//-------------------------------------------------------------
+// get_csr: Read CSR
+//-------------------------------------------------------------
+uint32_t riscv_top::get_csr(uint32_t addr)
+{
+    return m_rtl->v->u_core->u_csr->u_csrfile->get_csr(addr);
+}
+//-------------------------------------------------------------
+// get_mcycle: Core cycle counter (also mtime)
+//-------------------------------------------------------------
+uint32_t riscv_top::get_mcycle(void)
+{
+    return m_rtl->v->u_core->u_csr->u_csrfile->get_mcycle();
+}
+//-------------------------------------------------------------
+// get_pipe_state: Fetch / decode / issue / stage snapshot
+//-------------------------------------------------------------
+void riscv_top::get_pipe_state(tb_pipe_state &s)
+{
+    Vriscv_top_biriscv_fetch *fetch = m_rtl->v->u_core->u_frontend->u_fetch;
+    Vriscv_top_biriscv_issue *issue = m_rtl->v->u_core->u_issue;
+
+    s.fetch_valid = fetch->pipeview_fetch_valid();
+    s.fetch_pc    = fetch->pipeview_fetch_pc();
+
+    for (int i=0;i<2;i++)
+    {
+        s.decode_valid[i]  = issue->pipeview_decode_valid(i);
+        s.decode_pc[i]     = issue->pipeview_decode_pc(i);
+        s.decode_opcode[i] = issue->pipeview_decode_opcode(i);
+    }
+
+    for (int p=0;p<TB_PIPEVIEW_PIPES;p++)
+    {
+        s.issue_valid[p] = issue->pipeview_issue_valid(p);
+        s.issue_pc[p]    = issue->pipeview_issue_pc(p);
+
+        for (int st=0;st<TB_PIPEVIEW_STAGES;st++)
+        {
+            s.stage_valid[p][st] = issue->pipeview_stage_valid(p, st);
+            s.stage_pc[p][st]    = issue->pipeview_stage_pc(p, st);
+        }
+    }
+
+    s.stall = issue->pipeview_stall();
+}
+//-------------------------------------------------------------
+// get_pairing: Dual issue this cycle, else reason slot B did not pair
+//-------------------------------------------------------------
+int riscv_top::get_pairing(bool &dual, uint32_t &pc, uint32_t &opcode_a, uint32_t &opcode_b)
+{
+    Vriscv_top_biriscv_issue *issue = m_rtl->v->u_core->u_issue;
+
+    dual     = issue->pipeview_issue_valid(1);
+    pc       = issue->pairing_pc();
+    opcode_a = issue->pairing_opcode(0);
+    opcode_b = issue->pairing_opcode(1);
+    return issue->pairing_reason();
+}
+//-------------------------------------------------------------
+// get_perf_events: Issue / stall event flags this cycle (TB_EVENT_*)
+//-------------------------------------------------------------
+uint32_t riscv_top::get_perf_events(void)
+{
+    return m_rtl->v->u_core->u_issue->perf_events();
+}
+//-------------------------------------------------------------
+// update_stats: Accumulate this cycle's perf events
+//-------------------------------------------------------------
+void riscv_top::update_stats(void)
+{
+    uint32_t events = get_perf_events();
+
+    m_stat_cycles++;
+    if (events & TB_EVENT_ISSUE_A)
+        m_stat_issue++;
+    if (events & TB_EVENT_ISSUE_B)
+        m_stat_dual_issue++;
+    if (events & TB_EVENT_MISPREDICT)
+        m_stat_mispredicts++;
+
+    // Same attribution as tb_timeline
+    if (!(events & TB_EVENT_ISSUE_A))
+    {
+        if (events & TB_EVENT_LSU_STALL)
+            m_stat_stalls[0]++;
+        else if (events & TB_EVENT_SERIAL)
+            m_stat_stalls[1]++;
+        else if (events & TB_EVENT_OPERAND)
+            m_stat_stalls[2]++;
+        else
+            m_stat_stalls[3]++;
+    }
+}
+//-------------------------------------------------------------
+// get_sim_marker: SIM_CTRL marker written last cycle
+//-------------------------------------------------------------
+bool riscv_top::get_sim_marker(uint32_t &id)
+{
+    uint32_t m = m_rtl->v->u_core->u_csr->u_csrfile->get_sim_marker();
+    id = m & 0xFFFFFF;
+    return (m >> 24) & 1;
+}
+//-------------------------------------------------------------
+// get_mtimecmp: Internal timer compare value (false if disarmed)
+//-------------------------------------------------------------
+bool riscv_top::get_mtimecmp(uint32_t &value)
+{
+    Vriscv_top_biriscv_csr_regfile *csr = m_rtl->v->u_core->u_csr->u_csrfile;
+
+    value = csr->get_mtimecmp();
+    return csr->get_mtime_ie();
+}
+//-------------------------------------------------------------
+// get_dcache_dirty: Dirty data cache line (address + words), false
+// if the line is invalid or clean
+//-------------------------------------------------------------
+bool riscv_top::get_dcache_dirty(int way, int line, uint32_t &addr, uint32_t *data)
+{
+    Vriscv_top_dcache_core *dcache = m_rtl->v->u_dcache->u_core;
+
+    // Tag: [20] valid, [19] dirty, [18:0] address[31:13]
+    uint32_t tag = way ? dcache->u_tag1->ram[line] : dcache->u_tag0->ram[line];
+    if (!((tag >> 20) & 1) || !((tag >> 19) & 1))
+        return false;
+
+    addr = ((tag & 0x7FFFF) << 13) | (line << 5);
+
+    Vriscv_top_dcache_core_data_ram *ram = way ? dcache->u_data1 : dcache->u_data0;
+    for (int i=0;i<RISCV_DCACHE_LINE_WORDS;i++)
+        data[i] = ram->ram[line * RISCV_DCACHE_LINE_WORDS + i];
+
+    return true;
+}
+//-------------------------------------------------------------
+// write_cached: Debugger store - update a data cache line holding
+// addr (the caller writes memory too) and drop any instruction
+// cache line holding it
+//-------------------------------------------------------------
+void riscv_top::write_cached(uint32_t addr, uint8_t data)
+{
+    Vriscv_top_dcache_core *dcache = m_rtl->v->u_dcache->u_core;
+    uint32_t line = (addr >> 5) & (RISCV_DCACHE_LINES - 1);
+
+    // Tag: [20] valid, [19] dirty, [18:0] address[31:13]
+    for (int way=0;way<RISCV_DCACHE_WAYS;way++)
+    {
+        uint32_t tag = way ? dcache->u_tag1->ram[line] : dcache->u_tag0->ram[line];
+        if (!((tag >> 20) & 1) || (tag & 0x7FFFF) != (addr >> 13))
+            continue;
+
+        Vriscv_top_dcache_core_data_ram *ram = way ? dcache->u_data1 : dcache->u_data0;
+        uint32_t &word = ram->ram[line * RISCV_DCACHE_LINE_WORDS + ((addr >> 2) & (RISCV_DCACHE_LINE_WORDS - 1))];
+        int      shift = (addr & 3) * 8;
+        word = (word & ~(0xFFu << shift)) | ((uint32_t)data << shift);
+    }
+
+    // Tag: [19] valid, [18:0] address[31:13]
+    Vriscv_top_icache *icache = m_rtl->v->u_icache;
+    line = (addr >> 5) & (RISCV_ICACHE_LINES - 1);
+    for (int way=0;way<RISCV_ICACHE_WAYS;way++)
+    {
+        uint32_t &tag = way ? icache->u_tag1->ram[line] : icache->u_tag0->ram[line];
+        if (((tag >> 19) & 1) && (tag & 0x7FFFF) == (addr >> 13))
+            tag = 0;
+    }
+}
+//-------------------------------------------------------------
+// skip_cycles: Advance cycle counter without clocking the core
+//-------------------------------------------------------------
+void riscv_top::skip_cycles(uint32_t cycles)
+{
+    m_rtl->v->u_core->u_csr->u_csrfile->skip_mcycle(cycles);
+}
+//-------------------------------------------------------------
+// set_single_issue: Disable dual issue (at most one retire per cycle)
+//-------------------------------------------------------------
+void riscv_top::set_single_issue(bool enable)
+{
+    m_rtl->v->u_core->u_issue->set_single_issue(enable);
+}
+//-------------------------------------------------------------
 // async_outputs
 //-------------------------------------------------------------
 void riscv_top::async_outputs(void)
@@ -5,10 +5,24 @@
 
 #include "axi4.h"
 #include "axi4.h"
+#include "tb_pipeview.h"
+#include "tb_stats.h"
 
 class Vriscv_top;
 class VerilatedVcdC;
 
+//-------------------------------------------------------------
+// Defines
+//-------------------------------------------------------------
+// Data cache geometry (src/dcache/dcache_core.v)
+#define RISCV_DCACHE_WAYS       2
+#define RISCV_DCACHE_LINES      256
+#define RISCV_DCACHE_LINE_WORDS 8
+
+// Instruction cache geometry (src/icache/icache.v)
+#define RISCV_ICACHE_WAYS       2
+#define RISCV_ICACHE_LINES      256
+
 //-------------------------------------------------------------
 // riscv_top: RTL wrapper class
 //-------------------------------------------------------------
@@ -56,6 +70,30 @@ public:
     void trace_enable(VerilatedVcdC *p);
     void trace_enable(VerilatedVcdC *p, sc_core::sc_time start_time);
 
+    //-------------------------------------------------------------
+    // Core state (idle skipping / debug)
+    //-------------------------------------------------------------
+    bool     get_retire(int slot, uint32_t &pc, uint32_t &opcode, uint32_t &result);
+    void     get_retire_operands(int slot, uint32_t &ra, uint32_t &rb);
+    int      get_retire_rd(int slot);
+    uint32_t get_register(int r);
+    uint32_t get_csr(uint32_t addr);
+    uint32_t get_mcycle(void);
+    bool     get_mtimecmp(uint32_t &value);
+    void     skip_cycles(uint32_t cycles);
+    void     set_single_issue(bool enable);
+    void     get_pipe_state(tb_pipe_state &s);
+    int      get_pairing(bool &dual, uint32_t &pc, uint32_t &opcode_a, uint32_t &opcode_b);
+    uint32_t get_perf_events(void);
+    bool     get_sim_marker(uint32_t &id);
+    bool     get_dcache_dirty(int way, int line, uint32_t &addr, uint32_t *data);
+    void     write_cached(uint32_t addr, uint8_t data);
+
+    //-------------------------------------------------------------
+    // Statistics (tb_stats.h): call update_stats() once per cycle
+    //-------------------------------------------------------------
+    void     update_stats(void);
+
     //-------------------------------------------------------------
     // Signals
     //-------------------------------------------------------------
@@ -122,6 +160,13 @@ private:
 
 public:
     Vriscv_top *m_rtl;
+
+    tb_stat_scalar   m_stat_cycles;
+    tb_stat_scalar   m_stat_issue;
+    tb_stat_scalar   m_stat_dual_issue;
+    tb_stat_scalar   m_stat_mispredicts;
+    tb_stat_vector   m_stat_stalls;
+    tb_stat_formula  m_stat_ipc;
 #if VM_TRACE
     VerilatedVcdC  * m_vcd;
     bool             m_delay_waves;
@@ -0,0 +1,499 @@
+#include "tb_axi4_interconnect.h"
+
+//-----------------------------------------------------------------
+// process: Arbitrate upstream requests onto the shared port
+//-----------------------------------------------------------------
+void tb_axi4_interconnect::process(void)
+{
+    while (1)
+    {
+        axi4_master mem_o = mem_out.read();
+        axi4_slave  mem_i = mem_in.read();
+
+        //-------------------------------------------------------------
+        // Upstream ports
+        //-------------------------------------------------------------
+        for (int p=0;p<m_num_ports;p++)
+        {
+            port_state &port = m_port[p];
+            axi4_master axi_i = axi_in[p].read();
+            axi4_slave  axi_o = axi_out[p].read();
+
+            // Read command
+            if (axi_i.ARVALID && axi_o.ARREADY)
+            {
+                sc_assert(valid_id(p, axi_i.ARID));
+                port.ar_q.push_back(tb_axi4_ic_cmd(axi_i.ARADDR, axi_i.ARID, axi_i.ARLEN, axi_i.ARBURST, m_cycle));
+
+                if (m_trace)
+                    m_trace->record(m_cycle, p, axi_i.ARID, axi_i.ARADDR, axi_i.ARLEN, axi_i.ARBURST, false, 0);
+            }
+
+            // Write command
+            if (axi_i.AWVALID && axi_o.AWREADY)
+            {
+                sc_assert(valid_id(p, axi_i.AWID));
+                port.aw_q.push_back(tb_axi4_ic_cmd(axi_i.AWADDR, axi_i.AWID, axi_i.AWLEN, axi_i.AWBURST, m_cycle));
+
+                if (m_trace)
+                    port.trace_aw.push_back(port.aw_q.back());
+            }
+
+            // Write data
+            if (axi_i.WVALID && axi_o.WREADY)
+            {
+                port.w_q.push_back(axi_i);
+
+                if (m_trace)
+                {
+                    port.trace_strb |= (uint8_t)axi_i.WSTRB;
+                    if (axi_i.WLAST)
+                    {
+                        port.trace_w.push_back(port.trace_strb);
+                        port.trace_strb = 0;
+                    }
+                }
+            }
+
+            if (m_trace)
+                trace_write(p);
+
+            // Read response
+            if (axi_o.RVALID && axi_i.RREADY)
+            {
+                axi_o.RVALID = false;
+                axi_o.RDATA  = 0;
+                axi_o.RID    = 0;
+                axi_o.RRESP  = 0;
+                axi_o.RLAST  = false;
+            }
+
+            if (!axi_o.RVALID && port.r_q.size() > 0)
+            {
+                axi4_slave item = port.r_q.front();
+                port.r_q.pop_front();
+
+                axi_o.RVALID = true;
+                axi_o.RDATA  = item.RDATA;
+                axi_o.RID    = item.RID;
+                axi_o.RLAST  = item.RLAST;
+                axi_o.RRESP  = item.RRESP;
+            }
+
+            // Write response
+            if (axi_o.BVALID && axi_i.BREADY)
+            {
+                axi_o.BVALID = false;
+                axi_o.BID    = 0;
+                axi_o.BRESP  = 0;
+            }
+
+            if (!axi_o.BVALID && port.b_q.size() > 0)
+            {
+                axi4_slave item = port.b_q.front();
+                port.b_q.pop_front();
+
+                axi_o.BVALID = true;
+                axi_o.BID    = item.BID;
+                axi_o.BRESP  = item.BRESP;
+            }
+
+            axi_o.ARREADY = port.ar_q.size() < TB_AXI4_IC_QUEUE_DEPTH;
+            axi_o.AWREADY = port.aw_q.size() < TB_AXI4_IC_QUEUE_DEPTH;
+            axi_o.WREADY  = port.w_q.size()  < TB_AXI4_IC_QUEUE_DEPTH;
+
+            axi_out[p].write(axi_o);
+        }
+
+        //-------------------------------------------------------------
+        // Downstream port: handshakes
+        //-------------------------------------------------------------
+        if (mem_o.ARVALID && mem_i.ARREADY)
+            mem_o.ARVALID = false;
+
+        if (mem_o.AWVALID && mem_i.AWREADY)
+            mem_o.AWVALID = false;
+
+        if (mem_o.WVALID && mem_i.WREADY)
+            mem_o.WVALID = false;
+
+        // Read data: route back using downstream ID
+        if (mem_i.RVALID && mem_o.RREADY)
+        {
+            uint32_t    rid  = (uint32_t)mem_i.RID;
+            port_state &port = m_port[rid & ((1 << m_port_bits) - 1)];
+            uint32_t    id   = rid >> m_port_bits;
+            sc_assert(port.rd_issued.count(id));
+
+            std::deque <tb_axi4_ic_cmd> &issued = port.rd_issued[id];
+            tb_axi4_ic_cmd cmd = issued.front();
+
+            axi4_slave item;
+            item.RDATA = mem_i.RDATA;
+            item.RRESP = mem_i.RRESP;
+            item.RLAST = mem_i.RLAST;
+            item.RID   = cmd.m_id;
+            port.r_q.push_back(item);
+
+            port.stats.rd_beats++;
+
+            if (mem_i.RLAST)
+            {
+                port.stats.rd_latency_cycles += m_cycle - cmd.m_accept_cycle;
+                port.rd_latency->sample(m_cycle - cmd.m_accept_cycle);
+
+                issued.pop_front();
+                if (issued.empty())
+                    port.rd_issued.erase(id);
+            }
+        }
+
+        // Write response
+        if (mem_i.BVALID && mem_o.BREADY)
+        {
+            uint32_t    bid  = (uint32_t)mem_i.BID;
+            port_state &port = m_port[bid & ((1 << m_port_bits) - 1)];
+            uint32_t    id   = bid >> m_port_bits;
+            sc_assert(port.wr_issued.count(id));
+
+            std::deque <tb_axi4_ic_cmd> &issued = port.wr_issued[id];
+            tb_axi4_ic_cmd cmd = issued.front();
+
+            axi4_slave item;
+            item.BRESP = mem_i.BRESP;
+            item.BID   = cmd.m_id;
+            port.b_q.push_back(item);
+
+            port.stats.wr_latency_cycles += m_cycle - cmd.m_accept_cycle;
+
+            issued.pop_front();
+            if (issued.empty())
+                port.wr_issued.erase(id);
+        }
+
+        //-------------------------------------------------------------
+        // Downstream port: arbitration
+        //-------------------------------------------------------------
+        if (!mem_o.ARVALID)
+        {
+            uint32_t req_mask = 0;
+            for (int p=0;p<m_num_ports;p++)
+                if (m_port[p].ar_q.size() > 0)
+                    req_mask |= 1 << p;
+
+            int p = arbitrate(req_mask, m_rr_ar);
+            if (p >= 0)
+            {
+                port_state &port   = m_port[p];
+                tb_axi4_ic_cmd cmd = port.ar_q.front();
+                port.ar_q.pop_front();
+
+                mem_o.ARVALID = true;
+                mem_o.ARADDR  = cmd.m_addr;
+                mem_o.ARID    = (cmd.m_id << m_port_bits) | p;
+                mem_o.ARLEN   = cmd.m_len;
+                mem_o.ARBURST = cmd.m_burst;
+
+                uint64_t wait = m_cycle - cmd.m_accept_cycle;
+                port.stats.rd_bursts++;
+                port.stats.rd_wait_cycles += wait;
+                if (wait > port.stats.rd_wait_max)
+                    port.stats.rd_wait_max = wait;
+
+                port.rd_issued[cmd.m_id].push_back(cmd);
+            }
+        }
+
+        if (!mem_o.AWVALID && m_w_route.size() < TB_AXI4_IC_QUEUE_DEPTH)
+        {
+            uint32_t req_mask = 0;
+            for (int p=0;p<m_num_ports;p++)
+                if (m_port[p].aw_q.size() > 0)
+                    req_mask |= 1 << p;
+
+            int p = arbitrate(req_mask, m_rr_aw);
+            if (p >= 0)
+            {
+                port_state &port   = m_port[p];
+                tb_axi4_ic_cmd cmd = port.aw_q.front();
+                port.aw_q.pop_front();
+
+                mem_o.AWVALID = true;
+                mem_o.AWADDR  = cmd.m_addr;
+                mem_o.AWID    = (cmd.m_id << m_port_bits) | p;
+                mem_o.AWLEN   = cmd.m_len;
+                mem_o.AWBURST = cmd.m_burst;
+
+                uint64_t wait = m_cycle - cmd.m_accept_cycle;
+                port.stats.wr_bursts++;
+                port.stats.wr_wait_cycles += wait;
+                if (wait > port.stats.wr_wait_max)
+                    port.stats.wr_wait_max = wait;
+
+                port.wr_issued[cmd.m_id].push_back(cmd);
+                m_w_route.push_back(p);
+            }
+        }
+
+        // Write data follows the order of granted commands
+        if (!mem_o.WVALID && m_w_route.size() > 0 && m_port[m_w_route.front()].w_q.size() > 0)
+        {
+            port_state &port = m_port[m_w_route.front()];
+            axi4_master item = port.w_q.front();
+            port.w_q.pop_front();
+
+            mem_o.WVALID = true;
+            mem_o.WDATA  = item.WDATA;
+            mem_o.WSTRB  = item.WSTRB;
+            mem_o.WLAST  = item.WLAST;
+
+            port.stats.wr_beats++;
+
+            if (item.WLAST)
+                m_w_route.pop_front();
+        }
+
+        // Accept responses only when every port can take one
+        bool r_space = true;
+        bool b_space = true;
+        for (int p=0;p<m_num_ports;p++)
+        {
+            r_space &= m_port[p].r_q.size() < TB_AXI4_IC_QUEUE_DEPTH;
+            b_space &= m_port[p].b_q.size() < TB_AXI4_IC_QUEUE_DEPTH;
+        }
+
+        mem_o.RREADY = r_space;
+        mem_o.BREADY = b_space;
+
+        mem_out.write(mem_o);
+
+        m_cycle++;
+        wait();
+    }
+}
+//-----------------------------------------------------------------
+// valid_id: Upstream ID fits beside the port index downstream
+//-----------------------------------------------------------------
+bool tb_axi4_interconnect::valid_id(int port, uint32_t id)
+{
+    if ((id >> (AXI4_ID_W - m_port_bits)) == 0)
+        return true;
+
+    fprintf(stderr, "ERROR: %s: %s ID %u exceeds %d bits\n", name(), m_port[port].name.c_str(),
+            id, AXI4_ID_W - m_port_bits);
+    return false;
+}
+//-----------------------------------------------------------------
+// arbitrate: Select a requesting port (or -1)
+//-----------------------------------------------------------------
+int tb_axi4_interconnect::arbitrate(uint32_t req_mask, int &rr_ptr)
+{
+    if (!req_mask)
+        return -1;
+
+    int grant = -1;
+
+    switch (m_arb)
+    {
+        case TB_AXI4_IC_ARB_FIXED:
+        {
+            // Lowest port index wins
+            for (int p=0;p<m_num_ports && grant < 0;p++)
+                if (req_mask & (1 << p))
+                    grant = p;
+            break;
+        }
+        case TB_AXI4_IC_ARB_QOS:
+        {
+            // Highest QoS level wins, ties are broken round-robin
+            int best_qos = -1;
+            for (int p=0;p<m_num_ports;p++)
+                if ((req_mask & (1 << p)) && m_port[p].qos > best_qos)
+                    best_qos = m_port[p].qos;
+
+            for (int p=0;p<m_num_ports;p++)
+                if ((req_mask & (1 << p)) && m_port[p].qos != best_qos)
+                    req_mask &= ~(1 << p);
+        }
+        // Fall through
+        case TB_AXI4_IC_ARB_ROUND_ROBIN:
+        default:
+        {
+            for (int i=1;i<=m_num_ports && grant < 0;i++)
+            {
+                int p = (rr_ptr + i) % m_num_ports;
+                if (req_mask & (1 << p))
+                    grant = p;
+            }
+            rr_ptr = grant;
+            break;
+        }
+    }
+
+    return grant;
+}
+//-----------------------------------------------------------------
+// print_stats: Per-port queueing delay and bandwidth
+//-----------------------------------------------------------------
+void tb_axi4_interconnect::print_stats(void)
+{
+    static const char *arb_names[] = { "round-robin", "fixed", "qos" };
+
+    uint64_t elapsed = m_cycle - m_stats_start;
+
+    printf("Interconnect: %s arbitration, %lu cycles\n", arb_names[m_arb], (unsigned long)elapsed);
+
+    for (int p=0;p<m_num_ports;p++)
+    {
+        tb_axi4_ic_stats &s = m_port[p].stats;
+        double cycles = elapsed ? (double)elapsed : 1.0;
+
+        printf("  %-8s rd: %8lu bursts %9lu beats  wait avg %6.2f max %4lu  latency avg %6.2f  bw %5.3f B/cycle\n",
+               m_port[p].name.c_str(),
+               (unsigned long)s.rd_bursts, (unsigned long)s.rd_beats,
+               s.rd_bursts ? (double)s.rd_wait_cycles / s.rd_bursts : 0.0,
+               (unsigned long)s.rd_wait_max,
+               s.rd_bursts ? (double)s.rd_latency_cycles / s.rd_bursts : 0.0,
+               (s.rd_beats * (AXI4_DATA_W/8)) / cycles);
+        printf("  %-8s wr: %8lu bursts %9lu beats  wait avg %6.2f max %4lu  latency avg %6.2f  bw %5.3f B/cycle\n",
+               "",
+               (unsigned long)s.wr_bursts, (unsigned long)s.wr_beats,
+               s.wr_bursts ? (double)s.wr_wait_cycles / s.wr_bursts : 0.0,
+               (unsigned long)s.wr_wait_max,
+               s.wr_bursts ? (double)s.wr_latency_cycles / s.wr_bursts : 0.0,
+               (s.wr_beats * (AXI4_DATA_W/8)) / cycles);
+    }
+}
+//-----------------------------------------------------------------
+// reset_stats: Restart port counters (tb_stats::reset hook). The
+// cycle count keeps running for in-flight latency accounting.
+//-----------------------------------------------------------------
+void tb_axi4_interconnect::reset_stats(void)
+{
+    for (int p=0;p<m_num_ports;p++)
+        m_port[p].stats = tb_axi4_ic_stats();
+
+    m_stats_start = m_cycle;
+}
+//-----------------------------------------------------------------
+// register_stats: Publish port counters under <module>.<port name>
+//-----------------------------------------------------------------
+void tb_axi4_interconnect::register_stats(int port)
+{
+    port_state &ps = m_port[port];
+
+    for (size_t i=0;i<ps.registered.size();i++)
+        delete ps.registered[i];
+    ps.registered.clear();
+
+    std::string          group = std::string(name()) + "." + ps.name;
+    tb_axi4_ic_stats    *s     = &ps.stats;
+    uint64_t            *cycle = &m_cycle;
+    uint64_t            *start = &m_stats_start;
+
+    #define IC_STAT(n, expr, desc) \
+        ps.registered.push_back(new tb_stat_formula(group, n, [s, cycle, start]() -> double { return (expr); }, desc))
+
+    IC_STAT("rd_bursts",      (double)s->rd_bursts, "Read bursts");
+    IC_STAT("rd_beats",       (double)s->rd_beats, "Read beats");
+    IC_STAT("rd_wait_avg",    s->rd_bursts ? (double)s->rd_wait_cycles / s->rd_bursts : 0.0, "Read arbitration wait (cycles)");
+    IC_STAT("rd_wait_max",    (double)s->rd_wait_max, "Read arbitration wait max (cycles)");
+    IC_STAT("rd_latency_avg", s->rd_bursts ? (double)s->rd_latency_cycles / s->rd_bursts : 0.0, "Read command to last beat (cycles)");
+    IC_STAT("rd_bandwidth",   (*cycle - *start) ? (double)(s->rd_beats * (AXI4_DATA_W/8)) / (*cycle - *start) : 0.0, "Read bytes per cycle");
+    IC_STAT("wr_bursts",      (double)s->wr_bursts, "Write bursts");
+    IC_STAT("wr_beats",       (double)s->wr_beats, "Write beats");
+    IC_STAT("wr_wait_avg",    s->wr_bursts ? (double)s->wr_wait_cycles / s->wr_bursts : 0.0, "Write arbitration wait (cycles)");
+    IC_STAT("wr_wait_max",    (double)s->wr_wait_max, "Write arbitration wait max (cycles)");
+    IC_STAT("wr_latency_avg", s->wr_bursts ? (double)s->wr_latency_cycles / s->wr_bursts : 0.0, "Write command to response (cycles)");
+    IC_STAT("wr_bandwidth",   (*cycle - *start) ? (double)(s->wr_beats * (AXI4_DATA_W/8)) / (*cycle - *start) : 0.0, "Write bytes per cycle");
+
+    #undef IC_STAT
+
+    ps.rd_latency = new tb_stat_histogram(group, "rd_latency", 0, TB_AXI4_IC_LAT_BUCKET, TB_AXI4_IC_LAT_BUCKETS,
+                                          "Read command to last beat (cycles)");
+    ps.registered.push_back(ps.rd_latency);
+}
+//-----------------------------------------------------------------
+// trace_open: Start streaming transaction trace
+//-----------------------------------------------------------------
+bool tb_axi4_interconnect::trace_open(const char *filename)
+{
+    std::vector<std::string> names;
+    for (int p=0;p<m_num_ports;p++)
+        names.push_back(m_port[p].name);
+
+    tb_axi4_trace *trace = new tb_axi4_trace();
+    if (!trace->open(filename, names))
+    {
+        delete trace;
+        return false;
+    }
+
+    m_trace = trace;
+    return true;
+}
+//-----------------------------------------------------------------
+// trace_close: Flush and close trace, print summary
+//-----------------------------------------------------------------
+void tb_axi4_interconnect::trace_close(void)
+{
+    if (!m_trace)
+        return;
+
+    m_trace->close();
+    printf("AXI trace: %lu records, %lu KB\n", (unsigned long)m_trace->get_records(),
+           (unsigned long)(m_trace->get_bytes() >> 10));
+
+    delete m_trace;
+    m_trace = NULL;
+
+    for (int p=0;p<m_num_ports;p++)
+    {
+        m_port[p].trace_aw.clear();
+        m_port[p].trace_w.clear();
+        m_port[p].trace_strb = 0;
+    }
+}
+//-----------------------------------------------------------------
+// trace_write: Record write bursts once command and data are seen
+//-----------------------------------------------------------------
+void tb_axi4_interconnect::trace_write(int p)
+{
+    port_state &port = m_port[p];
+
+    while (port.trace_aw.size() > 0 && port.trace_w.size() > 0)
+    {
+        tb_axi4_ic_cmd &cmd = port.trace_aw.front();
+
+        // Stamped at AW accept, as reads are at AR accept
+        m_trace->record(cmd.m_accept_cycle, p, cmd.m_id, cmd.m_addr, cmd.m_len, cmd.m_burst, true, port.trace_w.front());
+
+        port.trace_aw.pop_front();
+        port.trace_w.pop_front();
+    }
+}
+//-----------------------------------------------------------------
+// idle: No requests queued or in flight on any port
+//-----------------------------------------------------------------
+bool tb_axi4_interconnect::idle(void)
+{
+    if (m_w_route.size() > 0)
+        return false;
+
+    for (int p=0;p<m_num_ports;p++)
+    {
+        port_state &port  = m_port[p];
+        axi4_master axi_i = axi_in[p].read();
+        axi4_slave  axi_o = axi_out[p].read();
+
+        if (axi_i.ARVALID || axi_i.AWVALID || axi_i.WVALID || axi_o.RVALID || axi_o.BVALID)
+            return false;
+
+        if (port.ar_q.size() || port.aw_q.size() || port.w_q.size() ||
+            port.r_q.size()  || port.b_q.size()  ||
+            port.rd_issued.size() || port.wr_issued.size())
+            return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,220 @@
+#ifndef TB_AXI4_INTERCONNECT_H
+#define TB_AXI4_INTERCONNECT_H
+
+#include "axi4.h"
+#include "axi4_defines.h"
+#include "tb_axi4_trace.h"
+#include "tb_stats.h"
+#include <deque>
+#include <vector>
+#include <string>
+#include <map>
+
+//-------------------------------------------------------------
+// Defines
+//-------------------------------------------------------------
+#define TB_AXI4_IC_MAX_PORTS    (1 << AXI4_ID_W)
+#define TB_AXI4_IC_QUEUE_DEPTH  8
+#define TB_AXI4_IC_LAT_BUCKET   4       // Read latency histogram
+#define TB_AXI4_IC_LAT_BUCKETS  32
+
+enum eTB_AXI4_IC_ARB
+{
+    TB_AXI4_IC_ARB_ROUND_ROBIN,
+    TB_AXI4_IC_ARB_FIXED,
+    TB_AXI4_IC_ARB_QOS
+};
+
+//-------------------------------------------------------------
+// tb_axi4_ic_cmd: Queued AR / AW command
+//-------------------------------------------------------------
+class tb_axi4_ic_cmd
+{
+public:
+    tb_axi4_ic_cmd(uint32_t addr, uint32_t id, uint32_t len, uint32_t burst, uint64_t cycle)
+    {
+        m_addr         = addr;
+        m_id           = id;
+        m_len          = len;
+        m_burst        = burst;
+        m_accept_cycle = cycle;
+    }
+
+    uint32_t m_addr;
+    uint32_t m_id;
+    uint32_t m_len;
+    uint32_t m_burst;
+    uint64_t m_accept_cycle;
+};
+
+//-------------------------------------------------------------
+// tb_axi4_ic_stats: Per-port contention statistics
+//-------------------------------------------------------------
+class tb_axi4_ic_stats
+{
+public:
+    tb_axi4_ic_stats() { memset(this, 0, sizeof(*this)); }
+
+    uint64_t rd_bursts;
+    uint64_t rd_beats;
+    uint64_t rd_wait_cycles;
+    uint64_t rd_wait_max;
+    uint64_t rd_latency_cycles;
+    uint64_t wr_bursts;
+    uint64_t wr_beats;
+    uint64_t wr_wait_cycles;
+    uint64_t wr_wait_max;
+    uint64_t wr_latency_cycles;
+};
+
+//-------------------------------------------------------------
+// tb_axi4_interconnect: N:1 AXI4 interconnect model.
+// Upstream ports are arbitrated onto a single downstream port
+// (e.g. a shared DDR controller). Downstream IDs carry the
+// upstream port index in the low bits and the upstream ID above
+// it, so responses are routed back per (port, ID) and may return
+// out of order between IDs.
+//-------------------------------------------------------------
+class tb_axi4_interconnect: public sc_module
+{
+public:
+    //-------------------------------------------------------------
+    // Interface I/O
+    //-------------------------------------------------------------
+    sc_in <bool>                      clk_in;
+    sc_in <bool>                      rst_in;
+
+    sc_vector < sc_in <axi4_master> > axi_in;
+    sc_vector < sc_out <axi4_slave> > axi_out;
+
+    sc_out <axi4_master>              mem_out;
+    sc_in <axi4_slave>                mem_in;
+
+    //-------------------------------------------------------------
+    // Constructor
+    //-------------------------------------------------------------
+    SC_HAS_PROCESS(tb_axi4_interconnect);
+    tb_axi4_interconnect(sc_module_name name, int num_ports): sc_module(name)
+    {
+        sc_assert(num_ports > 0 && num_ports <= TB_AXI4_IC_MAX_PORTS);
+
+        axi_in.init(num_ports);
+        axi_out.init(num_ports);
+
+        m_num_ports   = num_ports;
+        m_port_bits   = 0;
+        while ((1 << m_port_bits) < num_ports)
+            m_port_bits++;
+        m_arb         = TB_AXI4_IC_ARB_ROUND_ROBIN;
+        m_cycle       = 0;
+        m_stats_start = 0;
+        m_rr_ar       = num_ports - 1;
+        m_rr_aw       = num_ports - 1;
+        m_trace       = NULL;
+
+        m_port.resize(num_ports);
+        for (int i=0;i<num_ports;i++)
+        {
+            m_port[i].name = "port" + std::to_string(i);
+            m_port[i].qos  = 0;
+            m_port[i].trace_strb = 0;
+            m_port[i].rd_latency = NULL;
+            register_stats(i);
+        }
+
+        // Port counters are published as formulas
+        tb_stats::instance().add_reset_hook(this, [this]() { reset_stats(); });
+
+        SC_CTHREAD(process, clk_in.pos());
+    }
+    ~tb_axi4_interconnect()
+    {
+        tb_stats::instance().remove_reset_hook(this);
+    }
+
+    //-------------------------------------------------------------
+    // Trace
+    //-------------------------------------------------------------
+    void add_trace(sc_trace_file *vcd, std::string prefix)
+    {
+        #undef  TRACE_SIGNAL
+        #define TRACE_SIGNAL(s) sc_trace(vcd,s,prefix + #s)
+
+        TRACE_SIGNAL(mem_out);
+        TRACE_SIGNAL(mem_in);
+
+        #undef  TRACE_SIGNAL
+    }
+
+    //-------------------------------------------------------------
+    // API
+    //-------------------------------------------------------------
+    void         set_arbitration(eTB_AXI4_IC_ARB arb) { m_arb = arb; }
+    void         set_port_name(int port, const char *name) { m_port[port].name = name; register_stats(port); }
+    void         set_port_qos(int port, int qos) { m_port[port].qos = qos; }
+
+    const tb_axi4_ic_stats& get_stats(int port) { return m_port[port].stats; }
+    void         print_stats(void);
+    void         reset_stats(void);
+    bool         idle(void);
+
+    // Streaming transaction trace (see tb_axi4_trace.h)
+    bool         trace_open(const char *filename);
+    void         trace_close(void);
+
+    void         process(void);
+
+protected:
+    int          arbitrate(uint32_t req_mask, int &rr_ptr);
+    bool         valid_id(int port, uint32_t id);
+    void         trace_write(int port);
+    void         register_stats(int port);
+
+    //-------------------------------------------------------------
+    // Per-port state
+    //-------------------------------------------------------------
+    struct port_state
+    {
+        std::string                  name;
+        int                          qos;
+
+        std::deque <tb_axi4_ic_cmd>  ar_q;
+        std::deque <tb_axi4_ic_cmd>  aw_q;
+        std::deque <axi4_master>     w_q;
+        std::deque <axi4_slave>      r_q;
+        std::deque <axi4_slave>      b_q;
+
+        // Issued downstream, awaiting response (in order per upstream
+        // ID, empty queues are erased)
+        std::map <uint32_t, std::deque <tb_axi4_ic_cmd> > rd_issued;
+        std::map <uint32_t, std::deque <tb_axi4_ic_cmd> > wr_issued;
+
+        tb_axi4_ic_stats             stats;
+
+        // Registered statistics (tb_stats.h), named after the port
+        std::vector <tb_stat*>       registered;
+        tb_stat_histogram *          rd_latency;
+
+        // Trace: write commands / WSTRB of completed bursts
+        std::deque <tb_axi4_ic_cmd>  trace_aw;
+        std::deque <uint8_t>         trace_w;
+        uint8_t                      trace_strb;
+    };
+
+    int                      m_num_ports;
+    int                      m_port_bits;       // Downstream ID = {upstream ID, port}
+    eTB_AXI4_IC_ARB          m_arb;
+    uint64_t                 m_cycle;
+    uint64_t                 m_stats_start;     // m_cycle at reset_stats()
+    int                      m_rr_ar;
+    int                      m_rr_aw;
+
+    std::vector <port_state> m_port;
+
+    // Port order of granted write commands (W follows AW order)
+    std::deque <int>         m_w_route;
+
+    tb_axi4_trace *          m_trace;
+};
+
+#endif
@@ -1,15 +1,16 @@
 #include "tb_axi4_mem.h"
-#include <queue>
 
 //-----------------------------------------------------------------
 // process: Handle AXI requests
 //-----------------------------------------------------------------
 void tb_axi4_mem::process(void)
 {
-    std::queue <axi4_master> axi_rd_q;
-    std::queue <axi4_master> axi_wr_q;
+    std::deque <tb_axi4_txn> axi_rd_q;
+    std::deque <tb_axi4_txn> axi_wr_q;
+    std::deque <tb_axi4_txn> axi_wr_resp_q;
+    std::deque <axi4_master> axi_wdata_q;
 
-    axi4_master axi_wr_req;
+    int rd_active = -1;
 
     while (1)
     {
@@ -19,55 +20,45 @@ void tb_axi4_mem::process(void)
         // Read command
         if (axi_i.ARVALID && axi_o.ARREADY)
         {
-            sc_uint <AXI4_ADDR_W> next_addr = axi_i.ARADDR & ~calc_wrap_mask(0);
-            axi4_master           axi_first = axi_i;
-
-            // Unroll burst
-            for (int i=0;i<((int)(axi_first.ARLEN) + 1);i++)
-            {
-                axi4_master item = axi_first;
-
-                item.ARVALID  = true;
-                item.ARADDR   = next_addr;
-                item.WLAST    = (i == axi_first.ARLEN);
-
-                axi_rd_q.push(item);
-
-                // Generate next address
-                next_addr = calc_next_addr(next_addr, axi_first.ARBURST, axi_first.ARLEN);
-            }
+            tb_axi4_txn txn(axi_i.ARADDR & ~calc_wrap_mask(0), axi_i.ARID, axi_i.ARLEN, axi_i.ARBURST);
+            txn.m_ready_cycle  = m_cycle + m_latency;
+            txn.m_accept_cycle = m_cycle;
+            axi_rd_q.push_back(txn);
+            m_stat_rd_bursts++;
         }
 
         // Write command
         if (axi_i.AWVALID && axi_o.AWREADY)
         {
-            // Record command
-            axi_wr_req = axi_i;
+            axi_wr_q.push_back(tb_axi4_txn(axi_i.AWADDR, axi_i.AWID, axi_i.AWLEN, axi_i.AWBURST));
+            m_stat_wr_bursts++;
         }
 
-        // Write data
+        // Write data (may be accepted ahead of the command)
         if (axi_i.WVALID && axi_o.WREADY)
-        {
-            sc_assert(axi_wr_req.AWVALID);
-
-            axi4_master item = axi_wr_req;
-
-            item.AWVALID  = true;
-            item.AWADDR   = axi_wr_req.AWADDR;
+            axi_wdata_q.push_back(axi_i);
 
-            item.WVALID  = true;
-            item.WDATA   = axi_i.WDATA;
-            item.WSTRB   = axi_i.WSTRB;
-            item.WLAST   = axi_i.WLAST;
+        // Match write data to commands (AXI4: no write interleaving)
+        while (axi_wr_q.size() > 0 && axi_wdata_q.size() > 0)
+        {
+            tb_axi4_txn &txn  = axi_wr_q.front();
+            axi4_master  item = axi_wdata_q.front();
+            axi_wdata_q.pop_front();
 
-            axi_wr_q.push(item);
+            write32((uint32_t)txn.m_addr, (uint32_t)item.WDATA, (uint8_t)item.WSTRB);
+            m_stat_wr_beats++;
 
             // Generate next address
-            axi_wr_req.AWADDR = calc_next_addr(axi_wr_req.AWADDR, axi_wr_req.AWBURST, axi_wr_req.AWLEN);
+            txn.m_addr = calc_next_addr(txn.m_addr, txn.m_burst, txn.m_len);
+            txn.m_beats--;
 
             // Last item
             if (item.WLAST)
-                axi_wr_req.AWVALID = false;
+            {
+                txn.m_ready_cycle = m_cycle + m_latency;
+                axi_wr_resp_q.push_back(txn);
+                axi_wr_q.pop_front();
+            }
         }
 
         if (axi_o.RVALID && axi_i.RREADY)
@@ -81,14 +72,34 @@ void tb_axi4_mem::process(void)
 
         if (!axi_o.RVALID && axi_rd_q.size() > 0 && !delay_cycle())
         {
-            axi4_master item = axi_rd_q.front();
-            axi_rd_q.pop();
-
-            axi_o.RVALID = true;
-            axi_o.RDATA  = read32((uint32_t)item.ARADDR);
-            axi_o.RID    = item.ARID;
-            axi_o.RLAST  = item.WLAST;
-            axi_o.RRESP  = AXI4_RESP_OKAY;
+            int idx = (rd_active >= 0) ? rd_active : select_txn(axi_rd_q);
+            if (idx >= 0)
+            {
+                tb_axi4_txn &txn = axi_rd_q[idx];
+
+                axi_o.RVALID = true;
+                axi_o.RDATA  = read32((uint32_t)txn.m_addr);
+                axi_o.RID    = txn.m_id;
+                axi_o.RLAST  = (txn.m_beats == 1);
+                axi_o.RRESP  = AXI4_RESP_OKAY;
+
+                if (txn.m_beats == txn.m_len + 1)
+                    m_stat_rd_latency.sample(m_cycle - txn.m_accept_cycle);
+                m_stat_rd_beats++;
+
+                // Generate next address
+                txn.m_addr = calc_next_addr(txn.m_addr, txn.m_burst, txn.m_len);
+                txn.m_beats--;
+
+                if (txn.m_beats == 0)
+                {
+                    axi_rd_q.erase(axi_rd_q.begin() + idx);
+                    rd_active = -1;
+                }
+                // Hold the burst unless beats from other IDs may interleave
+                else if (!m_interleave)
+                    rd_active = idx;
+            }
         }
 
         if (axi_o.BVALID && axi_i.BREADY)
@@ -98,30 +109,63 @@ void tb_axi4_mem::process(void)
             axi_o.BRESP  = 0;
         }
 
-        if (!axi_o.BVALID && axi_wr_q.size() > 0 && !delay_cycle())
+        if (!axi_o.BVALID && axi_wr_resp_q.size() > 0 && !delay_cycle())
         {
-            axi4_master item = axi_wr_q.front();
-            axi_wr_q.pop();
-
-            write32((uint32_t)item.AWADDR, (uint32_t)item.WDATA, (uint8_t)item.WSTRB);
+            int idx = select_txn(axi_wr_resp_q);
+            if (idx >= 0)
+            {
+                axi_o.BVALID = true;
+                axi_o.BID    = axi_wr_resp_q[idx].m_id;
+                axi_o.BRESP  = AXI4_RESP_OKAY;
 
-            axi_o.BVALID = item.WLAST;
-            axi_o.BID    = item.AWID;
-            axi_o.BRESP  = AXI4_RESP_OKAY;
-        }        
+                axi_wr_resp_q.erase(axi_wr_resp_q.begin() + idx);
+            }
+        }
 
         // Randomize handshaking
-        axi_o.ARREADY = !delay_cycle() && (axi_rd_q.size() < 128);
-        axi_o.AWREADY = !delay_cycle() && (axi_wr_q.size() < 128);
-        axi_o.WREADY  = axi_o.AWREADY && !delay_cycle();
-        axi_o.AWREADY&= !axi_wr_req.AWVALID;
+        axi_o.ARREADY = !delay_cycle() && ((int)axi_rd_q.size() < m_rd_outstanding);
+        axi_o.AWREADY = !delay_cycle() && ((int)(axi_wr_q.size() + axi_wr_resp_q.size()) < m_wr_outstanding);
+        axi_o.WREADY  = !delay_cycle() && (axi_wdata_q.size() < TB_AXI4_MEM_WDATA_DEPTH);
 
         axi_out.write(axi_o);
 
+        m_cycle++;
         wait();
     }
 }
 //-----------------------------------------------------------------
+// select_txn: Pick the next response to return.
+// Responses with the same ID always complete in order, different
+// IDs may be reordered when enabled.
+//-----------------------------------------------------------------
+int tb_axi4_mem::select_txn(std::deque <tb_axi4_txn> &q)
+{
+    if (!m_reorder)
+        return (q.size() > 0 && q[0].m_ready_cycle <= m_cycle) ? 0 : -1;
+
+    int      candidates[1 << AXI4_ID_W];
+    int      num_candidates = 0;
+    uint32_t id_seen        = 0;
+
+    for (int i=0;i<(int)q.size();i++)
+    {
+        uint32_t id_mask = 1 << q[i].m_id;
+
+        // Only the oldest transaction per ID is eligible
+        if (id_seen & id_mask)
+            continue;
+        id_seen |= id_mask;
+
+        if (q[i].m_ready_cycle <= m_cycle)
+            candidates[num_candidates++] = i;
+    }
+
+    if (num_candidates == 0)
+        return -1;
+
+    return candidates[rand() % num_candidates];
+}
+//-----------------------------------------------------------------
 // calc_next_addr: Calculate next addr based on burst type
 //-----------------------------------------------------------------
 sc_uint <AXI4_ADDR_W> tb_axi4_mem::calc_next_addr(sc_uint <AXI4_ADDR_W> addr, sc_uint <AXI4_AXBURST_W> type, sc_uint <AXI4_AXLEN_W> len)
@@ -168,6 +212,13 @@ sc_uint <AXI4_AXLEN_W> tb_axi4_mem::calc_wrap_mask(sc_uint <AXI4_AXLEN_W> len)
 //-----------------------------------------------------------------
 void tb_axi4_mem::write32(uint32_t addr, uint32_t data, uint8_t strb)
 {
+    tb_device *dev = find_device(addr);
+    if (dev)
+    {
+        dev->write32((addr & ~3) - dev->get_base(), data, strb);
+        return;
+    }
+
     for (int i=0;i<4;i++)
         if (strb & (1 << i))
             tb_memory::write(addr + i,data >> (i*8));
@@ -177,6 +228,10 @@ void tb_axi4_mem::write32(uint32_t addr, uint32_t data, uint8_t strb)
 //-----------------------------------------------------------------
 uint32_t tb_axi4_mem::read32(uint32_t addr)
 {
+    tb_device *dev = find_device(addr);
+    if (dev)
+        return dev->read32((addr & ~3) - dev->get_base());
+
     uint32_t data = 0;
     for (int i=0;i<4;i++)
         data |= ((uint32_t)tb_memory::read(addr + i)) << (i*8);
@@ -4,6 +4,42 @@
 #include "axi4.h"
 #include "axi4_defines.h"
 #include "tb_memory.h"
+#include "tb_stats.h"
+#include <deque>
+
+//-------------------------------------------------------------
+// Defines
+//-------------------------------------------------------------
+#define TB_AXI4_MEM_RD_OUTSTANDING  16
+#define TB_AXI4_MEM_WR_OUTSTANDING  1
+#define TB_AXI4_MEM_WDATA_DEPTH     128
+#define TB_AXI4_MEM_LAT_BUCKETS     64      // First beat latency histogram
+
+//-------------------------------------------------------------
+// tb_axi4_txn: Outstanding burst
+//-------------------------------------------------------------
+class tb_axi4_txn
+{
+public:
+    tb_axi4_txn(uint32_t addr, uint32_t id, uint32_t len, uint32_t burst)
+    {
+        m_addr         = addr;
+        m_id           = id;
+        m_len          = len;
+        m_burst        = burst;
+        m_beats        = len + 1;
+        m_ready_cycle  = 0;
+        m_accept_cycle = 0;
+    }
+
+    sc_uint <AXI4_ADDR_W>    m_addr;
+    uint32_t                 m_id;
+    uint32_t                 m_len;
+    uint32_t                 m_burst;
+    uint32_t                 m_beats;
+    uint64_t                 m_ready_cycle;
+    uint64_t                 m_accept_cycle;
+};
 
 //-------------------------------------------------------------
 // tb_axi4_mem: AXI4 testbench memory
@@ -24,10 +60,26 @@ public:
     // Constructor
     //-------------------------------------------------------------
     SC_HAS_PROCESS(tb_axi4_mem);
-    tb_axi4_mem(sc_module_name name): sc_module(name) 
-    { 
+    tb_axi4_mem(sc_module_name name): sc_module(name)
+        , m_stat_rd_bursts(sc_module::name(), "rd_bursts", "Read bursts")
+        , m_stat_rd_beats(sc_module::name(), "rd_beats", "Read beats")
+        , m_stat_wr_bursts(sc_module::name(), "wr_bursts", "Write bursts")
+        , m_stat_wr_beats(sc_module::name(), "wr_beats", "Write beats")
+        , m_stat_rd_latency(sc_module::name(), "rd_latency", 0, 1, TB_AXI4_MEM_LAT_BUCKETS,
+                            "Read command to first beat (cycles)")
+        , m_stat_allocated(sc_module::name(), "allocated_bytes",
+                           [this]() -> double { return (double)get_allocated(); }, "Guest memory")
+        , m_stat_resident(sc_module::name(), "resident_bytes",
+                          [this]() -> double { return (double)get_resident(); }, "Host memory in use")
+    {
         SC_CTHREAD(process, clk_in.pos());
-        m_enable_delays = true;
+        m_enable_delays  = true;
+        m_rd_outstanding = TB_AXI4_MEM_RD_OUTSTANDING;
+        m_wr_outstanding = TB_AXI4_MEM_WR_OUTSTANDING;
+        m_latency        = 0;
+        m_reorder        = false;
+        m_interleave     = false;
+        m_cycle          = 0;
     }
 
     //-------------------------------------------------------------
@@ -48,6 +100,11 @@ public:
     // API
     //-------------------------------------------------------------
     void         enable_delays(bool enable) { m_enable_delays = enable; }
+    void         set_outstanding(int rd, int wr) { m_rd_outstanding = rd; m_wr_outstanding = wr; }
+    void         set_latency(int cycles)    { m_latency = cycles; }
+    void         enable_reorder(bool enable)    { m_reorder = enable; }
+    void         enable_interleave(bool enable) { m_interleave = enable; } // With reorder only
+
     void         write(uint32_t addr, uint8_t data);
     uint8_t      read(uint32_t addr);
     void         write32(uint32_t addr, uint32_t data, uint8_t strb = 0xF);
@@ -60,7 +117,23 @@ public:
     sc_uint <AXI4_ADDR_W>  calc_next_addr(sc_uint <AXI4_ADDR_W> addr, sc_uint <AXI4_AXBURST_W> type, sc_uint <AXI4_AXLEN_W> len);
 
 protected:
-    bool m_enable_delays;
+    int          select_txn(std::deque <tb_axi4_txn> &q);
+
+    bool         m_enable_delays;
+    int          m_rd_outstanding;
+    int          m_wr_outstanding;
+    int          m_latency;
+    bool         m_reorder;
+    bool         m_interleave;
+    uint64_t     m_cycle;
+
+    tb_stat_scalar    m_stat_rd_bursts;
+    tb_stat_scalar    m_stat_rd_beats;
+    tb_stat_scalar    m_stat_wr_bursts;
+    tb_stat_scalar    m_stat_wr_beats;
+    tb_stat_histogram m_stat_rd_latency;
+    tb_stat_formula   m_stat_allocated;
+    tb_stat_formula   m_stat_resident;
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,220 @@
+#include <stdio.h>
+#include <string.h>
+#include "tb_axi4_trace.h"
+
+//-----------------------------------------------------------------
+// has_suffix
+//-----------------------------------------------------------------
+static bool has_suffix(const std::string &s, const char *suffix)
+{
+    size_t len = strlen(suffix);
+    return s.size() >= len && s.compare(s.size() - len, len, suffix) == 0;
+}
+//-----------------------------------------------------------------
+// Constructor
+//-----------------------------------------------------------------
+tb_axi4_trace::tb_axi4_trace()
+{
+    m_file    = NULL;
+    m_records = 0;
+    m_bytes   = 0;
+    m_stop    = false;
+    m_error   = false;
+}
+tb_axi4_trace::~tb_axi4_trace()
+{
+    close();
+}
+//-----------------------------------------------------------------
+// open: Create trace file, write header, start writer thread
+//-----------------------------------------------------------------
+bool tb_axi4_trace::open(const char *filename, const std::vector<std::string> &ports)
+{
+    m_filename = filename;
+
+    // Fast compression - the trace must keep up with the simulation
+    m_file = gzopen(filename, has_suffix(m_filename, ".gz") ? "wb1" : "wbT");
+    if (!m_file)
+    {
+        fprintf(stderr, "ERROR: Cannot create trace %s\n", filename);
+        return false;
+    }
+
+    tb_axi4_trace_hdr hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, TB_AXI4_TRACE_MAGIC, sizeof(hdr.magic));
+    hdr.version   = TB_AXI4_TRACE_VERSION;
+    hdr.rec_size  = sizeof(tb_axi4_trace_rec);
+    hdr.num_ports = (uint16_t)ports.size();
+
+    m_buf.reserve(TB_AXI4_TRACE_BUF_SIZE);
+    const uint8_t *p = (const uint8_t *)&hdr;
+    m_buf.insert(m_buf.end(), p, p + sizeof(hdr));
+
+    for (size_t i=0;i<ports.size();i++)
+    {
+        char name[TB_AXI4_TRACE_NAME_LEN];
+        memset(name, 0, sizeof(name));
+        strncpy(name, ports[i].c_str(), sizeof(name) - 1);
+        m_buf.insert(m_buf.end(), name, name + sizeof(name));
+    }
+
+    m_records = 0;
+    m_bytes   = 0;
+    m_stop    = false;
+    m_error   = false;
+    m_thread  = std::thread(&tb_axi4_trace::writer, this);
+    return true;
+}
+//-----------------------------------------------------------------
+// close: Flush remaining records, stop writer
+//-----------------------------------------------------------------
+void tb_axi4_trace::close(void)
+{
+    if (!m_file)
+        return;
+
+    submit();
+
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        m_stop = true;
+    }
+    m_cond.notify_all();
+    m_thread.join();
+
+    gzclose(m_file);
+    m_file = NULL;
+
+    if (m_error)
+        fprintf(stderr, "ERROR: Write to trace %s failed\n", m_filename.c_str());
+}
+//-----------------------------------------------------------------
+// submit: Pass current buffer to writer (blocks if it falls behind)
+//-----------------------------------------------------------------
+void tb_axi4_trace::submit(void)
+{
+    if (m_buf.empty())
+        return;
+
+    std::unique_lock<std::mutex> guard(m_lock);
+    m_cond.wait(guard, [this]{ return m_queue.size() < TB_AXI4_TRACE_BUF_MAX; });
+
+    m_queue.push_back(std::vector<uint8_t>());
+    m_queue.back().swap(m_buf);
+    guard.unlock();
+    m_cond.notify_all();
+
+    m_buf.reserve(TB_AXI4_TRACE_BUF_SIZE);
+}
+//-----------------------------------------------------------------
+// writer: Background thread - compress / write queued buffers
+//-----------------------------------------------------------------
+void tb_axi4_trace::writer(void)
+{
+    while (true)
+    {
+        std::vector<uint8_t> buf;
+        {
+            std::unique_lock<std::mutex> guard(m_lock);
+            m_cond.wait(guard, [this]{ return m_stop || !m_queue.empty(); });
+
+            if (m_queue.empty())
+                return;
+
+            buf.swap(m_queue.front());
+            m_queue.pop_front();
+        }
+        m_cond.notify_all();
+
+        if (gzwrite(m_file, buf.data(), (unsigned)buf.size()) != (int)buf.size())
+            m_error = true;
+        m_bytes += buf.size();
+    }
+}
+
+//-----------------------------------------------------------------
+// tb_axi4_trace_reader
+//-----------------------------------------------------------------
+tb_axi4_trace_reader::tb_axi4_trace_reader()
+{
+    m_file = NULL;
+    m_pos  = 0;
+    m_len  = 0;
+}
+tb_axi4_trace_reader::~tb_axi4_trace_reader()
+{
+    close();
+}
+//-----------------------------------------------------------------
+// open: Check header, read port names
+//-----------------------------------------------------------------
+bool tb_axi4_trace_reader::open(const char *filename)
+{
+    m_file = gzopen(filename, "rb");
+    if (!m_file)
+    {
+        fprintf(stderr, "ERROR: Cannot open trace %s\n", filename);
+        return false;
+    }
+
+    tb_axi4_trace_hdr hdr;
+    if (gzread(m_file, &hdr, sizeof(hdr)) != (int)sizeof(hdr) ||
+        memcmp(hdr.magic, TB_AXI4_TRACE_MAGIC, sizeof(hdr.magic)) != 0 ||
+        hdr.rec_size != sizeof(tb_axi4_trace_rec))
+    {
+        fprintf(stderr, "ERROR: %s is not an AXI trace\n", filename);
+        close();
+        return false;
+    }
+
+    m_ports.clear();
+    for (int i=0;i<hdr.num_ports;i++)
+    {
+        char name[TB_AXI4_TRACE_NAME_LEN];
+        if (gzread(m_file, name, sizeof(name)) != (int)sizeof(name))
+        {
+            close();
+            return false;
+        }
+        name[sizeof(name) - 1] = 0;
+        m_ports.push_back(name);
+    }
+
+    m_buf.resize(TB_AXI4_TRACE_BUF_SIZE);
+    m_pos = 0;
+    m_len = 0;
+    return true;
+}
+void tb_axi4_trace_reader::close(void)
+{
+    if (m_file)
+        gzclose(m_file);
+    m_file = NULL;
+}
+//-----------------------------------------------------------------
+// next: Next record (false at end of trace)
+//-----------------------------------------------------------------
+bool tb_axi4_trace_reader::next(tb_axi4_trace_rec &rec)
+{
+    if (m_pos + sizeof(rec) > m_len)
+    {
+        if (!m_file)
+            return false;
+
+        // Keep partial record
+        size_t left = m_len - m_pos;
+        memmove(m_buf.data(), m_buf.data() + m_pos, left);
+
+        int len = gzread(m_file, m_buf.data() + left, (unsigned)(m_buf.size() - left));
+        m_pos = 0;
+        m_len = left + (len > 0 ? len : 0);
+
+        if (m_len < sizeof(rec))
+            return false;
+    }
+
+    memcpy(&rec, m_buf.data() + m_pos, sizeof(rec));
+    m_pos += sizeof(rec);
+    return true;
+}
@@ -0,0 +1,150 @@
+#ifndef TB_AXI4_TRACE_H
+#define TB_AXI4_TRACE_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <zlib.h>
+
+//-------------------------------------------------------------
+// Defines
+//-------------------------------------------------------------
+#define TB_AXI4_TRACE_MAGIC         "AXITRC01"
+#define TB_AXI4_TRACE_VERSION       1
+#define TB_AXI4_TRACE_NAME_LEN      16
+#define TB_AXI4_TRACE_BUF_SIZE      (1 << 20)
+#define TB_AXI4_TRACE_BUF_MAX       8       // Buffers queued to the writer
+
+// Record flags
+#define TB_AXI4_TRACE_WRITE         (1 << 0)
+#define TB_AXI4_TRACE_BURST_SHIFT   1       // [2:1] = AXI burst type
+
+//-------------------------------------------------------------
+// File layout (little endian);
+//   tb_axi4_trace_hdr
+//   char name[num_ports][TB_AXI4_TRACE_NAME_LEN]
+//   tb_axi4_trace_rec ...
+// One record per burst. cycle is when the command (AR / AW) was
+// accepted; a write is recorded once its last data beat has been
+// seen, so it may follow reads accepted later. Files named *.gz are
+// gzip compressed (tb_axi4_trace_reader handles both).
+//-------------------------------------------------------------
+#pragma pack(push, 1)
+struct tb_axi4_trace_hdr
+{
+    char     magic[8];
+    uint16_t version;
+    uint16_t rec_size;
+    uint16_t num_ports;
+    uint16_t reserved;
+};
+
+struct tb_axi4_trace_rec
+{
+    uint32_t cycle_lo;
+    uint16_t cycle_hi;      // 48-bit cycle count
+    uint8_t  port;          // Interconnect upstream port
+    uint8_t  id;            // AXI ID on that port
+    uint32_t addr;
+    uint8_t  len;           // AxLEN (beats - 1)
+    uint8_t  flags;
+    uint8_t  strb;          // Writes: OR of WSTRB over the burst
+    uint8_t  reserved;
+
+    uint64_t cycle(void)    const { return ((uint64_t)cycle_hi << 32) | cycle_lo; }
+    bool     is_write(void) const { return flags & TB_AXI4_TRACE_WRITE; }
+    int      burst(void)    const { return (flags >> TB_AXI4_TRACE_BURST_SHIFT) & 3; }
+};
+#pragma pack(pop)
+
+//-------------------------------------------------------------
+// tb_axi4_trace: Streaming transaction trace writer.
+// Records are appended to a buffer in the simulation thread;
+// full buffers are compressed / written by a background thread.
+//-------------------------------------------------------------
+class tb_axi4_trace
+{
+public:
+    tb_axi4_trace();
+    ~tb_axi4_trace();
+
+    bool     open(const char *filename, const std::vector<std::string> &ports);
+    void     close(void);
+    bool     is_open(void) { return m_file != NULL; }
+
+    void record(uint64_t cycle, int port, uint32_t id, uint32_t addr, uint32_t len,
+                uint32_t burst, bool write, uint8_t strb)
+    {
+        if (m_buf.size() + sizeof(tb_axi4_trace_rec) > TB_AXI4_TRACE_BUF_SIZE)
+            submit();
+
+        tb_axi4_trace_rec r;
+        r.cycle_lo = (uint32_t)cycle;
+        r.cycle_hi = (uint16_t)(cycle >> 32);
+        r.port     = (uint8_t)port;
+        r.id       = (uint8_t)id;
+        r.addr     = addr;
+        r.len      = (uint8_t)len;
+        r.flags    = (write ? TB_AXI4_TRACE_WRITE : 0) | ((burst & 3) << TB_AXI4_TRACE_BURST_SHIFT);
+        r.strb     = strb;
+        r.reserved = 0;
+
+        const uint8_t *p = (const uint8_t *)&r;
+        m_buf.insert(m_buf.end(), p, p + sizeof(r));
+        m_records++;
+    }
+
+    uint64_t get_records(void) { return m_records; }
+    uint64_t get_bytes(void)   { return m_bytes; }
+
+protected:
+    void     submit(void);
+    void     writer(void);
+
+    gzFile                            m_file;
+    std::string                       m_filename;
+    std::vector<uint8_t>              m_buf;
+    uint64_t                          m_records;
+    uint64_t                          m_bytes;
+
+    // Writer thread
+    std::thread                       m_thread;
+    std::mutex                        m_lock;
+    std::condition_variable           m_cond;
+    std::deque < std::vector<uint8_t> > m_queue;
+    bool                              m_stop;
+    bool                              m_error;
+};
+
+//-------------------------------------------------------------
+// tb_axi4_trace_reader: Read back a trace (compressed or not)
+//-------------------------------------------------------------
+class tb_axi4_trace_reader
+{
+public:
+    tb_axi4_trace_reader();
+    ~tb_axi4_trace_reader();
+
+    bool        open(const char *filename);
+    void        close(void);
+    bool        next(tb_axi4_trace_rec &rec);
+
+    int         get_num_ports(void)       { return (int)m_ports.size(); }
+    std::string get_port_name(int port)
+    {
+        return (port >= 0 && port < (int)m_ports.size()) ? m_ports[port] : "port" + std::to_string(port);
+    }
+
+protected:
+    gzFile                   m_file;
+    std::vector<std::string> m_ports;
+    std::vector<uint8_t>     m_buf;
+    size_t                   m_pos;
+    size_t                   m_len;
+};
+
+#endif
@@ -0,0 +1,265 @@
+#ifndef TB_DISASM_H
+#define TB_DISASM_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <map>
+
+//-----------------------------------------------------------------
+// Defines
+//-----------------------------------------------------------------
+#define TB_DISASM_CACHE_MAX     65536
+
+//-----------------------------------------------------------------
+// tb_disasm_inst: Decoded fields (biriscv_trace_sim.v dbg_inst_*)
+//-----------------------------------------------------------------
+struct tb_disasm_inst
+{
+    const char *str;
+    const char *ra;
+    const char *rb;
+    const char *rd;
+    uint32_t    imm;
+    bool        has_imm;
+};
+
+//-----------------------------------------------------------------
+// tb_disasm: C++ equivalent of biriscv_trace_sim, used when the
+// model is built with BIRISCV_FAST_SIM (no debug strings in RTL).
+// Only called for instructions actually displayed or logged; the
+// mnemonic and register names match the RTL strings exactly.
+//-----------------------------------------------------------------
+class tb_disasm
+{
+public:
+    //-------------------------------------------------------------
+    // decode: Same priority order as the RTL case statements
+    //-------------------------------------------------------------
+    static void decode(uint32_t pc, uint32_t opcode, tb_disasm_inst &d)
+    {
+        static const struct { uint32_t mask; uint32_t match; const char *str; } insts[] =
+        {
+            { 0x0000707f, 0x00007013, "andi" },
+            { 0x0000707f, 0x00000013, "addi" },
+            { 0x0000707f, 0x00002013, "slti" },
+            { 0x0000707f, 0x00003013, "sltiu" },
+            { 0x0000707f, 0x00006013, "ori" },
+            { 0x0000707f, 0x00004013, "xori" },
+            { 0xfc00707f, 0x00001013, "slli" },
+            { 0xfc00707f, 0x00005013, "srli" },
+            { 0xfc00707f, 0x40005013, "srai" },
+            { 0x0000007f, 0x00000037, "lui" },
+            { 0x0000007f, 0x00000017, "auipc" },
+            { 0xfe00707f, 0x00000033, "add" },
+            { 0xfe00707f, 0x40000033, "sub" },
+            { 0xfe00707f, 0x00002033, "slt" },
+            { 0xfe00707f, 0x00003033, "sltu" },
+            { 0xfe00707f, 0x00004033, "xor" },
+            { 0xfe00707f, 0x00006033, "or" },
+            { 0xfe00707f, 0x00007033, "and" },
+            { 0xfe00707f, 0x00001033, "sll" },
+            { 0xfe00707f, 0x00005033, "srl" },
+            { 0xfe00707f, 0x40005033, "sra" },
+            { 0x0000007f, 0x0000006f, "jal" },
+            { 0x0000707f, 0x00000067, "jalr" },
+            { 0x0000707f, 0x00000063, "beq" },
+            { 0x0000707f, 0x00001063, "bne" },
+            { 0x0000707f, 0x00004063, "blt" },
+            { 0x0000707f, 0x00005063, "bge" },
+            { 0x0000707f, 0x00006063, "bltu" },
+            { 0x0000707f, 0x00007063, "bgeu" },
+            { 0x0000707f, 0x00000003, "lb" },
+            { 0x0000707f, 0x00001003, "lh" },
+            { 0x0000707f, 0x00002003, "lw" },
+            { 0x0000707f, 0x00004003, "lbu" },
+            { 0x0000707f, 0x00005003, "lhu" },
+            { 0x0000707f, 0x00006003, "lwu" },
+            { 0x0000707f, 0x00000023, "sb" },
+            { 0x0000707f, 0x00001023, "sh" },
+            { 0x0000707f, 0x00002023, "sw" },
+            { 0xffffffff, 0x00000073, "ecall" },
+            { 0xffffffff, 0x00100073, "ebreak" },
+            { 0xcfffffff, 0x00200073, "eret" },
+            { 0x0000707f, 0x00001073, "csrrw" },
+            { 0x0000707f, 0x00002073, "csrrs" },
+            { 0x0000707f, 0x00003073, "csrrc" },
+            { 0x0000707f, 0x00005073, "csrrwi" },
+            { 0x0000707f, 0x00006073, "csrrsi" },
+            { 0x0000707f, 0x00007073, "csrrci" },
+            { 0xfe00707f, 0x02000033, "mul" },
+            { 0xfe00707f, 0x02001033, "mulh" },
+            { 0xfe00707f, 0x02002033, "mulhsu" },
+            { 0xfe00707f, 0x02003033, "mulhu" },
+            { 0xfe00707f, 0x02004033, "div" },
+            { 0xfe00707f, 0x02005033, "divu" },
+            { 0xfe00707f, 0x02006033, "rem" },
+            { 0xfe00707f, 0x02007033, "remu" },
+            { 0x0000707f, 0x0000100f, "fence.i" },
+            { 0, 0, NULL }
+        };
+
+        int ra_idx = (opcode >> 15) & 0x1F;
+        int rb_idx = (opcode >> 20) & 0x1F;
+        int rd_idx = (opcode >> 7)  & 0x1F;
+
+        uint32_t imm12    = (uint32_t)((int32_t)opcode >> 20);
+        uint32_t imm20    = opcode & 0xFFFFF000;
+        uint32_t storeimm = (uint32_t)(((int32_t)opcode >> 20) & ~0x1F) | ((opcode >> 7) & 0x1F);
+        uint32_t jimm20   = (uint32_t)(((int32_t)(opcode & 0x80000000)) >> 11) |
+                            (opcode & 0xFF000) | ((opcode >> 9) & 0x800) | ((opcode >> 20) & 0x7FE);
+
+        d.str     = "-";
+        d.ra      = regname(ra_idx);
+        d.rb      = regname(rb_idx);
+        d.rd      = regname(rd_idx);
+        d.imm     = 0;
+        d.has_imm = false;
+
+        int i;
+        for (i=0;insts[i].str;i++)
+            if ((opcode & insts[i].mask) == insts[i].match)
+            {
+                d.str = insts[i].str;
+                break;
+            }
+
+        if (!insts[i].str)
+            return;
+
+        // Operands (second RTL case statement)
+        uint32_t op = opcode & 0x7F;
+        int funct3  = (opcode >> 12) & 0x7;
+
+        // addi andi slti sltiu ori xori / csr*
+        if ((op == 0x13 && funct3 != 1 && funct3 != 5) || (op == 0x73 && funct3 != 0 && funct3 != 4))
+        {
+            d.rb = "-";
+            set_imm(d, imm12);
+        }
+        // slli srli srai
+        else if (op == 0x13)
+        {
+            d.rb = "-";
+            set_imm(d, rb_idx);
+        }
+        else if (op == 0x37)
+        {
+            d.ra = "-";
+            d.rb = "-";
+            set_imm(d, imm20);
+        }
+        else if (op == 0x17)
+        {
+            d.ra = "pc";
+            d.rb = "-";
+            set_imm(d, imm20);
+        }
+        else if (op == 0x6F)
+        {
+            d.ra = "-";
+            d.rb = "-";
+            set_imm(d, pc + jimm20);
+            if (rd_idx == 1)
+                d.str = "call";
+        }
+        else if (op == 0x67 && funct3 == 0)
+        {
+            d.rb = "-";
+            set_imm(d, imm12);
+            if (ra_idx == 1 && imm12 == 0)
+                d.str = "ret";
+            else if (rd_idx == 1)
+                d.str = "call (R)";
+        }
+        // lb lh lw lbu lhu lwu
+        else if (op == 0x03 && funct3 != 3 && funct3 != 7)
+        {
+            d.rb = "-";
+            set_imm(d, imm12);
+        }
+        // sb sh sw
+        else if (op == 0x23 && funct3 <= 2)
+        {
+            d.rd = "-";
+            set_imm(d, storeimm);
+        }
+    }
+
+    //-------------------------------------------------------------
+    // format: 'mnemonic rd, ra, rb, imm' (unused operands omitted)
+    //-------------------------------------------------------------
+    static std::string format(uint32_t pc, uint32_t opcode)
+    {
+        tb_disasm_inst d;
+        decode(pc, opcode, d);
+
+        std::string s = d.str;
+        const char *ops[] = { d.rd, d.ra, d.rb };
+        bool first = true;
+        for (int i=0;i<3;i++)
+        {
+            if (!strcmp(ops[i], "-"))
+                continue;
+            s += first ? " " : ", ";
+            s += ops[i];
+            first = false;
+        }
+
+        if (d.has_imm)
+        {
+            char buf[16];
+            snprintf(buf, sizeof(buf), "0x%x", d.imm);
+            s += first ? " " : ", ";
+            s += buf;
+        }
+
+        return s;
+    }
+
+    static const char *regname(int r)
+    {
+        static const char *names[] =
+        {
+            "zero", "ra", "sp", "gp", "tp", "t0", "t1", "t2",
+            "s0", "s1", "a0", "a1", "a2", "a3", "a4", "a5",
+            "a6", "a7", "s2", "s3", "s4", "s5", "s6", "s7",
+            "s8", "s9", "s10", "s11", "t3", "t4", "t5", "t6"
+        };
+        return names[r & 0x1F];
+    }
+
+private:
+    static void set_imm(tb_disasm_inst &d, uint32_t imm)
+    {
+        d.imm     = imm;
+        d.has_imm = true;
+    }
+};
+
+//-----------------------------------------------------------------
+// tb_disasm_cache: Lazy, memoised disassembly by (pc, opcode)
+//-----------------------------------------------------------------
+class tb_disasm_cache
+{
+public:
+    const std::string &get(uint32_t pc, uint32_t opcode)
+    {
+        uint64_t key = ((uint64_t)pc << 32) | opcode;
+
+        std::map<uint64_t, std::string>::iterator it = m_cache.find(key);
+        if (it != m_cache.end())
+            return it->second;
+
+        if (m_cache.size() >= TB_DISASM_CACHE_MAX)
+            m_cache.clear();
+
+        return m_cache[key] = tb_disasm::format(pc, opcode);
+    }
+
+private:
+    std::map<uint64_t, std::string> m_cache;
+};
+
+#endif
@@ -0,0 +1,475 @@
+#include "tb_gdb.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+//-----------------------------------------------------------------
+// Helpers
+//-----------------------------------------------------------------
+static const char hex_chars[] = "0123456789abcdef";
+
+static int hex_value(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+static void append_hex8(std::string &s, uint8_t value)
+{
+    s += hex_chars[value >> 4];
+    s += hex_chars[value & 0xF];
+}
+
+static void append_hex32_le(std::string &s, uint32_t value)
+{
+    for (int i=0;i<4;i++)
+        append_hex8(s, (value >> (i*8)) & 0xFF);
+}
+
+//-----------------------------------------------------------------
+// Constructor
+//-----------------------------------------------------------------
+tb_gdb_server::tb_gdb_server(tb_gdb_target *target)
+{
+    m_target  = target;
+    m_fd      = -1;
+    m_step    = false;
+    m_running = false;
+    m_stop_pc = 0;
+}
+//-----------------------------------------------------------------
+// Destructor
+//-----------------------------------------------------------------
+tb_gdb_server::~tb_gdb_server()
+{
+    if (m_fd >= 0)
+        close(m_fd);
+}
+//-----------------------------------------------------------------
+// listen: Wait for a connection (TCP port or Unix socket path)
+//-----------------------------------------------------------------
+bool tb_gdb_server::listen(const char *addr)
+{
+    char *end = NULL;
+    long port = strtol(addr, &end, 0);
+    bool tcp  = (*end == 0);
+    int  srv;
+
+    if (tcp)
+    {
+        struct sockaddr_in sa;
+        memset(&sa, 0, sizeof(sa));
+        sa.sin_family      = AF_INET;
+        sa.sin_port        = htons((uint16_t)port);
+        sa.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+        int one = 1;
+        srv = socket(AF_INET, SOCK_STREAM, 0);
+        if (srv >= 0)
+            setsockopt(srv, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        if (srv < 0 || bind(srv, (struct sockaddr *)&sa, sizeof(sa)) < 0)
+        {
+            fprintf(stderr, "GDB: Could not bind to port %ld\n", port);
+            return false;
+        }
+    }
+    else
+    {
+        struct sockaddr_un sa;
+        memset(&sa, 0, sizeof(sa));
+        sa.sun_family = AF_UNIX;
+        strncpy(sa.sun_path, addr, sizeof(sa.sun_path) - 1);
+
+        unlink(addr);
+        srv = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (srv < 0 || bind(srv, (struct sockaddr *)&sa, sizeof(sa)) < 0)
+        {
+            fprintf(stderr, "GDB: Could not bind to %s\n", addr);
+            return false;
+        }
+    }
+
+    if (::listen(srv, 1) < 0)
+    {
+        close(srv);
+        return false;
+    }
+
+    printf("GDB: Waiting for connection on %s%s\n", tcp ? "localhost:" : "", addr);
+    fflush(stdout);
+
+    m_fd = accept(srv, NULL, NULL);
+    close(srv);
+
+    if (!tcp)
+        unlink(addr);
+
+    if (m_fd < 0)
+        return false;
+
+    if (tcp)
+    {
+        int one = 1;
+        setsockopt(m_fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    }
+
+    printf("GDB: Connected\n");
+    return true;
+}
+//-----------------------------------------------------------------
+// retire: Check retired instruction for step / breakpoint
+//-----------------------------------------------------------------
+bool tb_gdb_server::retire(uint32_t pc, uint32_t next_pc)
+{
+    if (m_fd < 0)
+        return false;
+
+    return m_step || m_breakpoints.count(next_pc);
+}
+//-----------------------------------------------------------------
+// poll_interrupt: Non-blocking check for Ctrl-C (0x03)
+//-----------------------------------------------------------------
+bool tb_gdb_server::poll_interrupt(void)
+{
+    if (m_fd < 0)
+        return false;
+
+    struct pollfd fds;
+    fds.fd      = m_fd;
+    fds.events  = POLLIN;
+    fds.revents = 0;
+
+    if (poll(&fds, 1, 0) <= 0)
+        return false;
+
+    uint8_t ch;
+    if (read(m_fd, &ch, 1) != 1)
+    {
+        // GDB went away - keep running
+        close(m_fd);
+        m_fd = -1;
+        return false;
+    }
+
+    return ch == 0x03;
+}
+//-----------------------------------------------------------------
+// stop: Report stop reason then serve GDB until resumed
+//-----------------------------------------------------------------
+void tb_gdb_server::stop(int signal, uint32_t pc)
+{
+    if (m_fd < 0)
+        return;
+
+    m_stop_pc = pc;
+
+    // Initial halt is reported in response to '?'
+    if (m_running)
+    {
+        char reply[8];
+        snprintf(reply, sizeof(reply), "S%02x", signal);
+        send_packet(reply);
+    }
+
+    std::string pkt;
+    while (m_fd >= 0 && recv_packet(pkt))
+    {
+        if (handle_packet(pkt))
+        {
+            m_running = true;
+            return;
+        }
+    }
+
+    // Connection lost - continue without debugger
+    if (m_fd >= 0)
+        close(m_fd);
+    m_fd = -1;
+}
+//-----------------------------------------------------------------
+// next_pc: Predict next PC (traps / interrupts are not predicted)
+//-----------------------------------------------------------------
+uint32_t tb_gdb_server::next_pc(uint32_t pc, uint32_t opcode, uint32_t ra, uint32_t rb)
+{
+    uint32_t funct3 = (opcode >> 12) & 0x7;
+
+    switch (opcode & 0x7F)
+    {
+        // JAL
+        case 0x6F:
+        {
+            uint32_t imm = ((opcode >> 31) & 1) << 20 | ((opcode >> 12) & 0xFF) << 12 |
+                           ((opcode >> 20) & 1) << 11 | ((opcode >> 21) & 0x3FF) << 1;
+            if (imm & (1 << 20))
+                imm |= 0xFFE00000;
+            return pc + imm;
+        }
+        // JALR
+        case 0x67:
+            return (ra + (uint32_t)((int32_t)opcode >> 20)) & ~1u;
+        // Branch
+        case 0x63:
+        {
+            bool taken;
+            switch (funct3)
+            {
+                case 0:  taken = (ra == rb); break;
+                case 1:  taken = (ra != rb); break;
+                case 4:  taken = ((int32_t)ra <  (int32_t)rb); break;
+                case 5:  taken = ((int32_t)ra >= (int32_t)rb); break;
+                case 6:  taken = (ra <  rb); break;
+                case 7:  taken = (ra >= rb); break;
+                default: taken = false; break;
+            }
+
+            if (!taken)
+                return pc + 4;
+
+            uint32_t imm = ((opcode >> 31) & 1) << 12 | ((opcode >> 7) & 1) << 11 |
+                           ((opcode >> 25) & 0x3F) << 5 | ((opcode >> 8) & 0xF) << 1;
+            if (imm & (1 << 12))
+                imm |= 0xFFFFE000;
+            return pc + imm;
+        }
+        default:
+            return pc + 4;
+    }
+}
+//-----------------------------------------------------------------
+// recv_packet: Receive '$data#cs' (acked), or break request
+//-----------------------------------------------------------------
+bool tb_gdb_server::recv_packet(std::string &pkt)
+{
+    pkt.clear();
+
+    bool    in_packet = false;
+    uint8_t ch;
+
+    while (read(m_fd, &ch, 1) == 1)
+    {
+        if (!in_packet)
+        {
+            if (ch == '$')
+                in_packet = true;
+            // Ctrl-C while already stopped
+            else if (ch == 0x03)
+            {
+                pkt = "?";
+                return true;
+            }
+            continue;
+        }
+
+        if (ch != '#')
+        {
+            pkt += (char)ch;
+            continue;
+        }
+
+        // Checksum
+        uint8_t cs[2];
+        if (read(m_fd, &cs[0], 1) != 1 || read(m_fd, &cs[1], 1) != 1)
+            return false;
+
+        uint8_t sum = 0;
+        for (size_t i=0;i<pkt.size();i++)
+            sum += (uint8_t)pkt[i];
+
+        if (((hex_value(cs[0]) << 4) | hex_value(cs[1])) != sum)
+        {
+            if (write(m_fd, "-", 1) != 1)
+                return false;
+            pkt.clear();
+            in_packet = false;
+            continue;
+        }
+
+        return write(m_fd, "+", 1) == 1;
+    }
+
+    return false;
+}
+//-----------------------------------------------------------------
+// send_packet: Send '$data#cs' and wait for ack
+//-----------------------------------------------------------------
+void tb_gdb_server::send_packet(const std::string &pkt)
+{
+    uint8_t sum = 0;
+    for (size_t i=0;i<pkt.size();i++)
+        sum += (uint8_t)pkt[i];
+
+    std::string frame = "$" + pkt + "#";
+    append_hex8(frame, sum);
+
+    for (int retry=0;retry<3;retry++)
+    {
+        if (write(m_fd, frame.c_str(), frame.size()) != (ssize_t)frame.size())
+            return;
+
+        uint8_t ack;
+        if (read(m_fd, &ack, 1) != 1 || ack != '-')
+            return;
+    }
+}
+//-----------------------------------------------------------------
+// handle_packet: Returns true when execution resumes
+//-----------------------------------------------------------------
+bool tb_gdb_server::handle_packet(const std::string &pkt)
+{
+    const char *p = pkt.c_str();
+
+    switch (p[0])
+    {
+        // Stop reason
+        case '?':
+            send_packet("S05");
+            return false;
+        // Registers
+        case 'g':
+            send_packet(read_registers());
+            return false;
+        case 'p':
+        {
+            uint32_t r = strtoul(p + 1, NULL, 16);
+            std::string reply;
+            if (r < 32)
+                append_hex32_le(reply, m_target->gdb_read_reg(r));
+            else if (r == 32)
+                append_hex32_le(reply, m_stop_pc);
+            else
+                reply = "xxxxxxxx";
+            send_packet(reply);
+            return false;
+        }
+        // Register writes are not supported
+        case 'G':
+        case 'P':
+            send_packet("E01");
+            return false;
+        // Memory
+        case 'm':
+        {
+            char *end;
+            uint32_t addr = strtoul(p + 1, &end, 16);
+            uint32_t len  = strtoul(end + 1, NULL, 16);
+            send_packet(read_memory(addr, len));
+            return false;
+        }
+        case 'M':
+        {
+            char *end;
+            uint32_t addr = strtoul(p + 1, &end, 16);
+            uint32_t len  = strtoul(end + 1, &end, 16);
+            send_packet(write_memory(addr, len, end + 1) ? "OK" : "E01");
+            return false;
+        }
+        // Execution
+        case 'c':
+            m_step = false;
+            return true;
+        case 's':
+            m_step = true;
+            return true;
+        // Breakpoints (software and hardware both match the retire PC)
+        case 'Z':
+        case 'z':
+        {
+            if (p[1] != '0' && p[1] != '1')
+            {
+                send_packet("");
+                return false;
+            }
+
+            uint32_t addr = strtoul(p + 3, NULL, 16);
+            if (p[0] == 'Z')
+                m_breakpoints.insert(addr);
+            else
+                m_breakpoints.erase(addr);
+            send_packet("OK");
+            return false;
+        }
+        case 'H':
+            send_packet("OK");
+            return false;
+        case 'q':
+            if (!strncmp(p, "qSupported", 10))
+                send_packet("PacketSize=1000");
+            else if (!strcmp(p, "qAttached"))
+                send_packet("1");
+            else
+                send_packet("");
+            return false;
+        // Detach: continue without debugger
+        case 'D':
+            send_packet("OK");
+            close(m_fd);
+            m_fd   = -1;
+            m_step = false;
+            return true;
+        // Kill
+        case 'k':
+            printf("GDB: Kill request\n");
+            exit(EXIT_SUCCESS);
+            return true;
+        default:
+            send_packet("");
+            return false;
+    }
+}
+//-----------------------------------------------------------------
+// read_registers: x0-x31, pc
+//-----------------------------------------------------------------
+std::string tb_gdb_server::read_registers(void)
+{
+    std::string reply;
+
+    for (int r=0;r<32;r++)
+        append_hex32_le(reply, r ? m_target->gdb_read_reg(r) : 0);
+
+    append_hex32_le(reply, m_stop_pc);
+    return reply;
+}
+//-----------------------------------------------------------------
+// read_memory
+//-----------------------------------------------------------------
+std::string tb_gdb_server::read_memory(uint32_t addr, uint32_t len)
+{
+    std::string reply;
+
+    for (uint32_t i=0;i<len;i++)
+    {
+        uint8_t data;
+        if (!m_target->gdb_read_mem(addr + i, data))
+            return i ? reply : "E01";
+        append_hex8(reply, data);
+    }
+
+    return reply;
+}
+//-----------------------------------------------------------------
+// write_memory
+//-----------------------------------------------------------------
+bool tb_gdb_server::write_memory(uint32_t addr, uint32_t len, const char *hex)
+{
+    if (strlen(hex) < len * 2)
+        return false;
+
+    for (uint32_t i=0;i<len;i++)
+    {
+        int hi = hex_value(hex[i*2 + 0]);
+        int lo = hex_value(hex[i*2 + 1]);
+        if (hi < 0 || lo < 0 || !m_target->gdb_write_mem(addr + i, (uint8_t)((hi << 4) | lo)))
+            return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,77 @@
+#ifndef TB_GDB_H
+#define TB_GDB_H
+
+#include <stdint.h>
+#include <string>
+#include <set>
+
+//-----------------------------------------------------------------
+// Defines
+//-----------------------------------------------------------------
+#define TB_GDB_NUM_REGS         33  // x0-x31, pc
+#define TB_GDB_POLL_CYCLES      4096
+#define TB_GDB_SIGINT           2
+#define TB_GDB_SIGTRAP          5
+
+//-----------------------------------------------------------------
+// tb_gdb_target: Access to the simulated core while stopped
+//-----------------------------------------------------------------
+class tb_gdb_target
+{
+public:
+    virtual uint32_t gdb_read_reg(int r) = 0;
+    virtual bool     gdb_read_mem(uint32_t addr, uint8_t &data) = 0;
+    virtual bool     gdb_write_mem(uint32_t addr, uint8_t data) = 0;
+};
+
+//-----------------------------------------------------------------
+// tb_gdb_server: GDB remote serial protocol stub.
+// The simulation is not traced or slowed down while running; each
+// retired instruction is checked against the breakpoint list and the
+// server takes over (blocking the simulation) when it hits.
+// Breakpoints match on the predicted next PC of a retired
+// instruction, so the core stops before the instruction executes
+// (the testbench disables dual issue while GDB is attached so no
+// second instruction retires alongside).
+//-----------------------------------------------------------------
+class tb_gdb_server
+{
+public:
+    tb_gdb_server(tb_gdb_target *target);
+    ~tb_gdb_server();
+
+    // Wait for GDB on TCP port (numeric) or Unix socket path
+    bool     listen(const char *addr);
+    bool     connected(void) { return m_fd >= 0; }
+
+    // Retired instruction - returns true if the core should stop
+    bool     retire(uint32_t pc, uint32_t next_pc);
+
+    // Check for a break request from GDB (Ctrl-C)
+    bool     poll_interrupt(void);
+
+    // Report stop and serve commands until continue / step
+    void     stop(int signal, uint32_t pc);
+
+    // Predict the next PC of a retired instruction
+    static uint32_t next_pc(uint32_t pc, uint32_t opcode, uint32_t ra, uint32_t rb);
+
+protected:
+    bool        recv_packet(std::string &pkt);
+    void        send_packet(const std::string &pkt);
+    bool        handle_packet(const std::string &pkt);
+
+    std::string read_registers(void);
+    std::string read_memory(uint32_t addr, uint32_t len);
+    bool        write_memory(uint32_t addr, uint32_t len, const char *hex);
+
+    tb_gdb_target *     m_target;
+    int                 m_fd;
+
+    std::set <uint32_t> m_breakpoints;
+    bool                m_step;
+    bool                m_running;
+    uint32_t            m_stop_pc;
+};
+
+#endif
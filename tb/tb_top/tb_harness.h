@@ -0,0 +1,229 @@
+#ifndef TB_HARNESS_H
+#define TB_HARNESS_H
+
+#include "testbench_vbase.h"
+#include "mem_api.h"
+#include "riscv_top.h"
+#include "tb_axi4_mem.h"
+#include "tb_axi4_interconnect.h"
+#include "tb_periph.h"
+
+//-----------------------------------------------------------------
+// tb_harness: riscv_top with the shared AXI memory and peripheral
+// models (CLINT, UART-Lite, PLIC). Front ends (test.x testbench,
+// libbiriscv) derive from it and drive the core from process() /
+// monitor(), calling clock_peripherals() once per cycle.
+//-----------------------------------------------------------------
+class tb_harness: public testbench_vbase, public mem_api
+{
+public:
+    //-----------------------------------------------------------------
+    // Instances / Members
+    //-----------------------------------------------------------------
+    riscv_top                   *m_dut;
+    tb_axi4_interconnect        *m_interconnect;
+    tb_axi4_mem                 *m_mem;
+
+    tb_clint                    *m_clint;
+    tb_uart_lite                *m_uart;
+    tb_plic                     *m_plic;
+
+    sc_signal <axi4_slave>      mem_i_in;
+    sc_signal <axi4_master>     mem_i_out;
+
+    sc_signal <axi4_slave>      mem_d_in;
+    sc_signal <axi4_master>     mem_d_out;
+
+    sc_signal <axi4_slave>      mem_in;
+    sc_signal <axi4_master>     mem_out;
+
+    sc_signal < bool >          intr_in;
+
+    sc_signal < sc_uint <32> >  reset_vector_in;
+
+    // Core reset (power-on reset OR front end requested)
+    sc_signal < bool >          rst_cpu_in;
+    sc_signal < bool >          dut_rst_in;
+
+    //-----------------------------------------------------------------
+    // Construction
+    //-----------------------------------------------------------------
+    SC_HAS_PROCESS(tb_harness);
+    tb_harness(sc_module_name name): testbench_vbase(name)
+    {
+        m_dut = new riscv_top("DUT");
+        m_dut->clk_in(clk);
+        m_dut->rst_in(dut_rst_in);
+        m_dut->axi_i_out(mem_i_out);
+        m_dut->axi_i_in(mem_i_in);
+        m_dut->axi_d_out(mem_d_out);
+        m_dut->axi_d_in(mem_d_in);
+        m_dut->intr_in(intr_in);
+        m_dut->reset_vector_in(reset_vector_in);
+
+        // Instruction / Data ports share one memory
+        m_interconnect = new tb_axi4_interconnect("INTERCONNECT", 2);
+        m_interconnect->clk_in(clk);
+        m_interconnect->rst_in(rst);
+        m_interconnect->axi_in[0](mem_i_out);
+        m_interconnect->axi_out[0](mem_i_in);
+        m_interconnect->axi_in[1](mem_d_out);
+        m_interconnect->axi_out[1](mem_d_in);
+        m_interconnect->mem_out(mem_out);
+        m_interconnect->mem_in(mem_in);
+        m_interconnect->set_port_name(0, "icache");
+        m_interconnect->set_port_name(1, "dcache");
+
+        // Memory
+        m_mem = new tb_axi4_mem("MEM");
+        m_mem->clk_in(clk);
+        m_mem->rst_in(rst);
+        m_mem->axi_in(mem_out);
+        m_mem->axi_out(mem_in);
+
+        // Peripherals (uncached data accesses)
+        m_clint = new tb_clint(CLINT_BASE);
+        m_uart  = new tb_uart_lite(UART_LITE_BASE);
+        m_plic  = new tb_plic(PLIC_BASE);
+        m_plic->add_source(PLIC_SRC_UART, m_uart);
+
+        m_mem->add_device(m_clint);
+        m_mem->add_device(m_uart);
+        m_mem->add_device(m_plic);
+
+        SC_METHOD(reset_mux);
+        sensitive << rst << rst_cpu_in;
+    }
+
+    //-----------------------------------------------------------------
+    // reset_mux: Core reset
+    //-----------------------------------------------------------------
+    void reset_mux(void)
+    {
+        dut_rst_in.write(rst.read() || rst_cpu_in.read());
+    }
+
+    //-----------------------------------------------------------------
+    // finish_hook: Verilog $finish - true if the front end keeps the
+    // model running (vl_finish returns instead of exiting)
+    //-----------------------------------------------------------------
+    virtual bool finish_hook(void) { return false; }
+
+    //-----------------------------------------------------------------
+    // clock_peripherals: Once per core cycle
+    //-----------------------------------------------------------------
+    void clock_peripherals(void)
+    {
+        m_clint->clock();
+        m_uart->clock();
+        m_plic->clock();
+        intr_in.write(m_plic->irq() || m_clint->irq());
+    }
+
+    //-----------------------------------------------------------------
+    // reset_peripherals: Back to power-on state
+    //-----------------------------------------------------------------
+    void reset_peripherals(void)
+    {
+        m_clint->reset();
+        m_uart->reset();
+        m_plic->reset();
+    }
+
+    //-----------------------------------------------------------------
+    // cpu_halt: Hold the core in reset
+    //-----------------------------------------------------------------
+    void cpu_halt(void)
+    {
+        // Outstanding bursts must complete before the core forgets them
+        while (!m_interconnect->idle())
+            wait();
+
+        // Reset invalidates the write-back data cache (same delta as
+        // the reset, so no store can land in between)
+        if (!rst_cpu_in.read())
+            dcache_writeback();
+
+        rst_cpu_in.write(true);
+        wait();
+        wait();
+    }
+
+    //-----------------------------------------------------------------
+    // cpu_release: Release core from reset at reset_vector
+    //-----------------------------------------------------------------
+    void cpu_release(uint32_t reset_vector)
+    {
+        reset_vector_in.write(reset_vector);
+        wait();
+        rst_cpu_in.write(false);
+    }
+
+    //-----------------------------------------------------------------
+    // dcache_writeback: Copy dirty data cache lines to memory
+    //-----------------------------------------------------------------
+    int dcache_writeback(void)
+    {
+        uint32_t words[RISCV_DCACHE_LINE_WORDS];
+        uint8_t  data[RISCV_DCACHE_LINE_WORDS * 4];
+        uint32_t addr;
+        int      lines = 0;
+
+        for (int way=0;way<RISCV_DCACHE_WAYS;way++)
+            for (int line=0;line<RISCV_DCACHE_LINES;line++)
+            {
+                if (!m_dut->get_dcache_dirty(way, line, addr, words))
+                    continue;
+
+                for (int i=0;i<RISCV_DCACHE_LINE_WORDS;i++)
+                    for (int b=0;b<4;b++)
+                        data[(i * 4) + b] = words[i] >> (8 * b);
+
+                if (!write_block(addr, data, sizeof(data)))
+                    fprintf(stderr, "WARNING: Dirty line 0x%08x not in memory\n", addr);
+                lines++;
+            }
+
+        return lines;
+    }
+
+    //-----------------------------------------------------------------
+    // create_memory: Create memory region
+    //-----------------------------------------------------------------
+    bool create_memory(uint32_t base, uint32_t size, uint8_t *mem = NULL)
+    {
+        base = base & ~(32-1);
+        size = (size + 31) & ~(32-1);
+
+        // Already covered (e.g. by --ram-size)
+        if (m_mem->valid_addr(base) && m_mem->valid_addr(base + size - 1))
+            return true;
+
+        while (m_mem->valid_addr(base))
+            base += 1;
+
+        while (m_mem->valid_addr(base + size - 1))
+            size -= 1;
+
+        // Zero filled on demand
+        return m_mem->add_region(base, size);
+    }
+    //-----------------------------------------------------------------
+    // write_block: Bulk copy (falls back to bytes across regions)
+    //-----------------------------------------------------------------
+    bool write_block(uint32_t addr, const uint8_t *data, uint32_t size)
+    {
+        if (m_mem->write_block(addr, data, size))
+            return true;
+
+        return mem_api::write_block(addr, data, size);
+    }
+    //-----------------------------------------------------------------
+    // valid_addr / write / read: Byte access
+    //-----------------------------------------------------------------
+    bool    valid_addr(uint32_t addr)             { return m_mem->valid_addr(addr); }
+    void    write(uint32_t addr, uint8_t data)    { m_mem->write(addr, data); }
+    uint8_t read(uint32_t addr)                   { return m_mem->read(addr); }
+};
+
+#endif
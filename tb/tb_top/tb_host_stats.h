@@ -0,0 +1,298 @@
+#ifndef TB_HOST_STATS_H
+#define TB_HOST_STATS_H
+
+#include <systemc.h>
+#include <stdint.h>
+#include <signal.h>
+#include <string.h>
+#include <time.h>
+#include <sys/time.h>
+#include <execinfo.h>
+#include <dlfcn.h>
+#include <vector>
+
+//-----------------------------------------------------------------
+// Defines
+//-----------------------------------------------------------------
+#define TB_HOST_SAMPLE_HZ       1000
+#define TB_HOST_STACK_DEPTH     16
+#define TB_HOST_STACK_MAX       16384   // Kernel sample stacks kept
+#define TB_HOST_PROGRESS_CHECK  4096    // Cycles between clock reads
+
+//-----------------------------------------------------------------
+// Host time categories
+//-----------------------------------------------------------------
+enum eTB_HOST_CAT
+{
+    TB_HOST_KERNEL,
+    TB_HOST_EVAL,
+    TB_HOST_PINS,
+    TB_HOST_MEM,
+    TB_HOST_INTERCONNECT,
+    TB_HOST_TESTBENCH,
+    TB_HOST_TRACE,
+    TB_HOST_OTHER,
+    TB_HOST_CAT_MAX
+};
+
+//-----------------------------------------------------------------
+// tb_host_stats: Where the simulator spends host CPU time.
+// A profiling timer (SIGPROF) samples the running SystemC process,
+// which is mapped to a category by module. Samples taken outside a
+// process belong to the kernel, unless the stack shows trace file
+// output (needs libsystemc as a shared library for symbols).
+// Also prints a periodic progress line.
+//-----------------------------------------------------------------
+class tb_host_stats
+{
+public:
+    tb_host_stats(double interval = 0)
+    {
+        for (int i=0;i<TB_HOST_CAT_MAX;i++)
+            m_samples[i] = 0;
+        m_stacks       = NULL;
+        m_stack_count  = 0;
+        m_interval     = interval;
+        m_start        = now();
+        m_cpu_start    = cpu_time();
+        m_cpu          = 0;
+        m_last         = m_start;
+        m_last_cycles  = 0;
+    }
+
+    ~tb_host_stats()
+    {
+        stop();
+        delete [] m_stacks;
+    }
+
+    //-----------------------------------------------------------------
+    // add: Attribute processes below obj to a category (later wins)
+    //-----------------------------------------------------------------
+    void add(sc_object *obj, int cat, bool recursive = true)
+    {
+        const std::vector<sc_object*> &child = obj->get_child_objects();
+        for (size_t i=0;i<child.size();i++)
+        {
+            sc_process_b *proc = dynamic_cast<sc_process_b*>(child[i]);
+            if (proc)
+            {
+                size_t j;
+                for (j=0;j<m_procs.size();j++)
+                    if (m_procs[j].proc == proc)
+                        break;
+
+                if (j == m_procs.size())
+                    m_procs.push_back(proc_cat(proc, cat));
+                else
+                    m_procs[j].cat = cat;
+            }
+            else if (recursive)
+                add(child[i], cat, recursive);
+        }
+    }
+
+    //-----------------------------------------------------------------
+    // start: Arm the profiling timer
+    //-----------------------------------------------------------------
+    bool start(int hz = TB_HOST_SAMPLE_HZ)
+    {
+        m_stacks = new void*[TB_HOST_STACK_MAX * TB_HOST_STACK_DEPTH];
+
+        // First backtrace() loads the unwinder - not in the handler
+        void *dummy[2];
+        backtrace(dummy, 2);
+
+        instance() = this;
+
+        struct sigaction sa;
+        memset(&sa, 0, sizeof(sa));
+        sa.sa_handler = sample;
+        sa.sa_flags   = SA_RESTART;
+        sigemptyset(&sa.sa_mask);
+        if (sigaction(SIGPROF, &sa, NULL) < 0)
+            return false;
+
+        struct itimerval timer;
+        timer.it_interval.tv_sec  = 0;
+        timer.it_interval.tv_usec = 1000000 / hz;
+        timer.it_value            = timer.it_interval;
+        return setitimer(ITIMER_PROF, &timer, NULL) == 0;
+    }
+
+    void stop(void)
+    {
+        if (instance() != this)
+            return;
+
+        struct itimerval timer;
+        memset(&timer, 0, sizeof(timer));
+        setitimer(ITIMER_PROF, &timer, NULL);
+        signal(SIGPROF, SIG_IGN);
+        instance() = NULL;
+
+        m_cpu = cpu_time() - m_cpu_start;
+        classify_stacks();
+    }
+
+    //-----------------------------------------------------------------
+    // progress: Print progress line every interval (host seconds)
+    //-----------------------------------------------------------------
+    void progress(uint64_t cycles, uint64_t instret)
+    {
+        double t = now();
+        if (m_interval <= 0 || (t - m_last) < m_interval)
+            return;
+
+        printf("PROGRESS: %.1fs cycles=%lu (%.1f kHz) instret=%lu IPC=%.3f\n",
+               t - m_start, (unsigned long)cycles, (cycles - m_last_cycles) / (t - m_last) / 1000.0,
+               (unsigned long)instret, cycles ? (double)instret / cycles : 0.0);
+        fflush(stdout);
+
+        m_last        = t;
+        m_last_cycles = cycles;
+    }
+
+    //-----------------------------------------------------------------
+    // print: Final breakdown
+    //-----------------------------------------------------------------
+    void print(uint64_t cycles, uint64_t instret)
+    {
+        static const char *names[TB_HOST_CAT_MAX] =
+        {
+            "SystemC kernel",
+            "Verilator eval",
+            "riscv_top async_outputs",
+            "tb_axi4_mem",
+            "tb_axi4_interconnect",
+            "testbench / peripherals",
+            "Tracing",
+            "Other"
+        };
+
+        double   wall  = now() - m_start;
+        uint64_t total = 0;
+        for (int i=0;i<TB_HOST_CAT_MAX;i++)
+            total += m_samples[i];
+
+        if (!total)
+            return;
+
+        // Timer granularity varies - share out measured CPU time
+        printf("Host: %.2fs wall, %.2fs CPU (%lu samples), %lu cycles (%.1f kHz), %lu instructions (IPC %.3f)\n",
+               wall, m_cpu, (unsigned long)total, (unsigned long)cycles, wall > 0 ? cycles / wall / 1000.0 : 0.0,
+               (unsigned long)instret, cycles ? (double)instret / cycles : 0.0);
+
+        for (int i=0;i<TB_HOST_CAT_MAX;i++)
+            if (m_samples[i])
+                printf("Host:   %-24s %8.2fs %5.1f%%\n", names[i], m_cpu * m_samples[i] / total,
+                       100.0 * m_samples[i] / total);
+    }
+
+    static double now(void)
+    {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ts.tv_sec + ts.tv_nsec / 1e9;
+    }
+
+    static double cpu_time(void)
+    {
+        struct timespec ts;
+        clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+        return ts.tv_sec + ts.tv_nsec / 1e9;
+    }
+
+protected:
+    //-----------------------------------------------------------------
+    // sample: SIGPROF handler
+    //-----------------------------------------------------------------
+    static void sample(int sig)
+    {
+        tb_host_stats *s = instance();
+        if (!s)
+            return;
+
+        sc_process_b *proc = sc_get_current_process_b();
+        int           cat  = TB_HOST_KERNEL;
+
+        if (proc)
+        {
+            cat = TB_HOST_OTHER;
+            for (size_t i=0;i<s->m_procs.size();i++)
+                if (s->m_procs[i].proc == proc)
+                {
+                    cat = s->m_procs[i].cat;
+                    break;
+                }
+        }
+        else if (s->m_stack_count < TB_HOST_STACK_MAX)
+        {
+            void **stack = &s->m_stacks[s->m_stack_count * TB_HOST_STACK_DEPTH];
+            int depth = backtrace(stack, TB_HOST_STACK_DEPTH);
+            for (int i=depth;i<TB_HOST_STACK_DEPTH;i++)
+                stack[i] = NULL;
+            s->m_stack_count++;
+        }
+
+        s->m_samples[cat]++;
+    }
+
+    //-----------------------------------------------------------------
+    // classify_stacks: Split kernel samples into kernel / tracing
+    //-----------------------------------------------------------------
+    void classify_stacks(void)
+    {
+        if (!m_stack_count)
+            return;
+
+        uint64_t trace = 0;
+        for (uint64_t i=0;i<m_stack_count;i++)
+        {
+            void **stack = &m_stacks[i * TB_HOST_STACK_DEPTH];
+            for (int j=0;j<TB_HOST_STACK_DEPTH && stack[j];j++)
+            {
+                Dl_info info;
+                if (dladdr(stack[j], &info) && info.dli_sname && strstr(info.dli_sname, "trace_file"))
+                {
+                    trace++;
+                    break;
+                }
+            }
+        }
+
+        // Stacks are only kept for the first samples - scale
+        uint64_t moved = (uint64_t)((double)m_samples[TB_HOST_KERNEL] * trace / m_stack_count);
+        m_samples[TB_HOST_KERNEL] -= moved;
+        m_samples[TB_HOST_TRACE]  += moved;
+        m_stack_count = 0;
+    }
+
+    static tb_host_stats *&instance(void)
+    {
+        static tb_host_stats *s = NULL;
+        return s;
+    }
+
+    struct proc_cat
+    {
+        proc_cat(sc_process_b *p, int c) : proc(p), cat(c) { }
+        sc_process_b *proc;
+        int           cat;
+    };
+
+    std::vector <proc_cat> m_procs;
+
+    volatile uint64_t  m_samples[TB_HOST_CAT_MAX];
+    void **            m_stacks;
+    volatile uint64_t  m_stack_count;
+
+    double             m_interval;
+    double             m_start;
+    double             m_cpu_start;
+    double             m_cpu;
+    double             m_last;
+    uint64_t           m_last_cycles;
+};
+
+#endif
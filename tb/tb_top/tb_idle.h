@@ -0,0 +1,119 @@
+#ifndef TB_IDLE_H
+#define TB_IDLE_H
+
+#include <stdint.h>
+
+//-----------------------------------------------------------------
+// Defines
+//-----------------------------------------------------------------
+#define TB_IDLE_THRESHOLD       8
+#define TB_IDLE_MAX_LOOP_LEN    64
+
+//-----------------------------------------------------------------
+// tb_idle_detect: Detect a core that is waiting for an interrupt.
+// The retired instruction stream is split into loop iterations at
+// backward control flow. When the same iteration (PCs and opcodes)
+// repeats without any store, AMO or CSR write, the core is waiting
+// for an external event or for time to pass. Results are not
+// compared, so loops polling mcycle / time / CLINT mtime or counting
+// a register down are detected too; skipping ahead just makes the
+// awaited time arrive sooner.
+// WFI retires as a NOP on this core, so 'wfi; j 1b' is handled
+// as a spin loop.
+//-----------------------------------------------------------------
+class tb_idle_detect
+{
+public:
+    tb_idle_detect(int threshold = TB_IDLE_THRESHOLD)
+    {
+        m_threshold = threshold;
+        reset();
+    }
+
+    //-------------------------------------------------------------
+    // reset: Restart detection
+    //-------------------------------------------------------------
+    void reset(void)
+    {
+        m_prev_pc      = 0;
+        m_hash         = 0;
+        m_len          = 0;
+        m_side_effects = false;
+        m_last_hash    = 0;
+        m_last_len     = 0;
+        m_repeats      = 0;
+    }
+
+    //-------------------------------------------------------------
+    // retire: Feed a retired instruction (in program order)
+    //-------------------------------------------------------------
+    void retire(uint32_t pc, uint32_t opcode)
+    {
+        // Backward control flow: iteration boundary
+        if (m_len && pc <= m_prev_pc)
+        {
+            bool match = !m_side_effects && m_len <= TB_IDLE_MAX_LOOP_LEN &&
+                         m_hash == m_last_hash && m_len == m_last_len;
+
+            m_repeats      = match ? (m_repeats + 1) : 0;
+            m_last_hash    = m_hash;
+            m_last_len     = m_len;
+            m_hash         = 0;
+            m_len          = 0;
+            m_side_effects = false;
+        }
+
+        m_hash = (m_hash * 31) ^ pc;
+        m_hash = (m_hash * 31) ^ opcode;
+        m_len++;
+
+        m_side_effects |= side_effect(opcode);
+        m_prev_pc       = pc;
+    }
+
+    //-------------------------------------------------------------
+    // idle: Core is spinning
+    //-------------------------------------------------------------
+    bool idle(void) { return m_repeats >= m_threshold; }
+
+protected:
+    //-------------------------------------------------------------
+    // side_effect: Instruction changes state visible outside the loop
+    //-------------------------------------------------------------
+    static bool side_effect(uint32_t opcode)
+    {
+        uint32_t funct3 = (opcode >> 12) & 0x7;
+        uint32_t rs1    = (opcode >> 15) & 0x1F;
+
+        switch (opcode & 0x7F)
+        {
+            case 0x23: // Store
+            case 0x2F: // AMO
+                return true;
+            case 0x73: // System
+                // WFI
+                if (opcode == 0x10500073)
+                    return false;
+                // ECALL, EBREAK, xRET, SFENCE.VMA
+                if (funct3 == 0)
+                    return true;
+                // CSRRW / CSRRWI always write, others only when rs1 / uimm != 0
+                return (funct3 & 0x3) == 0x1 || rs1 != 0;
+            default:
+                return false;
+        }
+    }
+
+    int      m_threshold;
+
+    uint32_t m_prev_pc;
+    uint64_t m_hash;
+    uint32_t m_len;
+    bool     m_side_effects;
+
+    uint64_t m_last_hash;
+    uint32_t m_last_len;
+    int      m_repeats;
+};
+
+#endif
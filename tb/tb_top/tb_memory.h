@@ -1,13 +1,30 @@
 #ifndef TB_MEMORY_H
 #define TB_MEMORY_H
 
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "tb_periph.h"
+
+// Verilator-only benches (tb_dpi) build without SystemC
+#ifdef TB_MEMORY_NO_SYSTEMC
+#include <assert.h>
+#define TB_MEM_ASSERT(x)    assert(x)
+#else
 #include <systemc.h>
-#include <queue>
+#define TB_MEM_ASSERT(x)    sc_assert(x)
+#endif
 
 #define TB_MEM_MAX_REGIONS    10
 
 //-----------------------------------------------------------------
 // tb_mem_region: Memory region entity
+// Backing store is anonymous mmap'd memory - zero filled on demand,
+// host pages are only committed when first written.
 //-----------------------------------------------------------------
 class tb_mem_region
 {
@@ -16,16 +33,37 @@ public:
     {
         m_base    = base;
         m_size    = size;
-        m_mem     = pMem ? pMem : new uint8_t[size];
+        m_owner   = (pMem == NULL);
+        m_mem     = pMem ? pMem : alloc(size);
         m_trace   = false;
     }
 
+    ~tb_mem_region()
+    {
+        if (m_owner)
+            munmap(m_mem, m_size);
+    }
+
     uint32_t get_base(void) { return m_base; }
     uint32_t get_size(void) { return m_size; }
 
+    // Offset compare - no overflow for regions ending at 0xFFFFFFFF
     bool match(uint32_t addr)
     {
-        return (addr >= m_base) && (addr < (m_base + m_size));
+        return (addr - m_base) < m_size;
+    }
+
+    // contains: [addr, addr + size) lies inside the region
+    bool contains(uint32_t addr, uint32_t size)
+    {
+        return match(addr) && size <= m_size - (addr - m_base);
+    }
+
+    // overlaps: [base, base + size) intersects the region
+    bool overlaps(uint32_t base, uint32_t size)
+    {
+        return (uint64_t)base < (uint64_t)m_base + m_size &&
+               (uint64_t)m_base < (uint64_t)base + size;
     }
 
     void write(uint32_t addr, uint8_t data)
@@ -51,36 +89,51 @@ public:
     uint8_t *get_array(void)        { return m_mem; }
     void     trace_access(bool en)  { m_trace = en; }
 
+    //-------------------------------------------------------------
+    // get_resident: Host memory actually in use (bytes)
+    //-------------------------------------------------------------
+    uint64_t get_resident(void)
+    {
+        if (!m_owner)
+            return m_size;
+
+        long page_size = sysconf(_SC_PAGESIZE);
+        size_t pages   = ((size_t)m_size + page_size - 1) / page_size;
+
+        std::vector <unsigned char> vec(pages);
+        if (mincore(m_mem, m_size, &vec[0]) != 0)
+            return m_size;
+
+        uint64_t resident = 0;
+        for (size_t i=0;i<pages;i++)
+            if (vec[i] & 1)
+                resident += page_size;
+
+        return resident;
+    }
+
 protected:
+    static uint8_t *alloc(uint32_t size)
+    {
+        void *mem = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (mem == MAP_FAILED)
+        {
+            printf("ERROR: Could not allocate %u bytes\n", size);
+            TB_MEM_ASSERT(0);
+        }
+
+        return (uint8_t*)mem;
+    }
+
     uint32_t    m_base;
     uint32_t    m_size;
 
     uint8_t *   m_mem;
+    bool        m_owner;
 
     bool        m_trace;
 };
 
-//-----------------------------------------------------------------
-// tb_mem_record: Transaction detail
-//-----------------------------------------------------------------
-class tb_mem_record
-{
-public:
-    tb_mem_record(bool write, uint32_t addr, uint8_t data)
-    {
-        m_time     = sc_time_stamp();
-        m_is_write = write;
-        m_addr     = addr;
-        m_data     = data;
-    }
-
-public:
-    sc_time  m_time;
-    bool     m_is_write;
-    uint32_t m_addr;
-    uint8_t  m_data;
-};
-
 //-----------------------------------------------------------------
 // tb_memory: Memory base class
 //-----------------------------------------------------------------
@@ -91,8 +144,6 @@ public:
     {
         for (int i=0;i<TB_MEM_MAX_REGIONS;i++)
             m_mem[i] = NULL;
-
-        m_record_accesses = false;
     }
 
     bool add_region(uint32_t base, uint32_t size)
@@ -104,7 +155,7 @@ public:
                 return true;
             }
             // Detect overlapping regions
-            else if (m_mem[i]->match(base) || m_mem[i]->match(base + size - 1))
+            else if (m_mem[i]->overlaps(base, size))
                 return false;
         return false;
     }
@@ -118,11 +169,23 @@ public:
                 return true;
             }
             // Detect overlapping regions
-            else if (m_mem[i]->match(base) || m_mem[i]->match(base + size - 1))
+            else if (m_mem[i]->overlaps(base, size))
                 return false;
         return false;
     }
 
+    //-------------------------------------------------------------
+    // clear: Release all regions
+    //-------------------------------------------------------------
+    void clear(void)
+    {
+        for (int i=0;i<TB_MEM_MAX_REGIONS;i++)
+        {
+            delete m_mem[i];
+            m_mem[i] = NULL;
+        }
+    }
+
     bool valid_addr(uint32_t addr)
     {
         for (int i=0;i<TB_MEM_MAX_REGIONS;i++)
@@ -143,9 +206,6 @@ public:
     {
         bool found = false;
 
-        if (m_record_accesses)
-            m_accesses.push(tb_mem_record(true, addr, data));
-
         for (int i=0;i<TB_MEM_MAX_REGIONS && !found;i++)
             if (m_mem[i] && m_mem[i]->match(addr))
             {
@@ -156,7 +216,7 @@ public:
         if (!found)
         {
             printf("ERROR: Write out of range 0x%08x\n", addr);
-            sc_assert(0);
+            TB_MEM_ASSERT(0);
         }
     }
 
@@ -165,17 +225,40 @@ public:
         for (int i=0;i<TB_MEM_MAX_REGIONS;i++)
             if (m_mem[i] && m_mem[i]->match(addr))
             {
-                uint8_t data = m_mem[i]->read(addr);
-                if (m_record_accesses)
-                    m_accesses.push(tb_mem_record(false, addr, data));
-                return data;
+                return m_mem[i]->read(addr);
             }
 
         printf("ERROR: Read out of range 0x%08x\n", addr);
-        sc_assert(0);
+        TB_MEM_ASSERT(0);
         return 0;
     }
 
+    //-------------------------------------------------------------
+    // write_block: Bulk copy into a single region (false if not mapped)
+    //-------------------------------------------------------------
+    bool write_block(uint32_t addr, const uint8_t *data, uint32_t size)
+    {
+        for (int i=0;i<TB_MEM_MAX_REGIONS;i++)
+            if (m_mem[i] && m_mem[i]->contains(addr, size))
+            {
+                memcpy(m_mem[i]->get_array() + (addr - m_mem[i]->get_base()), data, size);
+                return true;
+            }
+
+        return false;
+    }
+
+    void add_device(tb_device *dev) { m_devices.push_back(dev); }
+
+    tb_device* find_device(uint32_t addr)
+    {
+        for (size_t i=0;i<m_devices.size();i++)
+            if (m_devices[i]->match(addr))
+                return m_devices[i];
+
+        return NULL;
+    }
+
     uint8_t* get_array(uint32_t addr)
     {
         for (int i=0;i<TB_MEM_MAX_REGIONS;i++)
@@ -183,18 +266,34 @@ public:
                 return m_mem[i]->get_array();
 
         printf("ERROR: Access out of range 0x%08x\n", addr);
-        sc_assert(0);
+        TB_MEM_ASSERT(0);
         return NULL;
     }
 
-    void          records_enable(bool enable) { m_record_accesses = enable; }
-    bool          records_available(void)     { return m_accesses.size() != 0; }
-    tb_mem_record records_pop(void)           { tb_mem_record v = m_accesses.front(); m_accesses.pop(); return v; }
+    //-------------------------------------------------------------
+    // get_allocated / get_resident: Guest vs host memory (bytes)
+    //-------------------------------------------------------------
+    uint64_t get_allocated(void)
+    {
+        uint64_t size = 0;
+        for (int i=0;i<TB_MEM_MAX_REGIONS;i++)
+            if (m_mem[i])
+                size += m_mem[i]->get_size();
+        return size;
+    }
+
+    uint64_t get_resident(void)
+    {
+        uint64_t size = 0;
+        for (int i=0;i<TB_MEM_MAX_REGIONS;i++)
+            if (m_mem[i])
+                size += m_mem[i]->get_resident();
+        return size;
+    }
 
 protected:
     tb_mem_region *            m_mem[TB_MEM_MAX_REGIONS];
-    bool                       m_record_accesses;
-    std::queue <tb_mem_record> m_accesses;
+    std::vector <tb_device *>  m_devices;
 };
 
 #endif
\ No newline at end of file
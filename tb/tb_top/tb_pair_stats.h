@@ -0,0 +1,236 @@
+#ifndef TB_PAIR_STATS_H
+#define TB_PAIR_STATS_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <map>
+#include <vector>
+#include <algorithm>
+#include <string>
+
+#include "tb_stats.h"
+
+//-----------------------------------------------------------------
+// Defines
+//-----------------------------------------------------------------
+#define TB_PAIR_TOP_PCS     8
+
+//-----------------------------------------------------------------
+// Pairing failure reasons (biriscv_issue.v: pairing_reason)
+//-----------------------------------------------------------------
+enum eTB_PAIR_REASON
+{
+    TB_PAIR_NONE,
+    TB_PAIR_DISABLED,
+    TB_PAIR_ALIGN,
+    TB_PAIR_FETCH,
+    TB_PAIR_BRANCH,
+    TB_PAIR_DIV_CSR,
+    TB_PAIR_PIPE0_ONLY,
+    TB_PAIR_LSU,
+    TB_PAIR_MUL,
+    TB_PAIR_COMBINATION,
+    TB_PAIR_RAW,
+    TB_PAIR_INFLIGHT,
+    TB_PAIR_REASON_MAX
+};
+
+//-----------------------------------------------------------------
+// Instruction classes (opcode pair histogram)
+//-----------------------------------------------------------------
+enum eTB_PAIR_CLASS
+{
+    TB_PAIR_CLASS_ALU,
+    TB_PAIR_CLASS_MUL,
+    TB_PAIR_CLASS_DIV,
+    TB_PAIR_CLASS_LOAD,
+    TB_PAIR_CLASS_STORE,
+    TB_PAIR_CLASS_BRANCH,
+    TB_PAIR_CLASS_JUMP,
+    TB_PAIR_CLASS_CSR,
+    TB_PAIR_CLASS_OTHER,
+    TB_PAIR_CLASS_NONE,
+    TB_PAIR_CLASS_MAX
+};
+
+//-----------------------------------------------------------------
+// tb_pair_stats: Classify each single issue cycle by the reason the
+// second instruction could not issue alongside the first.
+// Keeps a count per reason, per (slot A, slot B) instruction class
+// and per slot A PC. Totals are published to tb_stats under group.
+//-----------------------------------------------------------------
+class tb_pair_stats
+{
+public:
+    tb_pair_stats(const std::string &group = "pair")
+        : m_single(group, "single_issue_cycles", "Issue cycles with one instruction")
+        , m_dual(group, "dual_issue_cycles", "Issue cycles with two instructions")
+        , m_reason(group, "single_issue_reason", TB_PAIR_REASON_MAX, reason_names(), "Why B did not issue with A")
+    {
+        reset();
+
+        // Pair / PC tables live outside the registry
+        tb_stats::instance().add_reset_hook(this, [this]() { reset(); });
+    }
+    ~tb_pair_stats()
+    {
+        tb_stats::instance().remove_reset_hook(this);
+    }
+
+    //-------------------------------------------------------------
+    // reset: Clear pair / PC tables (totals are tb_stats counters)
+    //-------------------------------------------------------------
+    void reset(void)
+    {
+        for (int r=0;r<TB_PAIR_REASON_MAX;r++)
+        {
+            for (int a=0;a<TB_PAIR_CLASS_MAX;a++)
+                for (int b=0;b<TB_PAIR_CLASS_MAX;b++)
+                    m_pair[r][a][b] = 0;
+            m_pcs[r].clear();
+        }
+    }
+
+    //-------------------------------------------------------------
+    // sample: One cycle of issue state
+    //-------------------------------------------------------------
+    void sample(bool dual, int reason, uint32_t pc, uint32_t opcode_a, uint32_t opcode_b)
+    {
+
+        if (dual)
+        {
+            m_dual++;
+            return;
+        }
+
+        if (reason <= TB_PAIR_NONE || reason >= TB_PAIR_REASON_MAX)
+            return;
+
+        // No second instruction to classify
+        bool has_b = (reason != TB_PAIR_ALIGN && reason != TB_PAIR_FETCH);
+
+        m_single++;
+        m_reason[reason]++;
+        m_pair[reason][classify(opcode_a)][has_b ? classify(opcode_b) : TB_PAIR_CLASS_NONE]++;
+        m_pcs[reason][pc]++;
+    }
+
+    //-------------------------------------------------------------
+    // print: Histograms
+    //-------------------------------------------------------------
+    void print(void)
+    {
+        uint64_t issued = m_single + m_dual;
+
+        printf("Dual issue: %lu of %lu issue cycles paired (%.1f%%)\n",
+               (unsigned long)m_dual, (unsigned long)issued,
+               issued ? (100.0 * m_dual) / issued : 0.0);
+
+        if (!m_single)
+            return;
+
+        printf("Single issue reasons:\n");
+        for (int r=TB_PAIR_NONE+1;r<TB_PAIR_REASON_MAX;r++)
+        {
+            if (!m_reason[r])
+                continue;
+
+            printf("  %-20s %12lu  %5.1f%%\n", reason_name(r),
+                   (unsigned long)m_reason[r], (100.0 * m_reason[r]) / m_single);
+        }
+
+        for (int r=TB_PAIR_NONE+1;r<TB_PAIR_REASON_MAX;r++)
+        {
+            if (!m_reason[r])
+                continue;
+
+            printf("%s:\n", reason_name(r));
+
+            // Instruction class pairs (most frequent first)
+            std::vector < std::pair<uint64_t, int> > pairs;
+            for (int a=0;a<TB_PAIR_CLASS_MAX;a++)
+                for (int b=0;b<TB_PAIR_CLASS_MAX;b++)
+                    if (m_pair[r][a][b])
+                        pairs.push_back(std::make_pair(m_pair[r][a][b], a * TB_PAIR_CLASS_MAX + b));
+            std::sort(pairs.rbegin(), pairs.rend());
+
+            for (size_t i=0;i<pairs.size() && i<TB_PAIR_TOP_PCS;i++)
+                printf("  %-6s + %-6s %12lu\n",
+                       class_name(pairs[i].second / TB_PAIR_CLASS_MAX),
+                       class_name(pairs[i].second % TB_PAIR_CLASS_MAX),
+                       (unsigned long)pairs[i].first);
+
+            // Hottest PCs
+            std::vector < std::pair<uint64_t, uint32_t> > pcs;
+            for (std::map<uint32_t, uint64_t>::iterator it = m_pcs[r].begin(); it != m_pcs[r].end(); ++it)
+                pcs.push_back(std::make_pair(it->second, it->first));
+            std::sort(pcs.rbegin(), pcs.rend());
+
+            for (size_t i=0;i<pcs.size() && i<TB_PAIR_TOP_PCS;i++)
+                printf("  PC %08x      %12lu\n", pcs[i].second, (unsigned long)pcs[i].first);
+        }
+    }
+
+protected:
+    //-------------------------------------------------------------
+    // classify: Instruction class from major opcode
+    //-------------------------------------------------------------
+    static int classify(uint32_t opcode)
+    {
+        switch (opcode & 0x7F)
+        {
+            case 0x33:
+                if (((opcode >> 25) & 0x7F) == 0x01)
+                    return (opcode & (1 << 14)) ? TB_PAIR_CLASS_DIV : TB_PAIR_CLASS_MUL;
+                return TB_PAIR_CLASS_ALU;
+            case 0x13:
+            case 0x37:
+            case 0x17:
+                return TB_PAIR_CLASS_ALU;
+            case 0x03:
+                return TB_PAIR_CLASS_LOAD;
+            case 0x23:
+            case 0x2F:
+                return TB_PAIR_CLASS_STORE;
+            case 0x63:
+                return TB_PAIR_CLASS_BRANCH;
+            case 0x6F:
+            case 0x67:
+                return TB_PAIR_CLASS_JUMP;
+            case 0x73:
+                return TB_PAIR_CLASS_CSR;
+            default:
+                return TB_PAIR_CLASS_OTHER;
+        }
+    }
+
+    static const char *const *reason_names(void)
+    {
+        static const char *names[] =
+        {
+            "none", "disabled", "fetch alignment", "fetch single", "branch in A",
+            "div/csr in A", "B needs pipe 0", "LSU conflict", "MUL conflict",
+            "other combination", "RAW on A", "in-flight result"
+        };
+        return names;
+    }
+
+    static const char *reason_name(int r) { return reason_names()[r]; }
+
+    static const char *class_name(int c)
+    {
+        static const char *names[] =
+        {
+            "alu", "mul", "div", "load", "store", "branch", "jump", "csr", "other", "-"
+        };
+        return names[c];
+    }
+
+    tb_stat_scalar                  m_single;
+    tb_stat_scalar                  m_dual;
+    tb_stat_vector                  m_reason;
+    uint64_t                        m_pair[TB_PAIR_REASON_MAX][TB_PAIR_CLASS_MAX][TB_PAIR_CLASS_MAX];
+    std::map <uint32_t, uint64_t>   m_pcs[TB_PAIR_REASON_MAX];
+};
+
+#endif
@@ -0,0 +1,402 @@
+#include "tb_periph.h"
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <poll.h>
+
+//-----------------------------------------------------------------
+// Defines
+//-----------------------------------------------------------------
+#define CLINT_MTIME         0x00
+#define CLINT_MTIMEH        0x04
+#define CLINT_MTIMECMP      0x08
+#define CLINT_MTIMECMPH     0x0C
+#define CLINT_MSIP          0x10
+
+#define ULITE_RX            0x00
+#define ULITE_TX            0x04
+#define ULITE_STATUS        0x08
+    #define ULITE_STATUS_RXVALID    (1 << 0)
+    #define ULITE_STATUS_RXFULL     (1 << 1)
+    #define ULITE_STATUS_TXEMPTY    (1 << 2)
+    #define ULITE_STATUS_TXFULL     (1 << 3)
+    #define ULITE_STATUS_IE         (1 << 4)
+#define ULITE_CONTROL       0x0C
+    #define ULITE_CONTROL_RST_TX    (1 << 0)
+    #define ULITE_CONTROL_RST_RX    (1 << 1)
+    #define ULITE_CONTROL_IE        (1 << 4)
+
+#define ULITE_RX_POLL_CYCLES 1024
+
+#define PLIC_PRIORITY       0x000000
+#define PLIC_PENDING        0x001000
+#define PLIC_ENABLE         0x002000
+#define PLIC_THRESHOLD      0x200000
+#define PLIC_CLAIM          0x200004
+
+//-----------------------------------------------------------------
+// strb_merge: Apply byte strobes to a register value
+//-----------------------------------------------------------------
+static uint32_t strb_merge(uint32_t old_value, uint32_t data, uint8_t strb)
+{
+    uint32_t mask = 0;
+    for (int i=0;i<4;i++)
+        if (strb & (1u << i))
+            mask |= 0xFFu << (i*8);
+
+    return (old_value & ~mask) | (data & mask);
+}
+
+//-----------------------------------------------------------------
+// tb_clint: Constructor
+//-----------------------------------------------------------------
+tb_clint::tb_clint(uint32_t base, uint32_t divider): tb_device(base, CLINT_SIZE)
+{
+    m_divider  = divider ? divider : 1;
+    reset();
+}
+//-----------------------------------------------------------------
+// tb_clint: reset
+//-----------------------------------------------------------------
+void tb_clint::reset(void)
+{
+    m_mtime    = 0;
+    m_mtimecmp = ~0ULL;
+    m_msip     = 0;
+    m_prescale = 0;
+}
+//-----------------------------------------------------------------
+// tb_clint: read32
+//-----------------------------------------------------------------
+uint32_t tb_clint::read32(uint32_t offset)
+{
+    switch (offset)
+    {
+        case CLINT_MTIME:     return (uint32_t)m_mtime;
+        case CLINT_MTIMEH:    return (uint32_t)(m_mtime >> 32);
+        case CLINT_MTIMECMP:  return (uint32_t)m_mtimecmp;
+        case CLINT_MTIMECMPH: return (uint32_t)(m_mtimecmp >> 32);
+        case CLINT_MSIP:      return m_msip;
+        default:              return 0;
+    }
+}
+//-----------------------------------------------------------------
+// tb_clint: write32
+//-----------------------------------------------------------------
+void tb_clint::write32(uint32_t offset, uint32_t data, uint8_t strb)
+{
+    switch (offset)
+    {
+        case CLINT_MTIME:
+            m_mtime = (m_mtime & 0xFFFFFFFF00000000ULL) | strb_merge((uint32_t)m_mtime, data, strb);
+            break;
+        case CLINT_MTIMEH:
+            m_mtime = (m_mtime & 0xFFFFFFFFULL) | ((uint64_t)strb_merge((uint32_t)(m_mtime >> 32), data, strb) << 32);
+            break;
+        case CLINT_MTIMECMP:
+            m_mtimecmp = (m_mtimecmp & 0xFFFFFFFF00000000ULL) | strb_merge((uint32_t)m_mtimecmp, data, strb);
+            break;
+        case CLINT_MTIMECMPH:
+            m_mtimecmp = (m_mtimecmp & 0xFFFFFFFFULL) | ((uint64_t)strb_merge((uint32_t)(m_mtimecmp >> 32), data, strb) << 32);
+            break;
+        case CLINT_MSIP:
+            m_msip = strb_merge(m_msip, data, strb) & 1;
+            break;
+        default:
+            break;
+    }
+}
+//-----------------------------------------------------------------
+// tb_clint: clock
+//-----------------------------------------------------------------
+void tb_clint::clock(void)
+{
+    if (++m_prescale >= m_divider)
+    {
+        m_prescale = 0;
+        m_mtime++;
+    }
+}
+//-----------------------------------------------------------------
+// tb_clint: advance
+//-----------------------------------------------------------------
+void tb_clint::advance(uint64_t cycles)
+{
+    uint64_t ticks = m_prescale + cycles;
+    m_mtime   += ticks / m_divider;
+    m_prescale = (uint32_t)(ticks % m_divider);
+}
+//-----------------------------------------------------------------
+// tb_clint: cycles_to_irq - clock cycles until the timer fires
+//-----------------------------------------------------------------
+uint64_t tb_clint::cycles_to_irq(void)
+{
+    if (irq())
+        return 0;
+
+    uint64_t ticks = m_mtimecmp - m_mtime;
+    if (ticks > (~0ULL / m_divider))
+        return ~0ULL;
+
+    return (ticks * m_divider) - m_prescale;
+}
+//-----------------------------------------------------------------
+// tb_clint: irq
+//-----------------------------------------------------------------
+bool tb_clint::irq(void)
+{
+    return (m_mtime >= m_mtimecmp) || (m_msip & 1);
+}
+
+//-----------------------------------------------------------------
+// tb_uart_lite: Constructor
+//-----------------------------------------------------------------
+tb_uart_lite::tb_uart_lite(uint32_t base): tb_device(base, UART_LITE_SIZE)
+{
+    m_rx_eof       = false;
+    reset();
+}
+//-----------------------------------------------------------------
+// tb_uart_lite: reset (marker string is retained)
+//-----------------------------------------------------------------
+void tb_uart_lite::reset(void)
+{
+    m_rx_valid     = false;
+    m_rx_data      = 0;
+    m_rx_poll      = 0;
+    m_intr_enable  = false;
+    m_intr_pending = false;
+    m_marker_seen  = false;
+    m_tx_tail.clear();
+}
+//-----------------------------------------------------------------
+// tb_uart_lite: read32
+//-----------------------------------------------------------------
+uint32_t tb_uart_lite::read32(uint32_t offset)
+{
+    switch (offset)
+    {
+        case ULITE_RX:
+        {
+            uint32_t data = m_rx_data;
+            m_rx_valid = false;
+            return data;
+        }
+        case ULITE_STATUS:
+        {
+            uint32_t status = ULITE_STATUS_TXEMPTY;
+            if (m_rx_valid)    status |= ULITE_STATUS_RXVALID | ULITE_STATUS_RXFULL;
+            if (m_intr_enable) status |= ULITE_STATUS_IE;
+
+            // Status read acknowledges the interrupt
+            m_intr_pending = false;
+            return status;
+        }
+        default:
+            return 0;
+    }
+}
+//-----------------------------------------------------------------
+// tb_uart_lite: write32
+//-----------------------------------------------------------------
+void tb_uart_lite::write32(uint32_t offset, uint32_t data, uint8_t strb)
+{
+    switch (offset)
+    {
+        case ULITE_TX:
+        {
+            char ch = (char)(data & 0xFF);
+            putchar(ch);
+            fflush(stdout);
+
+            // TX FIFO drains immediately
+            m_intr_pending = true;
+
+            if (!m_marker.empty() && !m_marker_seen)
+            {
+                m_tx_tail += ch;
+                if (m_tx_tail.size() > m_marker.size())
+                    m_tx_tail.erase(0, m_tx_tail.size() - m_marker.size());
+                m_marker_seen = (m_tx_tail == m_marker);
+            }
+            break;
+        }
+        case ULITE_CONTROL:
+            if (data & ULITE_CONTROL_RST_RX)
+                m_rx_valid = false;
+            m_intr_enable = (data & ULITE_CONTROL_IE) != 0;
+            break;
+        default:
+            break;
+    }
+}
+//-----------------------------------------------------------------
+// tb_uart_lite: clock - poll stdin for RX data
+//-----------------------------------------------------------------
+void tb_uart_lite::clock(void)
+{
+    if (m_rx_valid || m_rx_eof || (++m_rx_poll < ULITE_RX_POLL_CYCLES))
+        return;
+
+    m_rx_poll = 0;
+
+    struct pollfd fds;
+    fds.fd      = STDIN_FILENO;
+    fds.events  = POLLIN;
+    fds.revents = 0;
+
+    if (poll(&fds, 1, 0) > 0 && (fds.revents & (POLLIN | POLLHUP)))
+    {
+        uint8_t ch;
+        if (read(STDIN_FILENO, &ch, 1) == 1)
+        {
+            m_rx_data      = ch;
+            m_rx_valid     = true;
+            m_intr_pending = true;
+        }
+        else
+            m_rx_eof = true;
+    }
+}
+//-----------------------------------------------------------------
+// tb_uart_lite: advance - poll stdin on the next clock
+//-----------------------------------------------------------------
+void tb_uart_lite::advance(uint64_t cycles)
+{
+    if (cycles)
+        m_rx_poll = ULITE_RX_POLL_CYCLES - 1;
+}
+//-----------------------------------------------------------------
+// tb_uart_lite: irq
+//-----------------------------------------------------------------
+bool tb_uart_lite::irq(void)
+{
+    return m_intr_enable && m_intr_pending;
+}
+//-----------------------------------------------------------------
+// tb_uart_lite: rx_pending - RX byte held or waiting on stdin
+// (idle skip wake source, also for polled / non-interrupt RX)
+//-----------------------------------------------------------------
+bool tb_uart_lite::rx_pending(void)
+{
+    if (m_rx_valid)
+        return true;
+    if (m_rx_eof)
+        return false;
+
+    struct pollfd fds;
+    fds.fd      = STDIN_FILENO;
+    fds.events  = POLLIN;
+    fds.revents = 0;
+
+    return poll(&fds, 1, 0) > 0 && (fds.revents & (POLLIN | POLLHUP));
+}
+
+//-----------------------------------------------------------------
+// tb_plic: Constructor
+//-----------------------------------------------------------------
+tb_plic::tb_plic(uint32_t base): tb_device(base, PLIC_SIZE)
+{
+    for (int i=0;i<PLIC_MAX_SOURCES;i++)
+        m_source[i] = NULL;
+
+    reset();
+}
+//-----------------------------------------------------------------
+// tb_plic: reset (source wiring is retained)
+//-----------------------------------------------------------------
+void tb_plic::reset(void)
+{
+    for (int i=0;i<PLIC_MAX_SOURCES;i++)
+        m_priority[i] = 0;
+
+    m_pending   = 0;
+    m_enable    = 0;
+    m_claimed   = 0;
+    m_threshold = 0;
+}
+//-----------------------------------------------------------------
+// tb_plic: add_source
+//-----------------------------------------------------------------
+void tb_plic::add_source(int src, tb_device *dev)
+{
+    if (src > 0 && src < PLIC_MAX_SOURCES)
+        m_source[src] = dev;
+}
+//-----------------------------------------------------------------
+// tb_plic: claim - highest priority pending source (or 0)
+//-----------------------------------------------------------------
+int tb_plic::claim(void)
+{
+    int      best     = 0;
+    uint32_t best_pri = m_threshold;
+
+    for (int i=1;i<PLIC_MAX_SOURCES;i++)
+        if ((m_pending & m_enable & (1u << i)) && m_priority[i] > best_pri)
+        {
+            best     = i;
+            best_pri = m_priority[i];
+        }
+
+    return best;
+}
+//-----------------------------------------------------------------
+// tb_plic: read32
+//-----------------------------------------------------------------
+uint32_t tb_plic::read32(uint32_t offset)
+{
+    if (offset < PLIC_PENDING)
+        return m_priority[(offset / 4) % PLIC_MAX_SOURCES];
+    else if (offset == PLIC_PENDING)
+        return m_pending;
+    else if (offset == PLIC_ENABLE)
+        return m_enable;
+    else if (offset == PLIC_THRESHOLD)
+        return m_threshold;
+    else if (offset == PLIC_CLAIM)
+    {
+        int src = claim();
+        if (src)
+        {
+            m_pending &= ~(1u << src);
+            m_claimed |=  (1u << src);
+        }
+        return src;
+    }
+
+    return 0;
+}
+//-----------------------------------------------------------------
+// tb_plic: write32
+//-----------------------------------------------------------------
+void tb_plic::write32(uint32_t offset, uint32_t data, uint8_t strb)
+{
+    if (offset < PLIC_PENDING)
+    {
+        int src = (offset / 4) % PLIC_MAX_SOURCES;
+        m_priority[src] = strb_merge(m_priority[src], data, strb);
+    }
+    else if (offset == PLIC_ENABLE)
+        m_enable = strb_merge(m_enable, data, strb) & ~1;
+    else if (offset == PLIC_THRESHOLD)
+        m_threshold = strb_merge(m_threshold, data, strb);
+    // Complete
+    else if (offset == PLIC_CLAIM && data < PLIC_MAX_SOURCES)
+        m_claimed &= ~(1u << data);
+}
+//-----------------------------------------------------------------
+// tb_plic: clock - level triggered gateways
+//-----------------------------------------------------------------
+void tb_plic::clock(void)
+{
+    for (int i=1;i<PLIC_MAX_SOURCES;i++)
+        if (m_source[i] && m_source[i]->irq() && !(m_claimed & (1u << i)))
+            m_pending |= (1u << i);
+}
+//-----------------------------------------------------------------
+// tb_plic: irq
+//-----------------------------------------------------------------
+bool tb_plic::irq(void)
+{
+    return claim() != 0;
+}
@@ -0,0 +1,149 @@
+#ifndef TB_PERIPH_H
+#define TB_PERIPH_H
+
+#include <stdint.h>
+#include <string>
+
+//-----------------------------------------------------------------
+// Defines
+//-----------------------------------------------------------------
+#define CLINT_BASE          0x90000000
+#define CLINT_SIZE          0x00001000
+#define UART_LITE_BASE      0x92000000
+#define UART_LITE_SIZE      0x00001000
+#define PLIC_BASE           0x0C000000
+#define PLIC_SIZE           0x00400000
+
+#define PLIC_MAX_SOURCES    32
+#define PLIC_SRC_UART       1
+
+//-----------------------------------------------------------------
+// tb_device: Memory mapped peripheral model
+//-----------------------------------------------------------------
+class tb_device
+{
+public:
+    tb_device(uint32_t base, uint32_t size)
+    {
+        m_base = base;
+        m_size = size;
+    }
+    virtual ~tb_device() { }
+
+    bool match(uint32_t addr)
+    {
+        return (addr - m_base) < m_size;
+    }
+
+    uint32_t         get_base(void) { return m_base; }
+
+    // Word access (offset relative to base)
+    virtual uint32_t read32(uint32_t offset) = 0;
+    virtual void     write32(uint32_t offset, uint32_t data, uint8_t strb) = 0;
+
+    // Return to power-on state
+    virtual void     reset(void) { }
+
+    // Called once per clock cycle
+    virtual void     clock(void) { }
+
+    // Account for clock cycles that were skipped (idle core)
+    virtual void     advance(uint64_t cycles) { }
+
+    // Interrupt request (level)
+    virtual bool     irq(void) { return false; }
+
+protected:
+    uint32_t m_base;
+    uint32_t m_size;
+};
+
+//-----------------------------------------------------------------
+// tb_clint: mtime / mtimecmp / msip (see sw/common/rvconfig.h)
+//-----------------------------------------------------------------
+class tb_clint: public tb_device
+{
+public:
+    tb_clint(uint32_t base = CLINT_BASE, uint32_t divider = 1);
+
+    uint32_t read32(uint32_t offset);
+    void     write32(uint32_t offset, uint32_t data, uint8_t strb);
+    void     reset(void);
+    void     clock(void);
+    void     advance(uint64_t cycles);
+    bool     irq(void);
+
+    uint64_t get_mtime(void)    { return m_mtime; }
+    uint64_t cycles_to_irq(void);
+    uint64_t get_mtimecmp(void) { return m_mtimecmp; }
+
+protected:
+    uint64_t m_mtime;
+    uint64_t m_mtimecmp;
+    uint32_t m_msip;
+    uint32_t m_divider;
+    uint32_t m_prescale;
+};
+
+//-----------------------------------------------------------------
+// tb_uart_lite: Xilinx UART-Lite (TX to stdout, RX from stdin)
+//-----------------------------------------------------------------
+class tb_uart_lite: public tb_device
+{
+public:
+    tb_uart_lite(uint32_t base = UART_LITE_BASE);
+
+    uint32_t read32(uint32_t offset);
+    void     write32(uint32_t offset, uint32_t data, uint8_t strb);
+    void     reset(void);
+    void     clock(void);
+    void     advance(uint64_t cycles);
+    bool     irq(void);
+    bool     rx_pending(void);
+
+    // Detect a string (e.g. shell prompt) in the TX output
+    void     set_marker(const char *marker) { m_marker = marker; m_marker_seen = false; }
+    bool     marker_seen(void)              { return m_marker_seen; }
+
+protected:
+    bool        m_rx_valid;
+    uint8_t     m_rx_data;
+    bool        m_rx_eof;
+    uint32_t    m_rx_poll;
+
+    bool        m_intr_enable;
+    bool        m_intr_pending;
+
+    std::string m_marker;
+    std::string m_tx_tail;
+    bool        m_marker_seen;
+};
+
+//-----------------------------------------------------------------
+// tb_plic: Simple PLIC (single hart, single M-mode context)
+//-----------------------------------------------------------------
+class tb_plic: public tb_device
+{
+public:
+    tb_plic(uint32_t base = PLIC_BASE);
+
+    void     add_source(int src, tb_device *dev);
+
+    uint32_t read32(uint32_t offset);
+    void     write32(uint32_t offset, uint32_t data, uint8_t strb);
+    void     reset(void);
+    void     clock(void);
+    bool     irq(void);
+
+protected:
+    int      claim(void);
+
+    tb_device *m_source[PLIC_MAX_SOURCES];
+    uint32_t   m_priority[PLIC_MAX_SOURCES];
+    uint32_t   m_pending;
+    uint32_t   m_enable;
+    uint32_t   m_claimed;
+    uint32_t   m_threshold;
+};
+
+#endif
@@ -0,0 +1,276 @@
+#include "tb_pipeview.h"
+
+//-------------------------------------------------------------
+// Constructor
+//-------------------------------------------------------------
+tb_pipeview::tb_pipeview()
+{
+    m_file       = NULL;
+    m_start      = 0;
+    m_end        = 0;
+    m_pc_lo      = 0;
+    m_pc_hi      = 0xFFFFFFFF;
+    m_records    = 0;
+    m_seq        = 0;
+    m_next_write = 0;
+    m_prev_stall = false;
+    m_active     = false;
+    m_fetch_idx  = 0;
+
+    for (int i=0;i<TB_PIPEVIEW_FETCH_HIST;i++)
+    {
+        m_fetch_pc[i]    = 0xFFFFFFFF;
+        m_fetch_cycle[i] = 0;
+    }
+}
+//-------------------------------------------------------------
+// Destructor
+//-------------------------------------------------------------
+tb_pipeview::~tb_pipeview()
+{
+    close();
+}
+//-------------------------------------------------------------
+// open: Create output file
+//-------------------------------------------------------------
+bool tb_pipeview::open(const char *filename)
+{
+    m_file = fopen(filename, "w");
+    if (!m_file)
+    {
+        fprintf(stderr, "ERROR: Could not open pipeline view file '%s'\n", filename);
+        return false;
+    }
+
+    return true;
+}
+//-------------------------------------------------------------
+// close: Flush instructions still in flight and close file
+//-------------------------------------------------------------
+void tb_pipeview::close(void)
+{
+    if (!m_file)
+        return;
+
+    drop_all(0);
+
+    fclose(m_file);
+    m_file = NULL;
+}
+//-------------------------------------------------------------
+// fetch_cycle: Cycle the fetch packet holding 'pc' was requested
+//-------------------------------------------------------------
+uint64_t tb_pipeview::fetch_cycle(uint32_t pc, uint64_t cycle)
+{
+    // Most recent request first
+    for (int i=1;i<=TB_PIPEVIEW_FETCH_HIST;i++)
+    {
+        int idx = (m_fetch_idx + TB_PIPEVIEW_FETCH_HIST - i) % TB_PIPEVIEW_FETCH_HIST;
+        if (m_fetch_pc[idx] == (pc & ~7u) && m_fetch_cycle[idx] <= cycle)
+            return m_fetch_cycle[idx];
+    }
+
+    return cycle;
+}
+//-------------------------------------------------------------
+// write: Emit one instruction record
+//-------------------------------------------------------------
+void tb_pipeview::write(const insn &i)
+{
+    if (i.decode < m_start || (m_end && i.decode >= m_end))
+        return;
+    if (i.pc < m_pc_lo || i.pc > m_pc_hi)
+        return;
+
+    uint64_t t = TB_PIPEVIEW_TICKS;
+
+    // Stages not reached by a flushed instruction are left at 0
+    fprintf(m_file, "O3PipeView:fetch:%llu:0x%08x:0:%llu:[p%d] %s\n",
+            (unsigned long long)(i.fetch * t), i.pc, (unsigned long long)i.seq,
+            i.pipe < 0 ? 0 : i.pipe, m_disasm.get(i.pc, i.opcode).c_str());
+    fprintf(m_file, "O3PipeView:decode:%llu\n",   (unsigned long long)(i.decode * t));
+    fprintf(m_file, "O3PipeView:rename:%llu\n",   (unsigned long long)(i.decode * t));
+    fprintf(m_file, "O3PipeView:dispatch:%llu\n", (unsigned long long)(i.issue * t));
+    fprintf(m_file, "O3PipeView:issue:%llu\n",    (unsigned long long)(i.e1 * t));
+    fprintf(m_file, "O3PipeView:complete:%llu\n", (unsigned long long)(i.e2 * t));
+
+    uint64_t retire = i.flushed ? 0 : (i.wb * t);
+    uint64_t store  = ((i.opcode & 0x7F) == 0x23) ? retire : 0;
+    fprintf(m_file, "O3PipeView:retire:%llu:store:%llu\n",
+            (unsigned long long)retire, (unsigned long long)store);
+
+    m_records++;
+}
+//-------------------------------------------------------------
+// finish: Instruction left the pipeline, emit in program order
+//-------------------------------------------------------------
+void tb_pipeview::finish(insn &i, uint64_t cycle, bool flushed)
+{
+    i.flushed = flushed;
+    m_done[i.seq] = i;
+
+    std::map<uint64_t, insn>::iterator it = m_done.begin();
+    while (it != m_done.end() && it->first == m_next_write)
+    {
+        write(it->second);
+        m_done.erase(it++);
+        m_next_write++;
+    }
+}
+//-------------------------------------------------------------
+// drop_all: Discard tracking state (instructions marked flushed)
+//-------------------------------------------------------------
+void tb_pipeview::drop_all(uint64_t cycle)
+{
+    for (int p=0;p<TB_PIPEVIEW_PIPES;p++)
+    {
+        for (size_t i=0;i<m_pipe[p].size();i++)
+            finish(m_pipe[p][i], cycle, true);
+        m_pipe[p].clear();
+    }
+
+    for (size_t i=0;i<m_decode.size();i++)
+        finish(m_decode[i], cycle, true);
+    m_decode.clear();
+
+    // Anything still out of order (gaps should not occur)
+    for (std::map<uint64_t, insn>::iterator it = m_done.begin(); it != m_done.end(); ++it)
+        write(it->second);
+    m_done.clear();
+
+    m_next_write = m_seq;
+    m_prev_stall = false;
+    m_active     = false;
+}
+//-------------------------------------------------------------
+// sample: Advance tracked instructions using this cycle's state
+//-------------------------------------------------------------
+void tb_pipeview::sample(uint64_t cycle, const tb_pipe_state &s)
+{
+    if (!m_file)
+        return;
+
+    // Outside window (plus drain margin for instructions in flight)
+    if (cycle < m_start || (m_end && cycle >= m_end + TB_PIPEVIEW_DRAIN))
+    {
+        if (m_active)
+            drop_all(cycle);
+        return;
+    }
+    m_active = true;
+
+    if (s.fetch_valid)
+    {
+        m_fetch_pc[m_fetch_idx]    = s.fetch_pc;
+        m_fetch_cycle[m_fetch_idx] = cycle;
+        m_fetch_idx = (m_fetch_idx + 1) % TB_PIPEVIEW_FETCH_HIST;
+    }
+
+    // Execution pipes: E1 -> E2 -> WB -> retire, held while stalled
+    for (int p=0;p<TB_PIPEVIEW_PIPES;p++)
+    {
+        std::deque<insn> next;
+
+        for (size_t n=0;n<m_pipe[p].size();n++)
+        {
+            insn &i = m_pipe[p][n];
+            int stage = i.stage;
+
+            if (stage == STAGE_ISSUE)
+                stage = STAGE_E1;
+            else if (!m_prev_stall)
+                stage++;
+
+            if (stage > STAGE_WB)
+            {
+                finish(i, cycle, false);
+                continue;
+            }
+
+            if (!s.stage_valid[p][stage] || s.stage_pc[p][stage] != i.pc)
+            {
+                finish(i, cycle, true);
+                continue;
+            }
+
+            if (stage != i.stage)
+            {
+                if (stage == STAGE_E1)      i.e1 = cycle;
+                else if (stage == STAGE_E2) i.e2 = cycle;
+                else                        i.wb = cycle;
+                i.stage = stage;
+            }
+
+            next.push_back(i);
+        }
+
+        m_pipe[p].swap(next);
+    }
+
+    // Decode slots: match by PC against last cycle
+    std::deque<insn> decode;
+    bool             accept = !(m_end && cycle >= m_end);
+
+    for (int slot=0;slot<2;slot++)
+    {
+        if (!s.decode_valid[slot])
+            continue;
+
+        bool found = false;
+        for (std::deque<insn>::iterator it = m_decode.begin(); it != m_decode.end(); ++it)
+        {
+            if (it->pc == s.decode_pc[slot])
+            {
+                decode.push_back(*it);
+                m_decode.erase(it);
+                found = true;
+                break;
+            }
+        }
+
+        if (found || !accept)
+            continue;
+
+        insn i;
+        i.seq     = m_seq++;
+        i.pc      = s.decode_pc[slot];
+        i.opcode  = s.decode_opcode[slot];
+        i.pipe    = -1;
+        i.stage   = STAGE_DECODE;
+        i.fetch   = fetch_cycle(i.pc, cycle);
+        i.decode  = cycle;
+        i.issue   = 0;
+        i.e1      = 0;
+        i.e2      = 0;
+        i.wb      = 0;
+        i.flushed = false;
+        decode.push_back(i);
+    }
+
+    // No longer presented without issuing -> flushed
+    for (size_t n=0;n<m_decode.size();n++)
+        finish(m_decode[n], cycle, true);
+
+    // Issue: move to execution pipe
+    for (int p=0;p<TB_PIPEVIEW_PIPES;p++)
+    {
+        if (!s.issue_valid[p])
+            continue;
+
+        for (std::deque<insn>::iterator it = decode.begin(); it != decode.end(); ++it)
+        {
+            if (it->pc == s.issue_pc[p])
+            {
+                it->pipe  = p;
+                it->stage = STAGE_ISSUE;
+                it->issue = cycle;
+                m_pipe[p].push_back(*it);
+                decode.erase(it);
+                break;
+            }
+        }
+    }
+
+    m_decode.swap(decode);
+    m_prev_stall = s.stall;
+}
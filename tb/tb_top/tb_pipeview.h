@@ -0,0 +1,126 @@
+#ifndef TB_PIPEVIEW_H
+#define TB_PIPEVIEW_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <deque>
+#include <map>
+#include <string>
+
+#include "tb_disasm.h"
+
+//-------------------------------------------------------------
+// Defines
+//-------------------------------------------------------------
+#define TB_PIPEVIEW_PIPES       2
+#define TB_PIPEVIEW_STAGES      3       // E1, E2, WB
+#define TB_PIPEVIEW_FETCH_HIST  8       // Recent fetch packets
+#define TB_PIPEVIEW_TICKS       1000    // O3PipeView ticks per cycle
+#define TB_PIPEVIEW_DRAIN       256     // Cycles tracked around the window
+
+//-------------------------------------------------------------
+// tb_pipe_state: Core pipeline snapshot for one cycle
+//-------------------------------------------------------------
+struct tb_pipe_state
+{
+    // Instruction cache request (64-bit packet)
+    bool     fetch_valid;
+    uint32_t fetch_pc;
+
+    // Decode output slots (presented to issue)
+    bool     decode_valid[2];
+    uint32_t decode_pc[2];
+    uint32_t decode_opcode[2];
+
+    // Issued this cycle, per execution pipe
+    bool     issue_valid[TB_PIPEVIEW_PIPES];
+    uint32_t issue_pc[TB_PIPEVIEW_PIPES];
+
+    // Pipeline hold (E1/E2/WB do not advance)
+    bool     stall;
+
+    // Execution stage occupancy
+    bool     stage_valid[TB_PIPEVIEW_PIPES][TB_PIPEVIEW_STAGES];
+    uint32_t stage_pc[TB_PIPEVIEW_PIPES][TB_PIPEVIEW_STAGES];
+};
+
+//-------------------------------------------------------------
+// tb_pipeview: Per-instruction stage timestamps in gem5
+// O3PipeView format (also read by the Konata viewer);
+//   fetch    - instruction cache request
+//   decode   - presented to the issue stage (rename = decode)
+//   dispatch - issued, pipe shown as [p0] / [p1]
+//   issue    - E1, complete - E2 (memory), retire - writeback
+// Flushed instructions have retire = 0.
+//-------------------------------------------------------------
+class tb_pipeview
+{
+public:
+    tb_pipeview();
+    ~tb_pipeview();
+
+    bool     open(const char *filename);
+    void     close(void);
+
+    // Restrict to instructions decoded in [start, end) / PC in [lo, hi]
+    void     set_window(uint64_t start, uint64_t end) { m_start = start; m_end = end; }
+    void     set_pc_range(uint32_t lo, uint32_t hi)   { m_pc_lo = lo; m_pc_hi = hi; }
+
+    void     sample(uint64_t cycle, const tb_pipe_state &s);
+
+    uint64_t get_records(void) { return m_records; }
+
+protected:
+    enum
+    {
+        STAGE_DECODE = -2,
+        STAGE_ISSUE  = -1,
+        STAGE_E1     = 0,
+        STAGE_E2     = 1,
+        STAGE_WB     = 2
+    };
+
+    struct insn
+    {
+        uint64_t seq;
+        uint32_t pc;
+        uint32_t opcode;
+        int      pipe;
+        int      stage;
+        uint64_t fetch;
+        uint64_t decode;
+        uint64_t issue;
+        uint64_t e1;
+        uint64_t e2;
+        uint64_t wb;
+        bool     flushed;
+    };
+
+    uint64_t fetch_cycle(uint32_t pc, uint64_t cycle);
+    void     finish(insn &i, uint64_t cycle, bool flushed);
+    void     write(const insn &i);
+    void     drop_all(uint64_t cycle);
+
+    FILE *                       m_file;
+    uint64_t                     m_start;
+    uint64_t                     m_end;
+    uint32_t                     m_pc_lo;
+    uint32_t                     m_pc_hi;
+    uint64_t                     m_records;
+
+    uint64_t                     m_seq;
+    uint64_t                     m_next_write;
+    std::map <uint64_t, insn>    m_done;
+    std::deque <insn>            m_decode;
+    std::deque <insn>            m_pipe[TB_PIPEVIEW_PIPES];
+    bool                         m_prev_stall;
+    bool                         m_active;
+
+    uint32_t                     m_fetch_pc[TB_PIPEVIEW_FETCH_HIST];
+    uint64_t                     m_fetch_cycle[TB_PIPEVIEW_FETCH_HIST];
+    int                          m_fetch_idx;
+
+    tb_disasm_cache              m_disasm;
+};
+
+#endif
@@ -0,0 +1,275 @@
+#include "tb_probe.h"
+#include "verilated_vpi.h"
+
+#include <string.h>
+
+//-------------------------------------------------------------
+// Constructor
+//-------------------------------------------------------------
+tb_probe::tb_probe()
+{
+    m_file      = NULL;
+    m_csv       = false;
+    m_on_change = false;
+    m_first     = true;
+    m_samples   = 0;
+}
+//-------------------------------------------------------------
+// Destructor
+//-------------------------------------------------------------
+tb_probe::~tb_probe()
+{
+    close();
+}
+//-------------------------------------------------------------
+// add_list: Comma separated names or @FILE (one per line, #
+// comments)
+//-------------------------------------------------------------
+bool tb_probe::add_list(const char *list)
+{
+    std::vector <std::string> names;
+
+    if (list[0] == '@')
+    {
+        FILE *f = fopen(list + 1, "r");
+        if (!f)
+        {
+            fprintf(stderr, "ERROR: Could not open probe list '%s'\n", list + 1);
+            return false;
+        }
+
+        char line[1024];
+        while (fgets(line, sizeof(line), f))
+        {
+            char *p = line + strspn(line, " \t");
+            p[strcspn(p, " \t\r\n#")] = 0;
+            if (*p)
+                names.push_back(p);
+        }
+        fclose(f);
+    }
+    else
+    {
+        std::string s = list;
+        size_t start = 0, comma;
+        while ((comma = s.find(',', start)) != std::string::npos)
+        {
+            names.push_back(s.substr(start, comma - start));
+            start = comma + 1;
+        }
+        names.push_back(s.substr(start));
+    }
+
+    bool ok = true;
+    for (size_t i=0;i<names.size();i++)
+        if (!names[i].empty())
+            ok &= add(names[i].c_str());
+    return ok;
+}
+//-------------------------------------------------------------
+// resolve: VPI handle by full name, else relative to each top
+// level scope and its direct children (e.g. TOP.v)
+//-------------------------------------------------------------
+void *tb_probe::resolve(const std::string &name)
+{
+    vpiHandle h = vpi_handle_by_name((PLI_BYTE8*)name.c_str(), NULL);
+    if (h)
+        return h;
+
+    std::vector <std::string> scopes;
+    vpiHandle top_it = vpi_iterate(vpiModule, NULL);
+    vpiHandle top;
+    while (top_it && (top = vpi_scan(top_it)))
+    {
+        scopes.push_back(vpi_get_str(vpiFullName, top));
+
+        vpiHandle sub_it = vpi_iterate(vpiModule, top);
+        vpiHandle sub;
+        while (sub_it && (sub = vpi_scan(sub_it)))
+            scopes.push_back(vpi_get_str(vpiFullName, sub));
+    }
+
+    for (size_t i=0;i<scopes.size();i++)
+    {
+        std::string full = scopes[i] + "." + name;
+        h = vpi_handle_by_name((PLI_BYTE8*)full.c_str(), NULL);
+        if (h)
+            return h;
+    }
+
+    return NULL;
+}
+//-------------------------------------------------------------
+// add: Resolve one signal
+//-------------------------------------------------------------
+bool tb_probe::add(const char *name)
+{
+    vpiHandle h = (vpiHandle)resolve(name);
+    if (!h)
+    {
+        fprintf(stderr, "ERROR: Probe '%s' not found (verilate with --vpi --public-flat-rd: make build_probe)\n", name);
+        return false;
+    }
+
+    int width = vpi_get(vpiSize, h);
+    if (width <= 0)
+    {
+        fprintf(stderr, "ERROR: Probe '%s' is not a scalar / vector signal\n", name);
+        return false;
+    }
+
+    probe p;
+    p.name   = name;
+    p.handle = h;
+    p.width  = width;
+    p.words  = (width + 31) / 32;
+    p.offset = m_value.size();
+    m_probes.push_back(p);
+
+    m_value.resize(m_value.size() + p.words, 0);
+    m_prev.resize(m_value.size(), 0);
+    return true;
+}
+//-------------------------------------------------------------
+// open: Create output file (after all probes are added)
+//-------------------------------------------------------------
+bool tb_probe::open(const char *filename)
+{
+    m_file = fopen(filename, "wb");
+    if (!m_file)
+    {
+        fprintf(stderr, "ERROR: Could not open probe file '%s'\n", filename);
+        return false;
+    }
+
+    size_t len = strlen(filename);
+    m_csv = len > 4 && !strcmp(filename + len - 4, ".csv");
+
+    write_header();
+    return true;
+}
+//-------------------------------------------------------------
+// close: Flush partial block and close file
+//-------------------------------------------------------------
+void tb_probe::close(void)
+{
+    if (!m_file)
+        return;
+
+    if (!m_csv)
+        flush_block();
+
+    fclose(m_file);
+    m_file = NULL;
+}
+//-------------------------------------------------------------
+// write_header: Column names / widths
+//-------------------------------------------------------------
+void tb_probe::write_header(void)
+{
+    if (m_csv)
+    {
+        fprintf(m_file, "cycle");
+        for (size_t i=0;i<m_probes.size();i++)
+            fprintf(m_file, ",%s", m_probes[i].name.c_str());
+        fprintf(m_file, "\n");
+        return;
+    }
+
+    uint32_t count = m_probes.size();
+    fwrite(TB_PROBE_MAGIC, 1, 8, m_file);
+    fwrite(&count, sizeof(count), 1, m_file);
+
+    m_block.resize(m_probes.size());
+    for (size_t i=0;i<m_probes.size();i++)
+    {
+        uint32_t len = m_probes[i].name.size();
+        fwrite(&m_probes[i].width, sizeof(uint32_t), 1, m_file);
+        fwrite(&len, sizeof(len), 1, m_file);
+        fwrite(m_probes[i].name.c_str(), 1, len, m_file);
+
+        m_block[i].reserve(TB_PROBE_BLOCK_ROWS * m_probes[i].words);
+    }
+    m_block_cycle.reserve(TB_PROBE_BLOCK_ROWS);
+}
+//-------------------------------------------------------------
+// sample: Read all probes, record a row (every cycle, or when a
+// value differs from the last recorded row)
+//-------------------------------------------------------------
+void tb_probe::sample(uint64_t cycle)
+{
+    if (!m_file)
+        return;
+
+    for (size_t i=0;i<m_probes.size();i++)
+    {
+        probe &p = m_probes[i];
+
+        s_vpi_value v;
+        v.format = vpiVectorVal;
+        vpi_get_value((vpiHandle)p.handle, &v);
+
+        for (uint32_t w=0;w<p.words;w++)
+            m_value[p.offset + w] = v.value.vector[w].aval;
+
+        // Unused upper bits
+        if (p.width % 32)
+            m_value[p.offset + p.words - 1] &= (1u << (p.width % 32)) - 1;
+    }
+
+    if (m_on_change && !m_first && m_value == m_prev)
+        return;
+
+    m_first = false;
+    m_prev  = m_value;
+    m_samples++;
+
+    if (m_csv)
+    {
+        write_csv(cycle);
+        return;
+    }
+
+    m_block_cycle.push_back(cycle);
+    for (size_t i=0;i<m_probes.size();i++)
+        m_block[i].insert(m_block[i].end(), m_value.begin() + m_probes[i].offset,
+                          m_value.begin() + m_probes[i].offset + m_probes[i].words);
+
+    if (m_block_cycle.size() >= TB_PROBE_BLOCK_ROWS)
+        flush_block();
+}
+//-------------------------------------------------------------
+// write_csv: One row, hex values (most significant word first)
+//-------------------------------------------------------------
+void tb_probe::write_csv(uint64_t cycle)
+{
+    fprintf(m_file, "%lu", (unsigned long)cycle);
+    for (size_t i=0;i<m_probes.size();i++)
+    {
+        probe &p = m_probes[i];
+        int    w = p.words - 1;
+
+        fprintf(m_file, ",%x", m_value[p.offset + w]);
+        while (w-- > 0)
+            fprintf(m_file, "%08x", m_value[p.offset + w]);
+    }
+    fprintf(m_file, "\n");
+}
+//-------------------------------------------------------------
+// flush_block: Write buffered rows column by column
+//-------------------------------------------------------------
+void tb_probe::flush_block(void)
+{
+    uint32_t rows = m_block_cycle.size();
+    if (!rows)
+        return;
+
+    fwrite(&rows, sizeof(rows), 1, m_file);
+    fwrite(&m_block_cycle[0], sizeof(uint64_t), rows, m_file);
+    for (size_t i=0;i<m_probes.size();i++)
+    {
+        fwrite(&m_block[i][0], sizeof(uint32_t), m_block[i].size(), m_file);
+        m_block[i].clear();
+    }
+    m_block_cycle.clear();
+}
@@ -0,0 +1,80 @@
+#ifndef TB_PROBE_H
+#define TB_PROBE_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+//-------------------------------------------------------------
+// Defines
+//-------------------------------------------------------------
+#define TB_PROBE_MAGIC          "TBPROBE1"
+#define TB_PROBE_BLOCK_ROWS     4096
+
+//-------------------------------------------------------------
+// tb_probe: Sample a list of RTL signals every cycle (or only
+// when one of them changes). Signals are resolved once through
+// VPI, so the model must be verilated with --vpi and the signals
+// public (--public-flat-rd, 'make build_probe').
+//
+// Names are full VPI names or relative to the top level / RTL top
+// (e.g. u_core.u_issue.pc_x_q). Output is CSV (FILE ends .csv,
+// hex values) or block columnar binary, little endian:
+//   header: magic[8], u32 probes, per probe: u32 width, u32 name
+//           length, name
+//   block:  u32 rows, u64 cycle[rows], per probe:
+//           u32 word[rows * ((width + 31) / 32)]
+// tb_probe.py converts the binary format to CSV or VCD.
+//-------------------------------------------------------------
+class tb_probe
+{
+public:
+    tb_probe();
+    ~tb_probe();
+
+    // Comma separated names, or @FILE with one name per line
+    bool     add_list(const char *list);
+    bool     add(const char *name);
+
+    bool     open(const char *filename);
+    void     close(void);
+
+    void     set_on_change(bool enable) { m_on_change = enable; }
+
+    void     sample(uint64_t cycle);
+
+    int      get_probes(void)  { return (int)m_probes.size(); }
+    uint64_t get_samples(void) { return m_samples; }
+
+protected:
+    void *   resolve(const std::string &name);
+    void     write_header(void);
+    void     write_csv(uint64_t cycle);
+    void     flush_block(void);
+
+    struct probe
+    {
+        std::string name;
+        void *      handle;     // vpiHandle
+        uint32_t    width;
+        uint32_t    words;
+        uint32_t    offset;     // Into m_value
+    };
+
+    std::vector <probe>         m_probes;
+    std::vector <uint32_t>      m_value;
+    std::vector <uint32_t>      m_prev;
+
+    FILE *                      m_file;
+    bool                        m_csv;
+    bool                        m_on_change;
+    bool                        m_first;
+    uint64_t                    m_samples;
+
+    // Binary: current block, one column per probe
+    std::vector <uint64_t>                m_block_cycle;
+    std::vector < std::vector<uint32_t> > m_block;
+};
+
+#endif
@@ -0,0 +1,150 @@
+#!/usr/bin/env python3
+###############################################################################
+# tb_probe.py: Convert a probe capture ('test.x --probe ... --probe-out FILE')
+# to CSV or VCD (e.g. for gtkwave). Reads the binary format described in
+# tb_probe.h, or a CSV capture (.csv).
+#
+#   ./tb_probe.py probes.bin > probes.csv
+#   ./tb_probe.py probes.bin --vcd probes.vcd
+###############################################################################
+import argparse
+import struct
+import sys
+
+MAGIC = b'TBPROBE1'
+
+###############################################################################
+# load_bin: -> names, widths, rows [(cycle, [value, ...])]
+###############################################################################
+def load_bin(filename):
+    with open(filename, 'rb') as f:
+        data = f.read()
+
+    if data[:8] != MAGIC:
+        raise ValueError('%s: not a probe capture' % filename)
+
+    (count,) = struct.unpack_from('<I', data, 8)
+    pos = 12
+    names, widths = [], []
+    for _ in range(count):
+        width, length = struct.unpack_from('<II', data, pos)
+        pos += 8
+        names.append(data[pos:pos + length].decode())
+        widths.append(width)
+        pos += length
+
+    words = [(w + 31) // 32 for w in widths]
+    rows = []
+    while pos < len(data):
+        (n,) = struct.unpack_from('<I', data, pos)
+        pos += 4
+        cycles = struct.unpack_from('<%dQ' % n, data, pos)
+        pos += 8 * n
+
+        columns = []
+        for w in words:
+            raw = struct.unpack_from('<%dI' % (n * w), data, pos)
+            pos += 4 * n * w
+            col = []
+            for r in range(n):
+                v = 0
+                for i in range(w):
+                    v |= raw[r * w + i] << (32 * i)
+                col.append(v)
+            columns.append(col)
+
+        for r in range(n):
+            rows.append((cycles[r], [c[r] for c in columns]))
+
+    return names, widths, rows
+
+###############################################################################
+# load_csv: Same, widths from the largest value seen
+###############################################################################
+def load_csv(filename):
+    with open(filename) as f:
+        names = f.readline().strip().split(',')[1:]
+        rows = []
+        for line in f:
+            fields = line.strip().split(',')
+            if len(fields) == len(names) + 1:
+                rows.append((int(fields[0]), [int(x, 16) for x in fields[1:]]))
+
+    widths = [max(1, max([r[1][i] for r in rows] or [0]).bit_length()) for i in range(len(names))]
+    return names, widths, rows
+
+###############################################################################
+# write_csv / write_vcd
+###############################################################################
+def write_csv(out, names, widths, rows):
+    out.write('cycle,%s\n' % ','.join(names))
+    for cycle, values in rows:
+        out.write('%d,%s\n' % (cycle, ','.join('%x' % v for v in values)))
+
+def vcd_id(i):
+    s = ''
+    i += 1
+    while i:
+        i, r = divmod(i - 1, 94)
+        s += chr(33 + r)
+    return s
+
+def write_vcd(out, names, widths, rows, period):
+    out.write('$timescale 1ns $end\n')
+
+    # Hierarchy from the dotted names
+    scope = []
+    ids = []
+    for i, name in sorted(enumerate(names), key=lambda x: x[1]):
+        parts = name.split('.')
+        common = 0
+        while common < len(scope) and common < len(parts) - 1 and scope[common] == parts[common]:
+            common += 1
+        for _ in range(len(scope) - common):
+            out.write('$upscope $end\n')
+        scope = scope[:common]
+        for p in parts[common:-1]:
+            out.write('$scope module %s $end\n' % p)
+            scope.append(p)
+        out.write('$var wire %d %s %s $end\n' % (widths[i], vcd_id(i), parts[-1]))
+    for _ in scope:
+        out.write('$upscope $end\n')
+    out.write('$enddefinitions $end\n')
+
+    last = [None] * len(names)
+    for cycle, values in rows:
+        changes = [i for i, v in enumerate(values) if v != last[i]]
+        if not changes:
+            continue
+        out.write('#%d\n' % (cycle * period))
+        for i in changes:
+            if widths[i] == 1:
+                out.write('%d%s\n' % (values[i] & 1, vcd_id(i)))
+            else:
+                out.write('b%s %s\n' % (bin(values[i])[2:], vcd_id(i)))
+            last[i] = values[i]
+
+###############################################################################
+# main
+###############################################################################
+def main():
+    parser = argparse.ArgumentParser(description='Convert probe captures')
+    parser.add_argument('capture', help='Probe capture (binary, or .csv)')
+    parser.add_argument('--vcd', metavar='FILE', default=None, help='Write VCD instead of CSV')
+    parser.add_argument('--period', type=int, default=10, help='VCD time units per cycle')
+    args = parser.parse_args()
+
+    if args.capture.endswith('.csv'):
+        names, widths, rows = load_csv(args.capture)
+    else:
+        names, widths, rows = load_bin(args.capture)
+
+    if args.vcd:
+        with open(args.vcd, 'w') as out:
+            write_vcd(out, names, widths, rows, args.period)
+    else:
+        write_csv(sys.stdout, names, widths, rows)
+    return 0
+
+if __name__ == '__main__':
+    sys.exit(main())
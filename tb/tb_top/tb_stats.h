@@ -0,0 +1,487 @@
+#ifndef TB_STATS_H
+#define TB_STATS_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <signal.h>
+#include <math.h>
+#include <string>
+#include <vector>
+#include <map>
+#include <functional>
+
+class tb_stat;
+
+//-----------------------------------------------------------------
+// tb_stats: Registry of named statistics. Names are hierarchical,
+// dot separated and normally start with the owning sc_module name
+// (e.g. tb.MEM.rd_bursts). Stats register themselves on
+// construction and are dumped in name order. Owners whose counters
+// are only published through tb_stat_formula (or kept outside the
+// registry) add a reset hook so reset() clears them too.
+//-----------------------------------------------------------------
+class tb_stats
+{
+public:
+    static tb_stats &instance(void)
+    {
+        static tb_stats s;
+        return s;
+    }
+
+    void add(tb_stat *stat);
+    void remove(tb_stat *stat);
+    void reset(void);
+
+    void add_reset_hook(void *owner, std::function<void(void)> func) { m_reset_hooks[owner] = func; }
+    void remove_reset_hook(void *owner) { m_reset_hooks.erase(owner); }
+
+    void dump_text(FILE *f, uint64_t cycle);
+    void dump_json(FILE *f, uint64_t cycle);
+
+protected:
+    std::map <std::string, tb_stat*> m_stats;
+    std::map <void*, std::function<void(void)> > m_reset_hooks;
+};
+
+//-----------------------------------------------------------------
+// tb_stat: Base class
+//-----------------------------------------------------------------
+class tb_stat
+{
+public:
+    tb_stat(const std::string &group, const char *name, const char *desc)
+    {
+        m_name = group.empty() ? name : group + "." + name;
+        m_desc = desc ? desc : "";
+        tb_stats::instance().add(this);
+    }
+
+    virtual ~tb_stat() { tb_stats::instance().remove(this); }
+
+    const std::string &name(void) const { return m_name; }
+    const std::string &desc(void) const { return m_desc; }
+
+    virtual void reset(void) = 0;
+    virtual void print_text(FILE *f) = 0;
+    virtual void print_json(FILE *f) = 0;
+
+protected:
+    // Integral values print without a fraction
+    static std::string format(double v)
+    {
+        char value[32];
+        if (!isfinite(v))
+            v = 0.0;
+        if (v == floor(v) && fabs(v) < 1e15)
+            snprintf(value, sizeof(value), "%.0f", v);
+        else
+            snprintf(value, sizeof(value), "%.6f", v);
+        return value;
+    }
+
+    static void print_value(FILE *f, double v) { fprintf(f, "%s", format(v).c_str()); }
+
+    static void print_line(FILE *f, const std::string &name, double v, const char *desc)
+    {
+        fprintf(f, "%-48s %16s", name.c_str(), format(v).c_str());
+        if (desc && desc[0])
+            fprintf(f, "  # %s", desc);
+        fprintf(f, "\n");
+    }
+
+    std::string m_name;
+    std::string m_desc;
+};
+
+//-----------------------------------------------------------------
+// tb_stat_scalar: Counter (inline increment, usable as uint64_t)
+//-----------------------------------------------------------------
+class tb_stat_scalar: public tb_stat
+{
+public:
+    tb_stat_scalar(const std::string &group, const char *name, const char *desc = NULL)
+        : tb_stat(group, name, desc), m_value(0) { }
+
+    tb_stat_scalar &operator++(void)            { m_value++; return *this; }
+    void            operator++(int)             { m_value++; }
+    tb_stat_scalar &operator+=(uint64_t v)      { m_value += v; return *this; }
+    tb_stat_scalar &operator=(uint64_t v)       { m_value = v; return *this; }
+    operator uint64_t(void) const               { return m_value; }
+
+    uint64_t value(void) const { return m_value; }
+
+    void reset(void)             { m_value = 0; }
+    void print_text(FILE *f)     { print_line(f, m_name, (double)m_value, m_desc.c_str()); }
+    void print_json(FILE *f)     { fprintf(f, "%lu", (unsigned long)m_value); }
+
+protected:
+    uint64_t m_value;
+};
+
+//-----------------------------------------------------------------
+// tb_stat_vector: Fixed size array of counters, with optional
+// per-entry names
+//-----------------------------------------------------------------
+class tb_stat_vector: public tb_stat
+{
+public:
+    tb_stat_vector(const std::string &group, const char *name, int size,
+                   const char *const *subnames = NULL, const char *desc = NULL)
+        : tb_stat(group, name, desc), m_value(size, 0)
+    {
+        // Entry names become part of the stat name - no spaces
+        for (int i=0;i<size;i++)
+        {
+            std::string sub = subnames ? subnames[i] : std::to_string(i);
+            for (size_t j=0;j<sub.size();j++)
+                if (sub[j] == ' ')
+                    sub[j] = '_';
+            m_subnames.push_back(sub);
+        }
+    }
+
+    uint64_t &operator[](int i)       { return m_value[i]; }
+    uint64_t  operator[](int i) const { return m_value[i]; }
+    int       size(void) const        { return (int)m_value.size(); }
+
+    uint64_t total(void) const
+    {
+        uint64_t t = 0;
+        for (size_t i=0;i<m_value.size();i++)
+            t += m_value[i];
+        return t;
+    }
+
+    void reset(void)
+    {
+        for (size_t i=0;i<m_value.size();i++)
+            m_value[i] = 0;
+    }
+
+    void print_text(FILE *f)
+    {
+        for (size_t i=0;i<m_value.size();i++)
+            print_line(f, m_name + "::" + m_subnames[i], (double)m_value[i], i ? NULL : m_desc.c_str());
+        print_line(f, m_name + "::total", (double)total(), NULL);
+    }
+
+    void print_json(FILE *f)
+    {
+        fprintf(f, "{");
+        for (size_t i=0;i<m_value.size();i++)
+            fprintf(f, "%s\"%s\": %lu", i ? ", " : "", m_subnames[i].c_str(), (unsigned long)m_value[i]);
+        fprintf(f, "}");
+    }
+
+protected:
+    std::vector <uint64_t>    m_value;
+    std::vector <std::string> m_subnames;
+};
+
+//-----------------------------------------------------------------
+// tb_stat_histogram: Linear buckets [min, min + buckets * size)
+// with underflow / overflow counts, plus min / max / mean
+//-----------------------------------------------------------------
+class tb_stat_histogram: public tb_stat
+{
+public:
+    tb_stat_histogram(const std::string &group, const char *name, int64_t min, uint64_t bucket_size,
+                      int buckets, const char *desc = NULL)
+        : tb_stat(group, name, desc), m_bucket(buckets, 0)
+    {
+        m_min_value   = min;
+        m_bucket_size = bucket_size ? bucket_size : 1;
+        reset();
+    }
+
+    void sample(int64_t v, uint64_t count = 1)
+    {
+        if (v < m_min_value)
+            m_underflow += count;
+        else
+        {
+            uint64_t idx = (uint64_t)(v - m_min_value) / m_bucket_size;
+            if (idx < m_bucket.size())
+                m_bucket[idx] += count;
+            else
+                m_overflow += count;
+        }
+
+        if (!m_samples || v < m_min) m_min = v;
+        if (!m_samples || v > m_max) m_max = v;
+        m_samples += count;
+        m_sum     += (double)v * count;
+    }
+
+    uint64_t samples(void) const { return m_samples; }
+    double   mean(void) const    { return m_samples ? m_sum / m_samples : 0.0; }
+
+    void reset(void)
+    {
+        for (size_t i=0;i<m_bucket.size();i++)
+            m_bucket[i] = 0;
+        m_underflow = 0;
+        m_overflow  = 0;
+        m_samples   = 0;
+        m_sum       = 0;
+        m_min       = 0;
+        m_max       = 0;
+    }
+
+    void print_text(FILE *f)
+    {
+        print_line(f, m_name + "::samples", (double)m_samples, m_desc.c_str());
+        print_line(f, m_name + "::mean", mean(), NULL);
+        print_line(f, m_name + "::min", (double)m_min, NULL);
+        print_line(f, m_name + "::max", (double)m_max, NULL);
+        if (m_underflow)
+            print_line(f, m_name + "::underflow", (double)m_underflow, NULL);
+
+        for (size_t i=0;i<m_bucket.size();i++)
+        {
+            if (!m_bucket[i])
+                continue;
+
+            int64_t lo = m_min_value + (int64_t)(i * m_bucket_size);
+            int64_t hi = lo + (int64_t)m_bucket_size - 1;
+            std::string range = (lo == hi) ? std::to_string(lo) : std::to_string(lo) + "-" + std::to_string(hi);
+            print_line(f, m_name + "::" + range, (double)m_bucket[i], NULL);
+        }
+
+        if (m_overflow)
+            print_line(f, m_name + "::overflow", (double)m_overflow, NULL);
+    }
+
+    void print_json(FILE *f)
+    {
+        fprintf(f, "{\"samples\": %lu, \"mean\": ", (unsigned long)m_samples);
+        print_value(f, mean());
+        fprintf(f, ", \"min\": %ld, \"max\": %ld, \"bucket_min\": %ld, \"bucket_size\": %lu, "
+                   "\"underflow\": %lu, \"overflow\": %lu, \"buckets\": [",
+                (long)m_min, (long)m_max, (long)m_min_value, (unsigned long)m_bucket_size,
+                (unsigned long)m_underflow, (unsigned long)m_overflow);
+        for (size_t i=0;i<m_bucket.size();i++)
+            fprintf(f, "%s%lu", i ? ", " : "", (unsigned long)m_bucket[i]);
+        fprintf(f, "]}");
+    }
+
+protected:
+    int64_t                 m_min_value;
+    uint64_t                m_bucket_size;
+    std::vector <uint64_t>  m_bucket;
+    uint64_t                m_underflow;
+    uint64_t                m_overflow;
+    uint64_t                m_samples;
+    double                  m_sum;
+    int64_t                 m_min;
+    int64_t                 m_max;
+};
+
+//-----------------------------------------------------------------
+// tb_stat_formula: Value computed at dump time (ratios, or counters
+// that live elsewhere)
+//-----------------------------------------------------------------
+class tb_stat_formula: public tb_stat
+{
+public:
+    tb_stat_formula(const std::string &group, const char *name, std::function<double(void)> func,
+                    const char *desc = NULL)
+        : tb_stat(group, name, desc), m_func(func) { }
+
+    double value(void) const { return m_func(); }
+
+    void reset(void)             { }
+    void print_text(FILE *f)     { print_line(f, m_name, m_func(), m_desc.c_str()); }
+    void print_json(FILE *f)     { print_value(f, m_func()); }
+
+protected:
+    std::function<double(void)> m_func;
+};
+
+//-----------------------------------------------------------------
+// tb_stats: Registry
+//-----------------------------------------------------------------
+inline void tb_stats::add(tb_stat *stat)
+{
+    if (m_stats.count(stat->name()))
+        fprintf(stderr, "WARNING: Statistic '%s' registered twice\n", stat->name().c_str());
+    m_stats[stat->name()] = stat;
+}
+
+inline void tb_stats::remove(tb_stat *stat)
+{
+    std::map <std::string, tb_stat*>::iterator it = m_stats.find(stat->name());
+    if (it != m_stats.end() && it->second == stat)
+        m_stats.erase(it);
+}
+
+inline void tb_stats::reset(void)
+{
+    for (std::map <std::string, tb_stat*>::iterator it = m_stats.begin(); it != m_stats.end(); ++it)
+        it->second->reset();
+
+    for (std::map <void*, std::function<void(void)> >::iterator it = m_reset_hooks.begin(); it != m_reset_hooks.end(); ++it)
+        it->second();
+}
+
+inline void tb_stats::dump_text(FILE *f, uint64_t cycle)
+{
+    fprintf(f, "---------- Begin Statistics (cycle %lu) ----------\n", (unsigned long)cycle);
+    for (std::map <std::string, tb_stat*>::iterator it = m_stats.begin(); it != m_stats.end(); ++it)
+        it->second->print_text(f);
+    fprintf(f, "---------- End Statistics ----------\n\n");
+}
+
+//-----------------------------------------------------------------
+// dump_json: Nested objects following the name hierarchy. Sorted
+// names keep each group contiguous, so groups are opened / closed
+// by comparing with the previous name.
+//-----------------------------------------------------------------
+inline void tb_stats::dump_json(FILE *f, uint64_t cycle)
+{
+    std::vector <std::string> open;
+
+    fprintf(f, "{\"cycle\": %lu, \"stats\": {", (unsigned long)cycle);
+
+    bool first = true;
+    for (std::map <std::string, tb_stat*>::iterator it = m_stats.begin(); it != m_stats.end(); ++it)
+    {
+        std::vector <std::string> path;
+        size_t start = 0, dot;
+        while ((dot = it->first.find('.', start)) != std::string::npos)
+        {
+            path.push_back(it->first.substr(start, dot - start));
+            start = dot + 1;
+        }
+        std::string leaf = it->first.substr(start);
+
+        size_t common = 0;
+        while (common < open.size() && common < path.size() && open[common] == path[common])
+            common++;
+
+        for (size_t i=open.size();i>common;i--)
+            fprintf(f, "}");
+        open.resize(common);
+
+        for (size_t i=common;i<path.size();i++)
+        {
+            fprintf(f, "%s\"%s\": {", first ? "" : ", ", path[i].c_str());
+            open.push_back(path[i]);
+            first = true;
+        }
+
+        fprintf(f, "%s\"%s\": ", first ? "" : ", ", leaf.c_str());
+        it->second->print_json(f);
+        first = false;
+    }
+
+    for (size_t i=0;i<open.size();i++)
+        fprintf(f, "}");
+    fprintf(f, "}}");
+}
+
+//-----------------------------------------------------------------
+// tb_stats_file: Dumps the registry to FILE (JSON if FILE ends .json,
+// an array of snapshots) at exit, every N cycles and on SIGUSR1.
+//-----------------------------------------------------------------
+class tb_stats_file
+{
+public:
+    tb_stats_file(uint64_t interval = 0)
+    {
+        m_file     = NULL;
+        m_json     = false;
+        m_dumps    = 0;
+        m_interval = interval;
+        m_next     = interval;
+    }
+
+    ~tb_stats_file() { close(0); }
+
+    bool open(const char *filename)
+    {
+        m_file = fopen(filename, "w");
+        if (!m_file)
+        {
+            fprintf(stderr, "ERROR: Could not open %s\n", filename);
+            return false;
+        }
+
+        std::string name = filename;
+        m_json = name.size() > 5 && name.substr(name.size() - 5) == ".json";
+        if (m_json)
+            fprintf(m_file, "[\n");
+
+        pending() = 0;
+        signal(SIGUSR1, request);
+        return true;
+    }
+
+    //-------------------------------------------------------------
+    // poll: Called every cycle - dump if signalled or interval due
+    //-------------------------------------------------------------
+    void poll(uint64_t cycle)
+    {
+        if (pending() || (m_interval && cycle >= m_next))
+        {
+            pending() = 0;
+            if (m_interval)
+                m_next = cycle + m_interval;
+            dump(cycle);
+        }
+    }
+
+    void dump(uint64_t cycle)
+    {
+        if (!m_file)
+            return;
+
+        if (m_json)
+        {
+            fprintf(m_file, "%s", m_dumps ? ",\n" : "");
+            tb_stats::instance().dump_json(m_file, cycle);
+        }
+        else
+            tb_stats::instance().dump_text(m_file, cycle);
+
+        fflush(m_file);
+        m_dumps++;
+    }
+
+    //-------------------------------------------------------------
+    // close: Final dump
+    //-------------------------------------------------------------
+    void close(uint64_t cycle)
+    {
+        if (!m_file)
+            return;
+
+        dump(cycle);
+        if (m_json)
+            fprintf(m_file, "\n]\n");
+        fclose(m_file);
+        m_file = NULL;
+        signal(SIGUSR1, SIG_DFL);
+    }
+
+    uint64_t get_dumps(void) const { return m_dumps; }
+
+protected:
+    static void request(int) { pending() = 1; }
+
+    static volatile sig_atomic_t &pending(void)
+    {
+        static volatile sig_atomic_t p = 0;
+        return p;
+    }
+
+    FILE *      m_file;
+    bool        m_json;
+    uint64_t    m_dumps;
+    uint64_t    m_interval;
+    uint64_t    m_next;
+};
+
+#endif
@@ -0,0 +1,204 @@
+#ifndef TB_TIMELINE_H
+#define TB_TIMELINE_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <string>
+
+//-----------------------------------------------------------------
+// Defines
+//-----------------------------------------------------------------
+#define TB_TIMELINE_INTERVAL    100000
+
+// riscv_top::get_perf_events (biriscv_issue.v: perf_events)
+#define TB_EVENT_ISSUE_A        (1 << 0)
+#define TB_EVENT_ISSUE_B        (1 << 1)
+#define TB_EVENT_MISPREDICT     (1 << 2)
+#define TB_EVENT_LSU_STALL      (1 << 3)
+#define TB_EVENT_SERIAL         (1 << 4)
+#define TB_EVENT_OPERAND        (1 << 5)
+
+//-----------------------------------------------------------------
+// tb_timeline_counters: Cumulative counters
+//-----------------------------------------------------------------
+struct tb_timeline_counters
+{
+    uint64_t cycles;
+    uint64_t instret;
+    uint64_t dual_issue;
+    uint64_t mispredicts;
+    uint64_t icache_refills;    // I-port read bursts
+    uint64_t dcache_refills;    // D-port read bursts (incl. uncached)
+    uint64_t dcache_writes;     // D-port write bursts (incl. uncached)
+    uint64_t stall_memory;      // No issue: LSU stall
+    uint64_t stall_serial;      // No issue: div / csr pending
+    uint64_t stall_operand;     // No issue: scoreboard / hazard
+    uint64_t stall_frontend;    // No issue: nothing fetched
+};
+
+//-----------------------------------------------------------------
+// tb_timeline: Counter deltas every N cycles as CSV (default) or
+// JSON (FILE ending .json), for phase analysis. A SIM_CTRL marker
+// (software writes (2 << 24) | id) closes the current row early and
+// tags it, so rows can be attributed to program phases. Each fork /
+// daemon job starts a new section (start cycle back to 0).
+//-----------------------------------------------------------------
+class tb_timeline
+{
+public:
+    tb_timeline(uint64_t interval = TB_TIMELINE_INTERVAL)
+    {
+        m_interval = interval ? interval : TB_TIMELINE_INTERVAL;
+        m_file     = NULL;
+        m_json     = false;
+        m_rows     = 0;
+        memset(&m_count, 0, sizeof(m_count));
+        memset(&m_last, 0, sizeof(m_last));
+    }
+
+    bool open(const char *filename)
+    {
+        m_file = fopen(filename, "w");
+        if (!m_file)
+        {
+            fprintf(stderr, "ERROR: Could not open %s\n", filename);
+            return false;
+        }
+
+        std::string name = filename;
+        m_json = name.size() > 5 && name.substr(name.size() - 5) == ".json";
+
+        if (m_json)
+            fprintf(m_file, "{\n  \"interval\": %lu,\n  \"samples\": [\n", (unsigned long)m_interval);
+        else
+            fprintf(m_file, "start,end,instret,ipc,dual_issue,mispredicts,icache_refills,dcache_refills,"
+                            "dcache_writes,stall_memory,stall_serial,stall_operand,stall_frontend,marker\n");
+        return true;
+    }
+
+    //-------------------------------------------------------------
+    // sample: One cycle. events = TB_EVENT_* flags, retired = 0..2,
+    // refills / writes = interconnect burst totals so far.
+    //-------------------------------------------------------------
+    void sample(uint64_t cycle, uint32_t events, int retired,
+                uint64_t icache_refills, uint64_t dcache_refills, uint64_t dcache_writes)
+    {
+        m_count.cycles          = cycle;
+        m_count.instret        += retired;
+        m_count.icache_refills  = icache_refills;
+        m_count.dcache_refills  = dcache_refills;
+        m_count.dcache_writes   = dcache_writes;
+
+        if (events & TB_EVENT_ISSUE_B)
+            m_count.dual_issue++;
+        if (events & TB_EVENT_MISPREDICT)
+            m_count.mispredicts++;
+
+        // Stall attribution (first match) for cycles without issue
+        if (!(events & TB_EVENT_ISSUE_A))
+        {
+            if (events & TB_EVENT_LSU_STALL)
+                m_count.stall_memory++;
+            else if (events & TB_EVENT_SERIAL)
+                m_count.stall_serial++;
+            else if (events & TB_EVENT_OPERAND)
+                m_count.stall_operand++;
+            else
+                m_count.stall_frontend++;
+        }
+
+        if (cycle - m_last.cycles >= m_interval)
+            write_row(NULL);
+    }
+
+    //-------------------------------------------------------------
+    // marker: Software phase marker, closes the current row
+    //-------------------------------------------------------------
+    void marker(uint32_t id)
+    {
+        char tag[16];
+        snprintf(tag, sizeof(tag), "%u", id);
+        write_row(tag);
+    }
+
+    //-------------------------------------------------------------
+    // restart: New section from cycle 0 (per-job counters reset).
+    // Flushes the partial row; refills / writes = burst totals now.
+    //-------------------------------------------------------------
+    void restart(uint64_t icache_refills, uint64_t dcache_refills, uint64_t dcache_writes)
+    {
+        if (m_file && m_count.cycles != m_last.cycles)
+            write_row(NULL);
+
+        memset(&m_count, 0, sizeof(m_count));
+        m_count.icache_refills = icache_refills;
+        m_count.dcache_refills = dcache_refills;
+        m_count.dcache_writes  = dcache_writes;
+        m_last = m_count;
+    }
+
+    void close(void)
+    {
+        if (!m_file)
+            return;
+
+        if (m_count.cycles != m_last.cycles)
+            write_row(NULL);
+
+        if (m_json)
+            fprintf(m_file, "\n  ]\n}\n");
+        fclose(m_file);
+        m_file = NULL;
+    }
+
+protected:
+    void write_row(const char *marker)
+    {
+        tb_timeline_counters d;
+        d.cycles         = m_count.cycles         - m_last.cycles;
+        d.instret        = m_count.instret        - m_last.instret;
+        d.dual_issue     = m_count.dual_issue     - m_last.dual_issue;
+        d.mispredicts    = m_count.mispredicts    - m_last.mispredicts;
+        d.icache_refills = m_count.icache_refills - m_last.icache_refills;
+        d.dcache_refills = m_count.dcache_refills - m_last.dcache_refills;
+        d.dcache_writes  = m_count.dcache_writes  - m_last.dcache_writes;
+        d.stall_memory   = m_count.stall_memory   - m_last.stall_memory;
+        d.stall_serial   = m_count.stall_serial   - m_last.stall_serial;
+        d.stall_operand  = m_count.stall_operand  - m_last.stall_operand;
+        d.stall_frontend = m_count.stall_frontend - m_last.stall_frontend;
+
+        double ipc = d.cycles ? (double)d.instret / d.cycles : 0.0;
+
+        if (m_json)
+            fprintf(m_file, "%s    {\"start\": %lu, \"end\": %lu, \"instret\": %lu, \"ipc\": %.4f, "
+                            "\"dual_issue\": %lu, \"mispredicts\": %lu, \"icache_refills\": %lu, "
+                            "\"dcache_refills\": %lu, \"dcache_writes\": %lu, \"stall_memory\": %lu, "
+                            "\"stall_serial\": %lu, \"stall_operand\": %lu, \"stall_frontend\": %lu%s%s}",
+                    m_rows ? ",\n" : "",
+                    (unsigned long)m_last.cycles, (unsigned long)m_count.cycles, (unsigned long)d.instret, ipc,
+                    (unsigned long)d.dual_issue, (unsigned long)d.mispredicts, (unsigned long)d.icache_refills,
+                    (unsigned long)d.dcache_refills, (unsigned long)d.dcache_writes, (unsigned long)d.stall_memory,
+                    (unsigned long)d.stall_serial, (unsigned long)d.stall_operand, (unsigned long)d.stall_frontend,
+                    marker ? ", \"marker\": " : "", marker ? marker : "");
+        else
+            fprintf(m_file, "%lu,%lu,%lu,%.4f,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%s\n",
+                    (unsigned long)m_last.cycles, (unsigned long)m_count.cycles, (unsigned long)d.instret, ipc,
+                    (unsigned long)d.dual_issue, (unsigned long)d.mispredicts, (unsigned long)d.icache_refills,
+                    (unsigned long)d.dcache_refills, (unsigned long)d.dcache_writes, (unsigned long)d.stall_memory,
+                    (unsigned long)d.stall_serial, (unsigned long)d.stall_operand, (unsigned long)d.stall_frontend,
+                    marker ? marker : "");
+
+        m_last = m_count;
+        m_rows++;
+    }
+
+    uint64_t             m_interval;
+    FILE *               m_file;
+    bool                 m_json;
+    uint64_t             m_rows;
+    tb_timeline_counters m_count;
+    tb_timeline_counters m_last;
+};
+
+#endif
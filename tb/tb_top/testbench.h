@@ -1,72 +1,211 @@
-#include "testbench_vbase.h"
-#include "elf_load.h"
+#include "tb_harness.h"
+#include "image_load.h"
 #include <getopt.h>
 #include <unistd.h>
+#include <vector>
+#include <map>
+#include <string>
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
 
-#include "riscv_top.h"
-#include "tb_axi4_mem.h"
+#include "tb_idle.h"
+#include "tb_gdb.h"
+#include "tb_host_stats.h"
+#include "tb_pair_stats.h"
+#include "tb_timeline.h"
+#include "tb_stats.h"
+#include "tb_probe.h"
 
 #include "verilated.h"
 #include "verilated_vcd_sc.h"
 
 #define MEM_BASE 0x80000000
 
+// Skip limits (cycles)
+#define IDLE_SKIP_MAX       1000000
+#define IDLE_SKIP_MARGIN    16
+
 //-----------------------------------------------------------------
 // Command line options
 //-----------------------------------------------------------------
-#define GETOPTS_ARGS "f:c:h"
+#define GETOPTS_ARGS "f:L:c:o:l:ria:q:m:b:sS:F:D:g:p:t:A:P:W:R:IT:N:Z:z:x:X:yh"
 
 static struct option long_options[] =
 {
     {"elf",        required_argument, 0, 'f'},
+    {"load",       required_argument, 0, 'L'},
     {"cycles",     required_argument, 0, 'c'},
+    {"outstanding",required_argument, 0, 'o'},
+    {"latency",    required_argument, 0, 'l'},
+    {"reorder",    no_argument,       0, 'r'},
+    {"interleave", no_argument,       0, 'i'},
+    {"arb",        required_argument, 0, 'a'},
+    {"qos",        required_argument, 0, 'q'},
+    {"ram-size",   required_argument, 0, 'm'},
+    {"boot-marker",required_argument, 0, 'b'},
+    {"idle-skip",  no_argument,       0, 's'},
+    {"idle-skip-max",required_argument, 0, 'S'},
+    {"fork-server",required_argument, 0, 'F'},
+    {"daemon",     required_argument, 0, 'D'},
+    {"gdb",        required_argument, 0, 'g'},
+    {"host-stats", required_argument, 0, 'p'},
+    {"axi-trace",  required_argument, 0, 't'},
+    {"access-trace",required_argument, 0, 'A'},
+    {"pipeview",   required_argument, 0, 'P'},
+    {"pipeview-window",required_argument, 0, 'W'},
+    {"pipeview-pc",required_argument, 0, 'R'},
+    {"pair-stats", no_argument,       0, 'I'},
+    {"timeline",   required_argument, 0, 'T'},
+    {"timeline-interval",required_argument, 0, 'N'},
+    {"stats",      required_argument, 0, 'Z'},
+    {"stats-interval",required_argument, 0, 'z'},
+    {"probe",      required_argument, 0, 'x'},
+    {"probe-out",  required_argument, 0, 'X'},
+    {"probe-change",no_argument,      0, 'y'},
     {"help",       no_argument,       0, 'h'},
     {0, 0, 0, 0}
 };
 
+//-----------------------------------------------------------------
+// parse_size: Size with optional K/M/G suffix
+//-----------------------------------------------------------------
+static uint32_t parse_size(const char *str)
+{
+    char *end = NULL;
+    uint64_t size = strtoull(str, &end, 0);
+
+    switch (*end)
+    {
+        case 'k': case 'K': size <<= 10; break;
+        case 'm': case 'M': size <<= 20; break;
+        case 'g': case 'G': size <<= 30; break;
+        default: break;
+    }
+
+    if (size > 0xFFFFFFFFULL)
+    {
+        fprintf (stderr,"Error: Size too large '%s'\n", str);
+        exit(-1);
+    }
+
+    return (uint32_t)size;
+}
+
 static void help_options(void)
 {
     fprintf (stderr,"Usage:\n");
     fprintf (stderr,"  --elf         | -f FILE       File to load\n");
+    fprintf (stderr,"  --load        | -L FILE[@ADDR] Image to load (ELF, binary, .hex, .srec), may be repeated\n");
     fprintf (stderr,"  --cycles      | -c NUM        Max instructions to execute\n");
+    fprintf (stderr,"  --outstanding | -o RD[:WR]    Outstanding AXI bursts per memory port\n");
+    fprintf (stderr,"  --latency     | -l NUM        AXI response latency (cycles)\n");
+    fprintf (stderr,"  --reorder     | -r            Return responses for different IDs out-of-order\n");
+    fprintf (stderr,"  --interleave  | -i            Interleave read data beats for different IDs (needs --reorder)\n");
+    fprintf (stderr,"  --arb         | -a MODE       Interconnect arbitration (rr, fixed, qos)\n");
+    fprintf (stderr,"  --qos         | -q I:D        Interconnect QoS level for I / D ports\n");
+    fprintf (stderr,"  --ram-size    | -m NUM[K|M|G] RAM at 0x%08x (allocated on first write)\n", MEM_BASE);
+    fprintf (stderr,"  --boot-marker | -b STR        Stop and report cycles when UART prints STR\n");
+    fprintf (stderr,"  --idle-skip   | -s            Skip cycles while the core spins waiting for an interrupt / timer\n");
+    fprintf (stderr,"  --idle-skip-max | -S NUM      Max cycles skipped at once (default %d)\n", IDLE_SKIP_MAX);
+    fprintf (stderr,"  --fork-server | -F NUM        After warm-up, fork a child per job read from stdin (NUM in parallel, not with --threads models)\n");
+    fprintf (stderr,"  --daemon      | -D PATH       Run jobs received on Unix socket PATH, reusing the model\n");
+    fprintf (stderr,"  --gdb         | -g PORT|PATH  Wait for GDB on localhost TCP port or Unix socket\n");
+    fprintf (stderr,"  --host-stats  | -p SECS       Host time breakdown, progress line every SECS (0 = off)\n");
+    fprintf (stderr,"  --axi-trace   | -t FILE       Binary AXI burst trace (gzip compressed if FILE ends .gz)\n");
+    fprintf (stderr,"  --access-trace| -A FILE       Retired fetch / load / store address trace (same format)\n");
+    fprintf (stderr,"  --pipeview    | -P FILE       Per-instruction pipeline log (O3PipeView, open with Konata)\n");
+    fprintf (stderr,"  --pipeview-window | -W S[:E]  Only log instructions decoded in cycles [S, E)\n");
+    fprintf (stderr,"  --pipeview-pc | -R LO:HI      Only log instructions with PC in [LO, HI]\n");
+    fprintf (stderr,"  --pair-stats  | -I            Why single issue cycles did not dual issue\n");
+    fprintf (stderr,"  --timeline    | -T FILE       IPC / stall / miss counters per interval (CSV, or JSON if FILE ends .json)\n");
+    fprintf (stderr,"  --timeline-interval | -N NUM  Timeline interval in cycles (default %d)\n", TB_TIMELINE_INTERVAL);
+    fprintf (stderr,"  --stats       | -Z FILE       Dump statistics at exit / on SIGUSR1 (text, or JSON if FILE ends .json)\n");
+    fprintf (stderr,"  --stats-interval | -z NUM     Also dump statistics every NUM cycles\n");
+    fprintf (stderr,"  --probe       | -x LIST       Sample RTL signals (a,b,c or @FILE), needs 'make build_probe'\n");
+    fprintf (stderr,"  --probe-out   | -X FILE       Probe output (default probes.bin, CSV if FILE ends .csv)\n");
+    fprintf (stderr,"  --probe-change | -y           Only record probe rows when a value changes\n");
     exit(-1);
 }
 
 //-----------------------------------------------------------------
 // Module
 //-----------------------------------------------------------------
-class testbench: public testbench_vbase, public mem_api
+class testbench: public tb_harness, public tb_gdb_target
 {
 public:
     //-----------------------------------------------------------------
     // Instances / Members
     //-----------------------------------------------------------------      
-    riscv_top                   *m_dut;
-    tb_axi4_mem                 *m_icache_mem;
-    tb_axi4_mem                 *m_dcache_mem;
+    uint64_t                     m_cycles;
+    const char *                 m_boot_marker;
 
-    int                          m_argc;
-    char**                       m_argv;
+    bool                         m_idle_skip;
+    uint64_t                     m_idle_skip_max;
+    tb_idle_detect               m_idle;
+    uint64_t                     m_idle_skips;
+    uint64_t                     m_idle_skipped;
 
-    sc_signal <axi4_slave>      mem_i_in;
-    sc_signal <axi4_master>     mem_i_out;
+    bool                         m_fork_parent;
 
-    sc_signal <axi4_slave>      mem_d_in;
-    sc_signal <axi4_master>     mem_d_out;
+    uint32_t                     m_ram_size;
+    bool                         m_daemon;
+    bool                         m_finished;
 
-    sc_signal < bool >          intr_in;
+    tb_gdb_server               *m_gdb;
+    uint32_t                     m_gdb_pc;
+    int                          m_gdb_wb_rd[2];    // Retiring this cycle, not yet in the register file
+    uint32_t                     m_gdb_wb_val[2];
 
-    sc_signal < sc_uint <32> >  reset_vector_in;
+    tb_host_stats               *m_host;
+    tb_axi4_trace               *m_access_trace;
+    tb_pipeview                 *m_pipeview;
+    tb_pair_stats               *m_pair_stats;
+    tb_timeline                 *m_timeline;
+    tb_stats_file               *m_stats_file;
+    std::vector <tb_stat*>       m_stats;
+    tb_probe                    *m_probe;
+    uint64_t                     m_instret;
+
+    int                          m_argc;
+    char**                       m_argv;
 
     //-----------------------------------------------------------------
     // process: Main loop for CPU execution
     //-----------------------------------------------------------------
     void process(void) 
     {
-        uint64_t       cycles         = 0;
         int64_t        max_cycles     = (int64_t)-1;
-        const char *   filename       = NULL;
+        std::vector <const char *> images;
         int            help           = 0;
+        int            rd_outstanding = TB_AXI4_MEM_RD_OUTSTANDING;
+        int            wr_outstanding = TB_AXI4_MEM_WR_OUTSTANDING;
+        int            latency        = 0;
+        bool           reorder        = false;
+        bool           interleave     = false;
+        eTB_AXI4_IC_ARB arb           = TB_AXI4_IC_ARB_ROUND_ROBIN;
+        int            qos_i          = 0;
+        int            qos_d          = 0;
+        const char *   daemon_path    = NULL;
+        const char *   gdb_addr       = NULL;
+        int            fork_jobs      = 0;
+        double         host_stats     = -1;
+        const char *   axi_trace      = NULL;
+        const char *   access_trace   = NULL;
+        const char *   pipeview       = NULL;
+        uint64_t       pv_start       = 0;
+        uint64_t       pv_end         = 0;
+        uint32_t       pv_pc_lo       = 0;
+        uint32_t       pv_pc_hi       = 0xFFFFFFFF;
+        const char *   timeline       = NULL;
+        uint64_t       tl_interval    = TB_TIMELINE_INTERVAL;
+        const char *   stats_file     = NULL;
+        uint64_t       stats_interval = 0;
+        const char *   probe_list     = NULL;
+        const char *   probe_out      = "probes.bin";
+        bool           probe_change   = false;
         int c;        
 
         int option_index = 0;
@@ -75,11 +214,118 @@ public:
             switch(c)
             {
                 case 'f':
-                    filename = optarg;
+                case 'L':
+                    images.push_back(optarg);
                     break;
                 case 'c':
                     max_cycles = (int64_t)strtoull(optarg, NULL, 0);
                     break;
+                case 'o':
+                {
+                    char *wr = NULL;
+                    rd_outstanding = (int)strtoul(optarg, &wr, 0);
+                    wr_outstanding = (*wr == ':') ? (int)strtoul(wr + 1, NULL, 0) : rd_outstanding;
+                    break;
+                }
+                case 'l':
+                    latency = (int)strtoul(optarg, NULL, 0);
+                    break;
+                case 'r':
+                    reorder = true;
+                    break;
+                case 'i':
+                    interleave = true;
+                    break;
+                case 'a':
+                    if (!strcmp(optarg, "rr"))
+                        arb = TB_AXI4_IC_ARB_ROUND_ROBIN;
+                    else if (!strcmp(optarg, "fixed"))
+                        arb = TB_AXI4_IC_ARB_FIXED;
+                    else if (!strcmp(optarg, "qos"))
+                        arb = TB_AXI4_IC_ARB_QOS;
+                    else
+                        help = 1;
+                    break;
+                case 'q':
+                {
+                    char *d = NULL;
+                    qos_i = (int)strtoul(optarg, &d, 0);
+                    qos_d = (*d == ':') ? (int)strtoul(d + 1, NULL, 0) : qos_i;
+                    break;
+                }
+                case 'm':
+                    m_ram_size = parse_size(optarg);
+                    break;
+                case 'b':
+                    m_boot_marker = optarg;
+                    break;
+                case 's':
+                    m_idle_skip = true;
+                    break;
+                case 'S':
+                    m_idle_skip_max = strtoull(optarg, NULL, 0);
+                    break;
+                case 'F':
+                    fork_jobs = (int)strtoul(optarg, NULL, 0);
+                    break;
+                case 'D':
+                    daemon_path = optarg;
+                    break;
+                case 'g':
+                    gdb_addr = optarg;
+                    break;
+                case 'p':
+                    host_stats = strtod(optarg, NULL);
+                    break;
+                case 't':
+                    axi_trace = optarg;
+                    break;
+                case 'A':
+                    access_trace = optarg;
+                    break;
+                case 'P':
+                    pipeview = optarg;
+                    break;
+                case 'I':
+                    m_pair_stats = new tb_pair_stats(std::string(name()) + ".PAIR");
+                    break;
+                case 'T':
+                    timeline = optarg;
+                    break;
+                case 'N':
+                    tl_interval = strtoull(optarg, NULL, 0);
+                    break;
+                case 'Z':
+                    stats_file = optarg;
+                    break;
+                case 'z':
+                    stats_interval = strtoull(optarg, NULL, 0);
+                    break;
+                case 'x':
+                    probe_list = optarg;
+                    break;
+                case 'X':
+                    probe_out = optarg;
+                    break;
+                case 'y':
+                    probe_change = true;
+                    break;
+                case 'W':
+                {
+                    char *end = NULL;
+                    pv_start = strtoull(optarg, &end, 0);
+                    if (end && *end == ':')
+                        pv_end = strtoull(end + 1, NULL, 0);
+                    break;
+                }
+                case 'R':
+                {
+                    char *end = NULL;
+                    pv_pc_lo = (uint32_t)strtoul(optarg, &end, 0);
+                    if (end && *end == ':')
+                        pv_pc_hi = (uint32_t)strtoul(end + 1, NULL, 0);
+                    break;
+                }
                 case '?':
                 default:
                     help = 1;   
@@ -87,35 +333,779 @@ public:
             }
         }        
 
-        if (help || filename == NULL)
+        if (help || (images.empty() && !daemon_path))
         {
             help_options();
             sc_stop();
             return;
         }
 
-        // Load Firmware
-        printf("Running: %s\n", filename);
-        elf_load elf(filename, this);
-        if (!elf.load())
+        // A zero limit never accepts a command (AXI deadlock)
+        if (rd_outstanding < 1 || wr_outstanding < 1)
+        {
+            fprintf(stderr, "ERROR: --outstanding must be >= 1 (got %d:%d)\n", rd_outstanding, wr_outstanding);
+            sc_stop();
+            return;
+        }
+
+        // In-order responses never leave a burst open for another ID
+        if (interleave && !reorder)
+        {
+            fprintf(stderr, "ERROR: --interleave requires --reorder\n");
+            sc_stop();
+            return;
+        }
+
+        // Memory model behaviour
+        m_mem->set_outstanding(rd_outstanding, wr_outstanding);
+        m_mem->set_latency(latency);
+        m_mem->enable_reorder(reorder);
+        m_mem->enable_interleave(interleave);
+
+        m_interconnect->set_arbitration(arb);
+        m_interconnect->set_port_qos(0, qos_i);
+        m_interconnect->set_port_qos(1, qos_d);
+
+        if (axi_trace && !m_interconnect->trace_open(axi_trace))
         {
-            fprintf (stderr,"Error: Could not open %s\n", filename);
             sc_stop();
+            return;
+        }
+
+        // Core side access stream (offline cache simulation)
+        if (access_trace)
+        {
+            std::vector<std::string> ports;
+            ports.push_back("ifetch");
+            ports.push_back("lsu");
+
+            m_access_trace = new tb_axi4_trace();
+            if (!m_access_trace->open(access_trace, ports))
+            {
+                sc_stop();
+                return;
+            }
+        }
+
+        // Pipeline view (O3PipeView text, Konata)
+        if (pipeview)
+        {
+            m_pipeview = new tb_pipeview();
+            if (!m_pipeview->open(pipeview))
+            {
+                sc_stop();
+                return;
+            }
+            m_pipeview->set_window(pv_start, pv_end);
+            m_pipeview->set_pc_range(pv_pc_lo, pv_pc_hi);
+        }
+
+        // Phase timeline (counter deltas every N cycles)
+        if (timeline)
+        {
+            m_timeline = new tb_timeline(tl_interval);
+            if (!m_timeline->open(timeline))
+            {
+                sc_stop();
+                return;
+            }
+        }
+
+        // RTL signal probes (resolved once, sampled every cycle)
+        if (probe_list)
+        {
+            m_probe = new tb_probe();
+            m_probe->set_on_change(probe_change);
+            if (!m_probe->add_list(probe_list) || !m_probe->open(probe_out))
+            {
+                sc_stop();
+                return;
+            }
+        }
+
+        // Statistics registry dumps
+        if (stats_file)
+        {
+            m_stats_file = new tb_stats_file(stats_interval);
+            if (!m_stats_file->open(stats_file))
+            {
+                sc_stop();
+                return;
+            }
+        }
+
+        // RAM independent of ELF sections (e.g. Linux)
+        if (m_ram_size)
+            create_memory(MEM_BASE, m_ram_size);
+
+        if (m_boot_marker)
+            m_uart->set_marker(m_boot_marker);
+
+        // Host time breakdown (later categories override earlier)
+        if (host_stats >= 0)
+        {
+            m_host = new tb_host_stats(host_stats);
+            m_host->add(this, TB_HOST_TESTBENCH);
+            m_host->add(m_dut, TB_HOST_EVAL);
+            m_host->add(m_dut, TB_HOST_PINS, false);
+            m_host->add(m_mem, TB_HOST_MEM);
+            m_host->add(m_interconnect, TB_HOST_INTERCONNECT);
+            if (!m_host->start())
+                fprintf(stderr, "WARNING: Host profiling timer unavailable\n");
+        }
+
+        // Load images (bootloader, kernel, DTB, initramfs, ...)
+        uint32_t entry = 0;
+        for (size_t i=0;i<images.size();i++)
+        {
+            printf("Running: %s\n", images[i]);
+            image_load img(images[i], this, MEM_BASE);
+            if (!img.load())
+            {
+                fprintf (stderr,"Error: Could not open %s\n", images[i]);
+                sc_stop();
+            }
+
+            // First image with an entry point (ELF / SREC / HEX start address)
+            if (!entry)
+                entry = img.get_entry_point();
         }
 
         // Set reset vector
-        reset_vector_in.write(MEM_BASE);
-        
+        if (!entry)
+            entry = MEM_BASE;
+        reset_vector_in.write(entry);
+
+        // Jobs submitted over a socket, each from a clean reset
+        if (daemon_path)
+        {
+            // Core held in reset until the first job is loaded
+            rst_cpu_in.write(true);
+            daemon(daemon_path, max_cycles);
+            sc_stop();
+            return;
+        }
+
+        // Debugger attaches before the first instruction
+        if (gdb_addr)
+        {
+            m_gdb = new tb_gdb_server(this);
+            if (m_gdb->listen(gdb_addr))
+            {
+                // One retire per cycle: breakpoints / steps stop exactly
+                m_dut->set_single_issue(true);
+                m_gdb_pc = entry;
+                m_gdb->stop(TB_GDB_SIGTRAP, entry);
+            }
+        }
+
+        run(max_cycles);
+
+        // Warm-up done: each job continues from a copy of this state
+        if (fork_jobs > 0 && fork_server(fork_jobs, max_cycles))
+            run(max_cycles);
+
+        sc_stop();
+    }
+
+    //-----------------------------------------------------------------
+    // run: Clock the core until max_cycles or the boot marker
+    //-----------------------------------------------------------------
+    void run(int64_t max_cycles)
+    {
         while (true)
         {
-            cycles += 1;
-            if (cycles >= max_cycles && max_cycles != -1)
+            m_cycles += 1;
+            if (m_cycles >= max_cycles && max_cycles != -1)
+                break;
+
+            // $finish (daemon mode)
+            if (m_finished)
                 break;
 
+            // Peripherals
+            clock_peripherals();
+
+            if (m_access_trace)
+                access_record();
+
+            if (m_pipeview)
+            {
+                tb_pipe_state state;
+                m_dut->get_pipe_state(state);
+                m_pipeview->sample(m_cycles, state);
+            }
+
+            if (m_probe)
+                m_probe->sample(m_cycles);
+
+            if (m_pair_stats)
+            {
+                bool     dual;
+                uint32_t pc, opcode_a, opcode_b;
+                int reason = m_dut->get_pairing(dual, pc, opcode_a, opcode_b);
+                m_pair_stats->sample(dual, reason, pc, opcode_a, opcode_b);
+            }
+
+            // Progress / guest IPC
+            if (m_host || m_timeline || m_stats_file)
+            {
+                uint32_t pc, opcode, result;
+                int retired = 0;
+                for (int slot=0;slot<2;slot++)
+                    if (m_dut->get_retire(slot, pc, opcode, result))
+                        retired++;
+                m_instret += retired;
+
+                if (m_timeline)
+                    timeline_sample(retired);
+
+                if (m_host && (m_cycles % TB_HOST_PROGRESS_CHECK) == 0)
+                    m_host->progress(m_cycles, m_instret);
+            }
+
+            // Statistics registry
+            if (m_stats_file)
+            {
+                m_dut->update_stats();
+                m_stats_file->poll(m_cycles);
+            }
+
+            if (m_uart->marker_seen())
+            {
+                printf("\nBOOT: '%s' reached after %lu cycles\n", m_boot_marker, (unsigned long)m_cycles);
+                break;
+            }
+
+            // Debugger: breakpoint / single-step / Ctrl-C (advances one cycle)
+            if (m_gdb && m_gdb->connected() && gdb_check())
+                continue;
+
+            // Core spinning (WFI / polling loop): jump ahead to the next timer event,
+            // unless an interrupt or console input is already waiting
+            if (m_idle_skip && idle_detect() && !intr_in.read() && !m_uart->rx_pending())
+            {
+                uint64_t skip = idle_skip_cycles(m_idle_skip_max);
+                if (max_cycles != -1 && (m_cycles + skip) >= (uint64_t)max_cycles)
+                    skip = (uint64_t)max_cycles - m_cycles - 1;
+
+                if (skip)
+                {
+                    m_dut->skip_cycles((uint32_t)skip);
+                    m_clint->advance(skip);
+                    m_uart->advance(skip);
+                    m_cycles += skip;
+
+                    m_idle_skips++;
+                    m_idle_skipped += skip;
+                }
+
+                m_idle.reset();
+            }
+
             wait();
         }
+    }
+
+    //-----------------------------------------------------------------
+    // cpu_release: Release core from reset at reset_vector
+    //-----------------------------------------------------------------
+    void cpu_release(uint32_t reset_vector)
+    {
+        tb_harness::cpu_release(reset_vector);
+        m_idle.reset();
+    }
+
+    //-----------------------------------------------------------------
+    // finish_hook: $finish ends the current job in daemon mode
+    //-----------------------------------------------------------------
+    bool finish_hook(void)
+    {
+        if (!m_daemon)
+            return false;
+
+        m_finished = true;
+        return true;
+    }
+
+    //-----------------------------------------------------------------
+    // fork_server: Read jobs from stdin, one line per job;
+    //   image[@addr] [image[@addr] ...] [-c cycles]
+    // Each job runs in a child process forked from the warmed-up
+    // model (copy-on-write). Returns true in the child.
+    // fork() only copies the calling thread, so models verilated with
+    // --threads (VM_THREADS=1) are not supported.
+    //-----------------------------------------------------------------
+    bool fork_server(int max_jobs, int64_t &max_cycles)
+    {
+        std::map <pid_t, std::string> jobs;
+        char line[4096];
+
+#if VM_THREADS
+        fprintf(stderr, "FORK: Not supported with multi-threaded (--threads) models\n");
+        return false;
+#endif
+
+        printf("FORK: Warm-up complete after %lu cycles, reading jobs from stdin\n", (unsigned long)m_cycles);
+        fflush(stdout);
+
+        m_fork_parent = true;
+
+        // Writer threads are not inherited by children - traces cover warm-up
+        trace_close();
+
+        while (true)
+        {
+            // Limit parallel jobs / wait for the remainder on EOF
+            bool eof = !fgets(line, sizeof(line), stdin);
+            while (jobs.size() > 0 && (eof || (int)jobs.size() >= max_jobs))
+            {
+                int status = 0;
+                pid_t pid  = waitpid(-1, &status, 0);
+                if (pid < 0)
+                    break;
+
+                fprintf(stderr, "FORK: Job '%s' %s %d\n", jobs[pid].c_str(),
+                        WIFEXITED(status) ? "exited with" : "killed by signal",
+                        WIFEXITED(status) ? WEXITSTATUS(status) : WTERMSIG(status));
+                jobs.erase(pid);
+            }
+
+            if (eof)
+                return false;
+
+            line[strcspn(line, "\r\n")] = 0;
+            if (line[0] == 0 || line[0] == '#')
+                continue;
+
+            fflush(stdout);
+            fflush(stderr);
+
+            pid_t pid = fork();
+            if (pid < 0)
+            {
+                fprintf(stderr, "FORK: fork() failed\n");
+                return false;
+            }
+            else if (pid > 0)
+            {
+                jobs[pid] = line;
+                continue;
+            }
+
+            // Child: stdin belongs to the server
+            int fd = open("/dev/null", O_RDONLY);
+            dup2(fd, STDIN_FILENO);
+            close(fd);
+
+            m_fork_parent = false;
+            return fork_job(line, max_cycles);
+        }
+    }
+
+    //-----------------------------------------------------------------
+    // load_job: Load 'image[@addr] ... [-c cycles]' (entry = first image)
+    //-----------------------------------------------------------------
+    bool load_job(char *line, int64_t &max_cycles, uint32_t &entry)
+    {
+        entry = 0;
+
+        for (char *tok = strtok(line, " \t"); tok; tok = strtok(NULL, " \t"))
+        {
+            if (!strcmp(tok, "-c") || !strcmp(tok, "--cycles"))
+            {
+                char *arg = strtok(NULL, " \t");
+                max_cycles = arg ? (int64_t)strtoull(arg, NULL, 0) : -1;
+                continue;
+            }
+
+            printf("Running: %s\n", tok);
+            image_load img(tok, this, MEM_BASE);
+            if (!img.load())
+            {
+                fprintf (stderr,"Error: Could not open %s\n", tok);
+                return false;
+            }
+
+            if (!entry)
+                entry = img.get_entry_point();
+        }
+
+        if (!entry)
+            entry = MEM_BASE;
+
+        return true;
+    }
+
+    //-----------------------------------------------------------------
+    // fork_job: Load job payload and restart the core at its entry
+    //-----------------------------------------------------------------
+    bool fork_job(char *line, int64_t &max_cycles)
+    {
+        uint32_t entry;
+
+        // Write back the warm-up dcache before the job is loaded over it
+        cpu_halt();
+
+        if (!load_job(line, max_cycles, entry))
+            exit(EXIT_FAILURE);
+
+        // Job specific statistics
+        m_cycles       = 0;
+        m_idle_skips   = 0;
+        m_idle_skipped = 0;
+        m_instret      = 0;
+        tb_stats::instance().reset();
+        timeline_restart();
+        m_uart->set_marker("");
+
+        cpu_release(entry);
+        return true;
+    }
+
+    //-----------------------------------------------------------------
+    // daemon: Serve jobs on a Unix socket. Each request line is a job
+    // (see load_job), or 'quit'. Job output (UART / putc) is streamed
+    // to the client, followed by a result record;
+    //   RESULT: <finish|marker|timeout|error> cycles=N
+    //-----------------------------------------------------------------
+    void daemon(const char *path, int64_t max_cycles)
+    {
+        struct sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+
+        int srv = socket(AF_UNIX, SOCK_STREAM, 0);
+        unlink(path);
+        if (srv < 0 || bind(srv, (struct sockaddr *)&addr, sizeof(addr)) < 0 || listen(srv, 4) < 0)
+        {
+            fprintf(stderr, "DAEMON: Could not listen on %s\n", path);
+            return;
+        }
+
+        printf("DAEMON: Listening on %s\n", path);
+        fflush(stdout);
+
+        m_daemon = true;
+
+        // A client closing its socket must not kill the daemon
+        signal(SIGPIPE, SIG_IGN);
+
+        bool quit = false;
+        while (!quit)
+        {
+            int client = accept(srv, NULL, NULL);
+            if (client < 0)
+                break;
+
+            FILE *f = fdopen(client, "r");
+            char line[4096];
+            while (!quit && fgets(line, sizeof(line), f))
+            {
+                line[strcspn(line, "\r\n")] = 0;
+                if (line[0] == 0 || line[0] == '#')
+                    continue;
+
+                if (!strcmp(line, "quit"))
+                    quit = true;
+                else if (!daemon_job(line, client, max_cycles))
+                {
+                    fprintf(stderr, "DAEMON: Client disconnected\n");
+                    break;
+                }
+            }
+
+            fclose(f);
+        }
+
+        close(srv);
+        unlink(path);
+    }
+
+    //-----------------------------------------------------------------
+    // daemon_job: Reset core, memory and peripherals then run job
+    // (false if the client has gone away)
+    //-----------------------------------------------------------------
+    bool daemon_job(char *line, int client, int64_t max_cycles)
+    {
+        const char *status = "error";
+        uint32_t    entry;
+
+        // Job output goes to the client
+        fflush(stdout);
+        int saved_stdout = dup(STDOUT_FILENO);
+        dup2(client, STDOUT_FILENO);
+
+        cpu_halt();
+
+        m_mem->clear();
+        if (m_ram_size)
+            create_memory(MEM_BASE, m_ram_size);
+
+        reset_peripherals();
+
+        m_cycles       = 0;
+        m_idle_skips   = 0;
+        m_idle_skipped = 0;
+        m_instret      = 0;
+        tb_stats::instance().reset();
+        timeline_restart();
+        m_finished     = false;
+
+        if (load_job(line, max_cycles, entry))
+        {
+            cpu_release(entry);
+            run(max_cycles);
+
+            if (m_finished)
+                status = "finish";
+            else if (m_uart->marker_seen())
+                status = "marker";
+            else
+                status = "timeout";
+        }
+
+        bool connected = (fflush(stdout) == 0) && !ferror(stdout);
+        clearerr(stdout);
+        dup2(saved_stdout, STDOUT_FILENO);
+        close(saved_stdout);
+
+        char result[128];
+        int len = snprintf(result, sizeof(result), "RESULT: %s cycles=%lu\n", status, (unsigned long)m_cycles);
+        return connected && send(client, result, len, MSG_NOSIGNAL) == len;
+    }
+
+    //-----------------------------------------------------------------
+    // gdb_check: Stop and hand over to GDB if requested
+    //-----------------------------------------------------------------
+    bool gdb_check(void)
+    {
+        uint32_t pc, opcode, result, ra, rb;
+        bool     stop   = false;
+        int      signal = TB_GDB_SIGTRAP;
+
+        // Stop after the last instruction retired this cycle (slot 1 is
+        // younger)
+        for (int slot=0;slot<2;slot++)
+        {
+            m_gdb_wb_rd[slot] = 0;
+            if (m_dut->get_retire(slot, pc, opcode, result))
+            {
+                m_dut->get_retire_operands(slot, ra, rb);
+                m_gdb_pc            = tb_gdb_server::next_pc(pc, opcode, ra, rb);
+                m_gdb_wb_rd[slot]   = m_dut->get_retire_rd(slot);
+                m_gdb_wb_val[slot]  = result;
+                stop               |= m_gdb->retire(pc, m_gdb_pc);
+            }
+        }
+
+        if (!stop && (m_cycles % TB_GDB_POLL_CYCLES) == 0 && m_gdb->poll_interrupt())
+        {
+            stop   = true;
+            signal = TB_GDB_SIGINT;
+        }
+
+        if (!stop)
+            return false;
+
+        // Memory reads see dirty data cache lines (they stay dirty)
+        dcache_writeback();
+
+        // Clock held while stopped, so nothing else retires; gdb_read_reg
+        // adds this cycle's write-back
+        m_gdb->stop(signal, m_gdb_pc);
 
-        sc_stop();        
+        m_gdb_wb_rd[0] = 0;
+        m_gdb_wb_rd[1] = 0;
+
+        // Resumed: this cycle's clock
+        wait();
+        return true;
+    }
+
+    //-----------------------------------------------------------------
+    // gdb_read_reg / gdb_read_mem / gdb_write_mem: Debugger access
+    //-----------------------------------------------------------------
+    uint32_t gdb_read_reg(int r)
+    {
+        // Slot 1 is younger
+        for (int slot=1;slot>=0;slot--)
+            if (r && m_gdb_wb_rd[slot] == r)
+                return m_gdb_wb_val[slot];
+
+        return m_dut->get_register(r);
+    }
+
+    bool gdb_read_mem(uint32_t addr, uint8_t &data)
+    {
+        if (!m_mem->valid_addr(addr))
+            return false;
+
+        data = m_mem->read(addr);
+        return true;
+    }
+
+    bool gdb_write_mem(uint32_t addr, uint8_t data)
+    {
+        if (!m_mem->valid_addr(addr))
+            return false;
+
+        // Memory and any cached copy
+        m_mem->write(addr, data);
+        m_dut->write_cached(addr, data);
+        return true;
+    }
+
+    //-----------------------------------------------------------------
+    // trace_close: Flush and close AXI / access / pipeline traces
+    //-----------------------------------------------------------------
+    void trace_close(void)
+    {
+        m_interconnect->trace_close();
+
+        if (m_access_trace)
+        {
+            m_access_trace->close();
+            printf("Access trace: %lu records\n", (unsigned long)m_access_trace->get_records());
+            delete m_access_trace;
+            m_access_trace = NULL;
+        }
+
+        if (m_pipeview)
+        {
+            m_pipeview->close();
+            printf("Pipeline view: %lu instructions\n", (unsigned long)m_pipeview->get_records());
+            delete m_pipeview;
+            m_pipeview = NULL;
+        }
+
+        if (m_timeline)
+        {
+            m_timeline->close();
+            delete m_timeline;
+            m_timeline = NULL;
+        }
+
+        if (m_probe)
+        {
+            m_probe->close();
+            printf("Probes: %lu samples of %d signals\n", (unsigned long)m_probe->get_samples(), m_probe->get_probes());
+            delete m_probe;
+            m_probe = NULL;
+        }
+    }
+
+    //-----------------------------------------------------------------
+    // timeline_sample: Per-cycle events + interconnect burst totals
+    //-----------------------------------------------------------------
+    void timeline_sample(int retired)
+    {
+        const tb_axi4_ic_stats &i = m_interconnect->get_stats(0);
+        const tb_axi4_ic_stats &d = m_interconnect->get_stats(1);
+
+        m_timeline->sample(m_cycles, m_dut->get_perf_events(), retired,
+                           i.rd_bursts, d.rd_bursts, d.wr_bursts);
+
+        uint32_t id;
+        if (m_dut->get_sim_marker(id))
+            m_timeline->marker(id);
+    }
+
+    //-----------------------------------------------------------------
+    // timeline_restart: New timeline section (job counters reset)
+    //-----------------------------------------------------------------
+    void timeline_restart(void)
+    {
+        if (!m_timeline)
+            return;
+
+        const tb_axi4_ic_stats &i = m_interconnect->get_stats(0);
+        const tb_axi4_ic_stats &d = m_interconnect->get_stats(1);
+
+        m_timeline->restart(i.rd_bursts, d.rd_bursts, d.wr_bursts);
+    }
+
+    //-----------------------------------------------------------------
+    // access_record: Fetch / data address of retired instructions.
+    // Addresses are as seen by the core (virtual if the MMU is on).
+    //-----------------------------------------------------------------
+    void access_record(void)
+    {
+        uint32_t pc, opcode, result, ra, rb;
+
+        for (int slot=0;slot<2;slot++)
+        {
+            if (!m_dut->get_retire(slot, pc, opcode, result))
+                continue;
+
+            m_access_trace->record(m_cycles, 0, 0, pc, 0, AXI4_BURST_INCR, false, 0xF);
+
+            uint32_t major = opcode & 0x7F;
+            if (major != 0x03 && major != 0x23 && major != 0x2F)
+                continue;
+
+            m_dut->get_retire_operands(slot, ra, rb);
+
+            uint32_t addr = ra;
+            if (major == 0x03)
+                addr += (uint32_t)((int32_t)opcode >> 20);
+            else if (major == 0x23)
+                addr += (uint32_t)((int32_t)(opcode & 0xFE000000) >> 20) | ((opcode >> 7) & 0x1F);
+
+            uint32_t size = 1u << ((opcode >> 12) & 0x3);
+            uint8_t  strb = (uint8_t)(((1u << size) - 1) << (addr & 3));
+
+            // AMOs read and write the location
+            if (major != 0x23)
+                m_access_trace->record(m_cycles, 1, slot, addr, 0, AXI4_BURST_INCR, false, strb);
+            if (major != 0x03)
+                m_access_trace->record(m_cycles, 1, slot, addr, 0, AXI4_BURST_INCR, true, strb);
+        }
+    }
+
+    //-----------------------------------------------------------------
+    // idle_detect: Feed retired instructions to the spin loop detector
+    //-----------------------------------------------------------------
+    bool idle_detect(void)
+    {
+        uint32_t pc, opcode, result;
+
+        for (int slot=0;slot<2;slot++)
+            if (m_dut->get_retire(slot, pc, opcode, result))
+                m_idle.retire(pc, opcode);
+
+        return m_idle.idle();
+    }
+
+    //-----------------------------------------------------------------
+    // idle_skip_cycles: Cycles that can be skipped before a timer fires
+    //-----------------------------------------------------------------
+    uint64_t idle_skip_cycles(uint64_t max)
+    {
+        uint64_t skip = max;
+
+        // Core timer (mcycle == mtimecmp, must not be stepped over)
+        uint32_t mtimecmp;
+        if (m_dut->get_mtimecmp(mtimecmp))
+        {
+            uint32_t delta = mtimecmp - m_dut->get_mcycle();
+            delta = (delta > IDLE_SKIP_MARGIN) ? (delta - IDLE_SKIP_MARGIN) : 0;
+            if (delta < skip)
+                skip = delta;
+        }
+
+        // CLINT timer
+        uint64_t delta = m_clint->cycles_to_irq();
+        delta = (delta > IDLE_SKIP_MARGIN) ? (delta - IDLE_SKIP_MARGIN) : 0;
+        if (delta < skip)
+            skip = delta;
+
+        // Skip counter is 32-bits
+        if (skip > 0xFFFFFFFF)
+            skip = 0xFFFFFFFF;
+
+        return skip;
     }
 
     void set_argcv(int argc, char* argv[]) { m_argc = argc; m_argv = argv; }
@@ -124,31 +1114,35 @@ public:
     // Construction
     //-----------------------------------------------------------------
     SC_HAS_PROCESS(testbench);
-    testbench(sc_module_name name): testbench_vbase(name)
-    {
-        m_dut = new riscv_top("DUT");
-        m_dut->clk_in(clk);
-        m_dut->rst_in(rst);
-        m_dut->axi_i_out(mem_i_out);
-        m_dut->axi_i_in(mem_i_in);
-        m_dut->axi_d_out(mem_d_out);
-        m_dut->axi_d_in(mem_d_in);
-        m_dut->intr_in(intr_in);
-        m_dut->reset_vector_in(reset_vector_in);
-
-        // Instruction Cache Memory
-        m_icache_mem = new tb_axi4_mem("ICACHE_MEM");
-        m_icache_mem->clk_in(clk);
-        m_icache_mem->rst_in(rst);
-        m_icache_mem->axi_in(mem_i_out);
-        m_icache_mem->axi_out(mem_i_in);
-
-        // Data Cache Memory
-        m_dcache_mem = new tb_axi4_mem("DCACHE_MEM");
-        m_dcache_mem->clk_in(clk);
-        m_dcache_mem->rst_in(rst);
-        m_dcache_mem->axi_in(mem_d_out);
-        m_dcache_mem->axi_out(mem_d_in);
+    testbench(sc_module_name name): tb_harness(name)
+    {
+        m_cycles        = 0;
+        m_boot_marker   = NULL;
+        m_idle_skip     = false;
+        m_idle_skip_max = IDLE_SKIP_MAX;
+        m_idle_skips    = 0;
+        m_idle_skipped  = 0;
+        m_fork_parent   = false;
+        m_ram_size      = 0;
+        m_daemon        = false;
+        m_finished      = false;
+        m_gdb           = NULL;
+        m_gdb_pc        = MEM_BASE;
+        memset(m_gdb_wb_rd, 0, sizeof(m_gdb_wb_rd));
+        m_host          = NULL;
+        m_access_trace  = NULL;
+        m_pipeview      = NULL;
+        m_pair_stats    = NULL;
+        m_timeline      = NULL;
+        m_stats_file    = NULL;
+        m_probe         = NULL;
+
+        // Simulation totals (instret counted when a consumer is enabled)
+        m_stats.push_back(new tb_stat_formula(sc_module::name(), "cycles", [this]() -> double { return (double)m_cycles; }, "Simulated cycles"));
+        m_stats.push_back(new tb_stat_formula(sc_module::name(), "instret", [this]() -> double { return (double)m_instret; }, "Retired instructions"));
+        m_stats.push_back(new tb_stat_formula(sc_module::name(), "ipc", [this]() -> double { return m_cycles ? (double)m_instret / m_cycles : 0.0; },
+                                              "Retired instructions per cycle"));
+        m_instret       = 0;
     }
 
     //Enabling the design tracer
@@ -190,41 +1184,37 @@ public:
     }
 
     //-----------------------------------------------------------------
-    // create_memory: Create memory region
+    // report: Print end of simulation statistics
     //-----------------------------------------------------------------
-    bool create_memory(uint32_t base, uint32_t size, uint8_t *mem = NULL)
+    void report(void)
     {
-        base = base & ~(32-1);
-        size = (size + 31) & ~(32-1);
+        // Jobs report their own statistics
+        if (m_fork_parent)
+            return;
 
-        while (m_icache_mem->valid_addr(base))
-            base += 1;
+        m_interconnect->print_stats();
+        trace_close();
 
-        while (m_icache_mem->valid_addr(base + size - 1))
-            size -= 1;
+        if (m_stats_file)
+        {
+            m_stats_file->close(m_cycles);
+            printf("Statistics: %lu dumps\n", (unsigned long)m_stats_file->get_dumps());
+        }
 
-        m_icache_mem->add_region(base, size);
-        m_dcache_mem->add_region(m_icache_mem->get_array(base), base, size);
+        printf("Memory: %lu KB guest, %lu KB host resident\n",
+               (unsigned long)(m_mem->get_allocated() >> 10),
+               (unsigned long)(m_mem->get_resident() >> 10));
 
-        memset(m_icache_mem->get_array(base), 0, size);
-        return true;
-    }
-    //-----------------------------------------------------------------
-    // valid_addr: Check address range
-    //-----------------------------------------------------------------
-    bool valid_addr(uint32_t addr) { return true; } 
-    //-----------------------------------------------------------------
-    // write: Write byte into memory
-    //-----------------------------------------------------------------
-    void write(uint32_t addr, uint8_t data)
-    {
-        m_dcache_mem->write(addr, data);
-    }
-    //-----------------------------------------------------------------
-    // write: Read byte from memory
-    //-----------------------------------------------------------------
-    uint8_t read(uint32_t addr)
-    {
-        return m_dcache_mem->read(addr);
+        if (m_idle_skips)
+            printf("Idle: skipped %lu cycles in %lu jumps\n", (unsigned long)m_idle_skipped, (unsigned long)m_idle_skips);
+
+        if (m_pair_stats)
+            m_pair_stats->print();
+
+        if (m_host)
+        {
+            m_host->stop();
+            m_host->print(m_cycles, m_instret);
+        }
     }
 };
@@ -30,6 +30,7 @@ public:
     }
 
     virtual void add_trace(sc_trace_file * fp, std::string prefix) { }
+    virtual void report(void) { }
 
     virtual void abort(void)
     {